@@ -0,0 +1,131 @@
+#include "PowerModel.h"
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+   // Rough figures from datasheets and bench pulls, good enough to rank pulse lengths
+   const IgniterSpec IGNITERS[] = {
+       // name       ohms  tempco  J/K     W/K     rise K  burnout
+       {"estes",     0.75, 4.0e-4, 4.0e-3, 7.6e-4, 300,    150},
+       {"ematch",    1.6,  1.7e-4, 5.3e-5, 3.3e-4, 300,    10},
+       {"nichrome",  0.3,  1.7e-4, 2.0e-3, 1.5e-3, 350,    -1}, // wrapped wire, stays whole
+   };
+
+   const BatterySpec BATTERIES[] = {
+       // name       EMF   Rint  Rpolar  tau ms
+       {"9v",        9.3,  1.7,  1.0,    2000},
+       {"4aa",       6.2,  0.6,  0.3,    2000},
+       {"sla12",     12.7, 0.04, 0.02,   5000},
+       {"lipo3s",    12.3, 0.03, 0.01,   1000},
+   };
+} // namespace
+
+const IgniterSpec* findIgniter(const char* name)
+{
+   for (const IgniterSpec& s : IGNITERS)
+   {
+      if (strcmp(s.name, name) == 0)
+         return &s;
+   }
+   return nullptr;
+}
+
+const BatterySpec* findBattery(const char* name)
+{
+   for (const BatterySpec& s : BATTERIES)
+   {
+      if (strcmp(s.name, name) == 0)
+         return &s;
+   }
+   return nullptr;
+}
+
+const IgniterSpec* igniterPresets(uint8_t& count)
+{
+   count = sizeof(IGNITERS) / sizeof(IGNITERS[0]);
+   return IGNITERS;
+}
+
+const BatterySpec* batteryPresets(uint8_t& count)
+{
+   count = sizeof(BATTERIES) / sizeof(BATTERIES[0]);
+   return BATTERIES;
+}
+
+PowerModel::PowerModel(const Circuit& circuit, double dtMs) : circuit(circuit), dtMs(dtMs)
+{
+   tauMs        = circuit.igniter.heatCapacity / circuit.igniter.lossWPerK * 1000.0;
+   thermalDecay = std::exp(-dtMs / tauMs);
+   polarDecay   = std::exp(-dtMs / circuit.battery.polarTauMs);
+   terminalV    = circuit.battery.emfV;
+   minTerminalV = terminalV;
+}
+
+void PowerModel::step(bool relayDriven, double coilDuty)
+{
+   const IgniterSpec& ig   = circuit.igniter;
+   const BatterySpec& bat  = circuit.battery;
+   const RelayCoil&   coil = circuit.coil;
+
+   // With the PWM smoothed by the coil's inductance, the coil current is duty times its
+   // full value and the supply only delivers it for duty of the time: duty squared power
+   coilJ += coilDuty * coilDuty * coil.volts * coil.volts / coil.ohms * dtMs / 1000.0;
+
+   // Contacts close on full drive and stay closed while the drive holds them
+   if (!relayDriven)
+      pulledIn = false;
+   else if (coilDuty >= 1.0)
+      pulledIn = true;
+   else if (coilDuty < coil.holdFraction)
+   {
+      droppedOut = droppedOut || pulledIn;
+      pulledIn   = false;
+   }
+   const bool relayClosed = relayDriven && pulledIn;
+
+   if (relayWas && !relayClosed)
+      breakCurrent = current;
+   relayWas = relayClosed;
+
+   // Open circuit: the wire cools and the battery recovers
+   if (!relayClosed || open)
+   {
+      current = 0;
+      riseK *= thermalDecay;
+      polarV *= polarDecay;
+      terminalV = bat.emfV - polarV;
+      return;
+   }
+
+   const double igniterOhms = ig.ohms * (1.0 + ig.tempco * riseK);
+   current   = (bat.emfV - polarV) / (bat.internalOhms + circuit.leadOhms + circuit.relayOhms +
+                                    igniterOhms);
+   terminalV = bat.emfV - polarV - current * bat.internalOhms;
+
+   // Constant power over the step: exponential approach to the steady-state rise
+   const double power  = current * current * igniterOhms;
+   const double target = power / ig.lossWPerK;
+   const double next   = target + (riseK - target) * thermalDecay;
+   if (!fired && next >= ig.fireRiseK)
+   {
+      fired  = true;
+      fireMs = closedMs - tauMs * std::log((target - ig.fireRiseK) / (target - riseK));
+   }
+   riseK  = next;
+   polarV = current * bat.polarOhms + (polarV - current * bat.polarOhms) * polarDecay;
+
+   chargeC += current * dtMs / 1000.0;
+   energyJ += bat.emfV * current * dtMs / 1000.0;
+   if (current > peakCurrent)
+      peakCurrent = current;
+   if (terminalV < minTerminalV)
+      minTerminalV = terminalV;
+
+   closedMs += dtMs;
+   if (fired && ig.burnoutMs >= 0 && closedMs - fireMs >= ig.burnoutMs)
+   {
+      open    = true;
+      current = 0;
+   }
+}
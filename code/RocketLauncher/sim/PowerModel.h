@@ -0,0 +1,177 @@
+#ifndef POWER_MODEL_H
+#define POWER_MODEL_H
+
+#include <cstdint>
+
+// Igniter bridgewire as one lumped thermal mass
+struct IgniterSpec
+{
+   const char* name;
+   double      ohms;         // cold resistance
+   double      tempco;       // resistance change per kelvin
+   double      heatCapacity; // J/K, bridgewire plus the pyrogen it has to light
+   double      lossWPerK;    // conduction and convection to the surroundings
+   double      fireRiseK;    // temperature rise at which the pyrogen lights
+   double      burnoutMs;    // firing to the wire opening; negative if it never opens
+};
+
+// Battery as an EMF behind an internal resistance, plus a slower polarisation sag
+struct BatterySpec
+{
+   const char* name;
+   double      emfV;
+   double      internalOhms;
+   double      polarOhms;  // extra drop that builds up under sustained load
+   double      polarTauMs; // how quickly it does
+};
+
+// Relay coil on the controller's 5 V rail (a common 5 V sugar-cube relay)
+struct RelayCoil
+{
+   double volts        = 5.0;
+   double ohms         = 70.0;
+   double holdFraction = 0.3; // least average drive that keeps the contacts closed
+};
+
+// Igniter, battery and everything in between
+struct Circuit
+{
+   IgniterSpec igniter;
+   BatterySpec battery;
+   double      leadOhms  = 0.5;  // both leads to the pad, round trip
+   double      relayOhms = 0.05; // contacts
+   RelayCoil   coil      = {};
+};
+
+// Built-in parts for the sweep tool; nullptr if the name is unknown
+const IgniterSpec* findIgniter(const char* name);
+const BatterySpec* findBattery(const char* name);
+const IgniterSpec* igniterPresets(uint8_t& count);
+const BatterySpec* batteryPresets(uint8_t& count);
+
+// Electrical and thermal state of the firing circuit, stepped with the relay
+//
+// Each step holds the relay state and the igniter's resistance for dtMs and
+// integrates the bridgewire temperature exactly over it, so a 1 ms step is
+// stable even for an e-match with a thermal time constant of a few tens of
+// ms. The firing instant is interpolated inside the step that reaches it.
+// The relay coil is counted separately: full drive while it pulls in, then
+// whatever average duty a hold drive gives it. A hold below the coil's
+// holdFraction lets the contacts drop out, which opens the firing circuit.
+class PowerModel
+{
+ public:
+   PowerModel(const Circuit& circuit, double dtMs);
+
+   // Relay driven plainly (coil at full voltage whenever it is closed)
+   void step(bool relayClosed)
+   {
+      step(relayClosed, relayClosed ? 1.0 : 0.0);
+   }
+
+   // coilDuty: average coil drive over the step, 0 to 1
+   void step(bool relayDriven, double coilDuty);
+
+   bool hasFired() const
+   {
+      return fired;
+   }
+
+   // Igniter open circuit: no more current whatever the relay does
+   bool isOpen() const
+   {
+      return open;
+   }
+
+   // Relay closed time until the pyrogen lit
+   double getFireMs() const
+   {
+      return fireMs;
+   }
+
+   double getClosedMs() const
+   {
+      return closedMs;
+   }
+
+   double getCurrent() const
+   {
+      return current;
+   }
+
+   double getTerminalVolts() const
+   {
+      return terminalV;
+   }
+
+   double getMinTerminalVolts() const
+   {
+      return minTerminalV;
+   }
+
+   double getPeakCurrent() const
+   {
+      return peakCurrent;
+   }
+
+   double getRiseK() const
+   {
+      return riseK;
+   }
+
+   // Current the relay contacts broke when they last opened (0 if the igniter opened first)
+   double getBreakCurrent() const
+   {
+      return breakCurrent;
+   }
+
+   // Drawn from the battery so far
+   double getChargeMah() const
+   {
+      return chargeC / 3.6;
+   }
+
+   double getEnergyJ() const
+   {
+      return energyJ;
+   }
+
+   // Spent in the relay coil so far (from the controller's supply, not the firing battery)
+   double getCoilEnergyJ() const
+   {
+      return coilJ;
+   }
+
+   // The hold drive was too weak and the contacts opened while the relay was driven
+   bool hasDroppedOut() const
+   {
+      return droppedOut;
+   }
+
+ private:
+   Circuit circuit;
+   double  dtMs;
+   double  thermalDecay; // exp(-dt / tau) for the bridgewire
+   double  polarDecay;   // the same for the battery's polarisation
+   double  tauMs;
+
+   bool    relayWas     = false;
+   bool    pulledIn     = false;
+   bool    droppedOut   = false;
+   bool    fired        = false;
+   bool    open         = false;
+   double  fireMs       = -1;
+   double  closedMs     = 0;
+   double  riseK        = 0;
+   double  polarV       = 0;
+   double  current      = 0;
+   double  terminalV    = 0;
+   double  minTerminalV = 0;
+   double  peakCurrent  = 0;
+   double  breakCurrent = 0;
+   double  chargeC      = 0;
+   double  energyJ      = 0;
+   double  coilJ        = 0;
+};
+
+#endif // POWER_MODEL_H
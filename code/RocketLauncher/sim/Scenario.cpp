@@ -0,0 +1,465 @@
+#include "Scenario.h"
+#include "StateNames.h"
+#include <cstdlib>
+#include <fstream>
+
+namespace
+{
+   struct OutputName
+   {
+      const char* name;
+      uint8_t     pin;
+   };
+
+   const OutputName OUTPUTS[] = {
+       {"ready", 5}, {"armed", 6}, {"lamp", 7}, {"relay", 8}, {"buzzer", 9}};
+
+   bool parseLevel(const std::string& text, bool& out)
+   {
+      if (text == "on" || text == "1")
+         out = true;
+      else if (text == "off" || text == "0")
+         out = false;
+      else
+         return false;
+      return true;
+   }
+} // namespace
+
+// Digits only: strtoul would take a sign and wrap "-5" round to 4294967291
+bool parseScenarioUint(const std::string& text, uint32_t& out)
+{
+   if (text.empty() || text[0] < '0' || text[0] > '9')
+      return false;
+   char*         end = nullptr;
+   unsigned long v   = strtoul(text.c_str(), &end, 10);
+   if (*end != '\0')
+      return false;
+   out = (uint32_t)v;
+   return true;
+}
+
+uint8_t scenarioInputBit(const std::string& name)
+{
+   if (name == "arm")
+      return INPUT_BIT_ARM;
+   if (name == "reset")
+      return INPUT_BIT_RESET;
+   if (name == "launch")
+      return INPUT_BIT_LAUNCH;
+   return 0;
+}
+
+std::vector<std::string> tokenizeScenarioLine(const std::string& line)
+{
+   std::vector<std::string> tokens;
+   size_t                   i = 0;
+   while (i < line.size())
+   {
+      const char c = line[i];
+      if (c == '#')
+         break;
+      if (c == ' ' || c == '\t' || c == '\r')
+      {
+         i++;
+         continue;
+      }
+      if (c == '"')
+      {
+         size_t close = line.find('"', i + 1);
+         if (close == std::string::npos)
+            close = line.size();
+         tokens.push_back(line.substr(i, close - i + 1));
+         i = close + 1;
+         continue;
+      }
+      size_t end = i;
+      while (end < line.size() && line[end] != ' ' && line[end] != '\t' && line[end] != '\r')
+         end++;
+      tokens.push_back(line.substr(i, end - i));
+      i = end;
+   }
+   return tokens;
+}
+
+ScenarioRunner::ScenarioRunner(const std::string& name)
+{
+   result.name = name;
+}
+
+ScenarioRunner::~ScenarioRunner() = default;
+
+RocketController& ScenarioRunner::controller()
+{
+   start();
+   return *rocket;
+}
+
+void ScenarioRunner::start()
+{
+   if (started)
+      return;
+   started = true;
+   rocket.reset(new RocketController(front ? front : &hal));
+   rocket->setRangeMode(rangeMode);
+   rocket->setStaticFireMode(staticFire);
+   rocket->setTelemetry(telemetry);
+   rocket->setRawCapture(rawCapture);
+   rocket->setRelayPulseMs(pulseMs);
+   for (const AuxScheduler::Channel& c : auxChannels)
+      rocket->addAuxChannel(c.pin, c.offsetMs, c.pulseMs);
+   hal.setTime(clock);
+   rocket->enter(startState);
+}
+
+void ScenarioRunner::tick()
+{
+   clock += tickMs;
+   hal.setTime(clock);
+   hal.updateDebouncers();
+   hal.serviceTimers();
+   rocket->update(clock);
+   checkInvariants();
+   if (tickHook)
+      tickHook();
+}
+
+void ScenarioRunner::checkInvariants()
+{
+   if (!result.passed || (!neverMask && !neverTrip))
+      return;
+   const State state = rocket->getState();
+   if (neverMask & (1u << (uint8_t)state))
+      check(false, neverLine, std::string("reached forbidden state ") + stateName(state));
+   else if (neverTrip && rocket->getLastViolation() != SafetyMonitor::Violation::NONE)
+      check(false, neverLine, "safety monitor tripped");
+}
+
+void ScenarioRunner::advanceTo(uint32_t t)
+{
+   start();
+   while (clock < t)
+      tick();
+}
+
+bool ScenarioRunner::fail(uint32_t lineNo, const std::string& what)
+{
+   result.passed = false;
+   if (result.message.empty())
+      result.message = "line " + std::to_string(lineNo) + ": " + what;
+   return false;
+}
+
+void ScenarioRunner::check(bool ok, uint32_t lineNo, const std::string& what)
+{
+   result.checks++;
+   if (ok)
+      return;
+   result.failures++;
+   if (result.passed)
+      result.failTime = clock;
+   fail(lineNo, what + " (t=" + std::to_string(clock) + ")");
+}
+
+bool ScenarioRunner::executeLine(const std::string& line, uint32_t lineNo)
+{
+   const std::vector<std::string> tok = tokenizeScenarioLine(line);
+   if (tok.empty())
+      return true;
+
+   // Directives (only before the first timed line)
+   if (tok[0] == "start" || tok[0] == "tick" || tok[0] == "mode" || tok[0] == "pulse" ||
+       tok[0] == "raw")
+   {
+      if (started)
+         return fail(lineNo, "'" + tok[0] + "' must come before the first timed line");
+      if (tok.size() != 2)
+         return fail(lineNo, "'" + tok[0] + "' takes one argument");
+      if (tok[0] == "start" && !parseStateName(tok[1].c_str(), startState))
+         return fail(lineNo, "unknown state '" + tok[1] + "'");
+      if (tok[0] == "tick" && (!parseScenarioUint(tok[1], tickMs) || tickMs == 0))
+         return fail(lineNo, "bad tick '" + tok[1] + "'");
+      if (tok[0] == "pulse")
+      {
+         uint32_t ms = 0;
+         if (!parseScenarioUint(tok[1], ms) || ms < RocketController::MIN_RELAY_PULSE_MS ||
+             ms > RocketController::RELAY_ON_MS)
+            return fail(lineNo, "bad pulse '" + tok[1] + "'");
+         pulseMs = (uint16_t)ms;
+      }
+      if (tok[0] == "raw" && !parseLevel(tok[1], rawCapture))
+         return fail(lineNo, "usage: raw on|off");
+      if (tok[0] == "mode")
+      {
+         if (tok[1] == "static")
+            staticFire = true;
+         else if (tok[1] == "range" || tok[1] == "standard")
+            rangeMode = tok[1] == "range";
+         else
+            return fail(lineNo, "unknown mode '" + tok[1] + "'");
+      }
+      return true;
+   }
+
+   // Aux channel: aux <pin> <offset ms> <pulse ms>
+   if (tok[0] == "aux")
+   {
+      if (started)
+         return fail(lineNo, "'aux' must come before the first timed line");
+      char*    end    = nullptr;
+      uint32_t pin    = 0;
+      uint32_t pulse  = 0;
+      long     offset = tok.size() == 4 ? strtol(tok[2].c_str(), &end, 10) : 0;
+      if (tok.size() != 4 || *end != '\0' || offset < INT16_MIN || offset > INT16_MAX ||
+          !parseScenarioUint(tok[1], pin) || pin >= SimArduinoInterface::PIN_COUNT ||
+          !parseScenarioUint(tok[3], pulse) || pulse == 0 || pulse > UINT16_MAX ||
+          auxChannels.size() >= AuxScheduler::MAX_CHANNELS)
+         return fail(lineNo, "usage: aux <pin> <offset ms> <pulse ms> (up to 4)");
+      auxChannels.push_back({(uint8_t)pin, (int16_t)offset, (uint16_t)pulse});
+      return true;
+   }
+
+   // Invariants checked on every tick (also before the first timed line only)
+   if (tok[0] == "never")
+   {
+      if (started)
+         return fail(lineNo, "'never' must come before the first timed line");
+      return executeNever(std::vector<std::string>(tok.begin() + 1, tok.end()), lineNo);
+   }
+
+   // Timestamp
+   uint32_t t        = 0;
+   bool     relative = tok[0][0] == '+';
+   if (!parseScenarioUint(relative ? tok[0].substr(1) : tok[0], t))
+      return fail(lineNo, "expected a time, got '" + tok[0] + "'");
+   if (relative)
+      t += lastTime;
+   if (t < lastTime)
+      return fail(lineNo, "time goes backwards");
+   lastTime = t;
+   if (tok.size() < 2)
+      return fail(lineNo, "missing command");
+
+   advanceTo(t);
+
+   const std::string& cmd = tok[1];
+   if (const uint8_t bit = scenarioInputBit(cmd))
+   {
+      bool level = false;
+      if (tok.size() != 3 || !parseLevel(tok[2], level))
+         return fail(lineNo, "usage: " + cmd + " on|off");
+      hal.setInputs(level ? (hal.getInputs() | bit) : (hal.getInputs() & ~bit));
+      return true;
+   }
+   if (cmd == "expect")
+      return executeExpect(std::vector<std::string>(tok.begin() + 2, tok.end()), lineNo);
+   if (cmd == "run")
+      return true; // just advance time
+   if (cmd == "stuck")
+   {
+      uint32_t pin   = 0;
+      bool     level = false;
+      if (tok.size() != 4 || !parseScenarioUint(tok[2], pin) ||
+          pin >= SimArduinoInterface::PIN_COUNT || (tok[3] != "free" && !parseLevel(tok[3], level)))
+         return fail(lineNo, "usage: stuck <pin> on|off|free");
+      if (tok[3] == "free")
+         hal.freePin((uint8_t)pin);
+      else
+         hal.stickPin((uint8_t)pin, level ? HIGH : LOW);
+      return true;
+   }
+   if (cmd == "glitch")
+   {
+      const uint8_t bit = tok.size() == 4 ? scenarioInputBit(tok[2]) : 0;
+      uint32_t      us  = 0;
+      if (!bit || !parseScenarioUint(tok[3], us) || us == 0)
+         return fail(lineNo, "usage: glitch arm|reset|launch <us>");
+      hal.glitch(bit, us);
+      return true;
+   }
+   if (cmd == "load")
+   {
+      char*      end   = nullptr;
+      const long value = tok.size() == 3 ? strtol(tok[2].c_str(), &end, 10) : 0;
+      if (tok.size() != 3 || *end != '\0')
+         return fail(lineNo, "usage: load <raw value>");
+      hal.setLoadCell((int32_t)value);
+      return true;
+   }
+
+   return fail(lineNo, "unknown command '" + cmd + "'");
+}
+
+bool ScenarioRunner::executeExpect(const std::vector<std::string>& args, uint32_t lineNo)
+{
+   if (args.empty())
+      return fail(lineNo, "expect needs a subject");
+
+   const std::string& what = args[0];
+   if (what == "state" && args.size() == 2)
+   {
+      State want;
+      if (!parseStateName(args[1].c_str(), want))
+         return fail(lineNo, "unknown state '" + args[1] + "'");
+      const State got = rocket->getState();
+      check(got == want, lineNo,
+            std::string("expected state ") + stateName(want) + ", got " + stateName(got));
+      return true;
+   }
+
+   if (what == "lcd" && args.size() == 3)
+   {
+      uint32_t row = 0;
+      if (!parseScenarioUint(args[1], row) || row >= SimArduinoInterface::LCD_ROWS ||
+          args[2].size() < 2 || args[2].front() != '"')
+         return fail(lineNo, "usage: expect lcd <row> \"text\"");
+      const std::string want = args[2].substr(1, args[2].size() - 2);
+      const std::string got  = hal.getLcdLine((uint8_t)row);
+      check(got == want, lineNo,
+            "expected lcd " + args[1] + " \"" + want + "\", got \"" + got + "\"");
+      return true;
+   }
+
+   if (what == "tone" && args.size() == 2)
+   {
+      uint32_t want = 0;
+      if (args[1] != "off" && !parseScenarioUint(args[1], want))
+         return fail(lineNo, "usage: expect tone <freq>|off");
+      check(hal.getToneFreq() == want, lineNo,
+            "expected tone " + args[1] + ", got " + std::to_string(hal.getToneFreq()));
+      return true;
+   }
+
+   if ((what == "captured" || what == "dropped") && args.size() == 2)
+   {
+      uint32_t want = 0;
+      if (!parseScenarioUint(args[1], want))
+         return fail(lineNo, "usage: expect " + what + " <n>");
+      const LoadCellCapture& cap = rocket->getCapture();
+      const uint32_t         got = what == "captured" ? cap.captured() : cap.dropped();
+      check(got == want, lineNo,
+            "expected " + what + " " + args[1] + ", got " + std::to_string(got));
+      return true;
+   }
+
+   if ((what == "rawwindows" || what == "rawmissed") && args.size() == 2)
+   {
+      uint32_t want = 0;
+      if (!parseScenarioUint(args[1], want))
+         return fail(lineNo, "usage: expect " + what + " <n>");
+      const uint32_t got = what == "rawwindows" ? rocket->getRawWindowsSent()
+                                                : rocket->getRawCapture().missed();
+      check(got == want, lineNo,
+            "expected " + what + " " + args[1] + ", got " + std::to_string(got));
+      return true;
+   }
+
+   if (what == "frames" && args.size() == 3)
+   {
+      uint32_t want = 0;
+      if (args[1].size() != 1 || !parseScenarioUint(args[2], want))
+         return fail(lineNo, "usage: expect frames <type letter> <n>");
+      const uint32_t got = hal.getFrameCount((uint8_t)args[1][0]);
+      check(got == want, lineNo,
+            "expected " + args[2] + " '" + args[1] + "' frames, got " + std::to_string(got));
+      return true;
+   }
+
+   if ((what == "launches" || what == "cycle") && args.size() == 2)
+   {
+      uint32_t want = 0;
+      if (!parseScenarioUint(args[1], want))
+         return fail(lineNo, "usage: expect " + what + " <n>");
+      const uint32_t got =
+          what == "launches" ? rocket->getLaunchCount() : rocket->getLastCycleMs();
+      check(got == want, lineNo,
+            "expected " + what + " " + args[1] + ", got " + std::to_string(got));
+      return true;
+   }
+
+   if (what == "pin" && args.size() == 3)
+   {
+      uint32_t pin   = 0;
+      bool     level = false;
+      if (!parseScenarioUint(args[1], pin) || pin >= SimArduinoInterface::PIN_COUNT ||
+          !parseLevel(args[2], level))
+         return fail(lineNo, "usage: expect pin <n> on|off");
+      check((hal.digitalRead((uint8_t)pin) == HIGH) == level, lineNo,
+            "expected pin " + args[1] + " " + args[2]);
+      return true;
+   }
+
+   for (const OutputName& out : OUTPUTS)
+   {
+      if (what != out.name)
+         continue;
+      bool level = false;
+      if (args.size() != 2 || !parseLevel(args[1], level))
+         return fail(lineNo, "usage: expect " + what + " on|off");
+      const bool got = out.pin == 9 ? hal.getToneFreq() != 0 : hal.digitalRead(out.pin) == HIGH;
+      check(got == level, lineNo, "expected " + what + " " + args[1]);
+      return true;
+   }
+
+   return fail(lineNo, "unknown expectation '" + what + "'");
+}
+
+bool ScenarioRunner::executeNever(const std::vector<std::string>& args, uint32_t lineNo)
+{
+   neverLine = lineNo;
+   if (args.size() == 2 && args[0] == "state")
+   {
+      State s;
+      if (!parseStateName(args[1].c_str(), s))
+         return fail(lineNo, "unknown state '" + args[1] + "'");
+      neverMask |= (uint16_t)(1u << (uint8_t)s);
+      return true;
+   }
+   if (args.size() == 1 && args[0] == "violation")
+   {
+      neverTrip = true;
+      return true;
+   }
+   return fail(lineNo, "usage: never state <STATE> | never violation");
+}
+
+ScenarioResult ScenarioRunner::finish()
+{
+   start();
+   result.endTime  = clock;
+   result.launches = rocket->getLaunchCount();
+   result.cycleMs  = rocket->getTotalCycleMs();
+   return result;
+}
+
+ScenarioResult ScenarioRunner::runStream(std::istream& in, const std::string& name,
+                                         std::vector<uint8_t>* serial)
+{
+   ScenarioRunner runner(name);
+   runner.setTelemetry(serial != nullptr);
+   std::string    line;
+   uint32_t       lineNo = 0;
+   while (std::getline(in, line))
+   {
+      if (!runner.executeLine(line, ++lineNo))
+         break; // parse error: the rest of the file is meaningless
+   }
+   const ScenarioResult result = runner.finish();
+   if (serial)
+      *serial = runner.sim().getSerialOutput();
+   return result;
+}
+
+ScenarioResult ScenarioRunner::runFile(const std::string& path, std::vector<uint8_t>* serial)
+{
+   std::ifstream in(path);
+   if (!in)
+   {
+      ScenarioResult r;
+      r.name    = path;
+      r.passed  = false;
+      r.message = "cannot open file";
+      return r;
+   }
+   return runStream(in, path, serial);
+}
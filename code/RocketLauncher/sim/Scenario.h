@@ -0,0 +1,129 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "RocketController.h"
+#include "SimArduinoInterface.h"
+
+// Outcome of one scenario run
+struct ScenarioResult
+{
+   std::string name;
+   bool        passed   = true;
+   uint32_t    checks   = 0;
+   uint32_t    failures = 0;
+   uint32_t    endTime  = 0;
+   uint16_t    launches = 0; // completed launch cycles
+   uint32_t    cycleMs  = 0; // total time of those cycles
+   uint32_t    failTime = 0; // simulated time of the first failure
+   std::string message; // first failure or parse error
+};
+
+// Executes a scenario in virtual time, one line at a time
+//
+// Lines are "<time> <command> [args]" where time is absolute ms or "+N"
+// relative to the previous line; see scenarios/README.md for the commands.
+// Nothing is buffered: each line advances the simulation to its timestamp and
+// is applied immediately, so arbitrarily long files run in constant memory.
+class ScenarioRunner
+{
+ public:
+   explicit ScenarioRunner(const std::string& name);
+   ~ScenarioRunner();
+
+   // Execute one line; returns false (and records the error) if it cannot be parsed
+   bool                  executeLine(const std::string& line, uint32_t lineNo);
+
+   // Stop the run and collect the result
+   ScenarioResult        finish();
+
+   // With serial set, telemetry is on and the simulated port's output is returned there
+   static ScenarioResult runStream(std::istream& in, const std::string& name,
+                                   std::vector<uint8_t>* serial = nullptr);
+   static ScenarioResult runFile(const std::string& path, std::vector<uint8_t>* serial = nullptr);
+
+   // Simulation access for tools built on the runner
+   SimArduinoInterface& sim()
+   {
+      return hal;
+   }
+
+   RocketController& controller();
+
+   // Send telemetry frames to the simulated serial port (before the first timed line)
+   void setTelemetry(bool enabled)
+   {
+      telemetry = enabled;
+   }
+
+   uint32_t now() const
+   {
+      return clock;
+   }
+
+   bool failed() const
+   {
+      return !result.passed;
+   }
+
+   // Advance virtual time to t (no-op if already there)
+   void advanceTo(uint32_t t);
+
+   // Give the controller front, a decorator over sim(), instead of sim() itself (before
+   // the first timed line); the runner keeps servicing sim() directly
+   void setInterface(ArduinoInterface* front)
+   {
+      this->front = front;
+   }
+
+   // Called after every tick, once the controller has updated, for tools watching the run
+   void setTickHook(std::function<void()> hook)
+   {
+      tickHook = std::move(hook);
+   }
+
+ private:
+   SimArduinoInterface               hal;
+   ArduinoInterface*                 front = nullptr;
+   std::unique_ptr<RocketController> rocket;
+   ScenarioResult                    result;
+   State                             startState = State::SPLASH;
+   bool                              rangeMode  = false;
+   bool                              staticFire = false;
+   bool                              telemetry  = false;
+   bool                              rawCapture = false;
+   uint16_t                          pulseMs    = RocketController::RELAY_ON_MS;
+   std::vector<AuxScheduler::Channel> auxChannels;
+   uint16_t                          neverMask  = 0; // forbidden states, bit per State
+   bool                              neverTrip  = false;
+   uint32_t                          neverLine  = 0;
+   uint32_t                          tickMs     = 1;
+   uint32_t                          clock      = 0;
+   uint32_t                          lastTime   = 0;
+   bool                              started    = false;
+   std::function<void()>             tickHook;
+
+   void start();
+   void tick();
+   bool fail(uint32_t lineNo, const std::string& what);
+   void check(bool ok, uint32_t lineNo, const std::string& what);
+   bool executeExpect(const std::vector<std::string>& args, uint32_t lineNo);
+   bool executeNever(const std::vector<std::string>& args, uint32_t lineNo);
+   void checkInvariants();
+};
+
+// Split a scenario line into tokens ("quoted strings" kept whole, # starts a comment)
+std::vector<std::string> tokenizeScenarioLine(const std::string& line);
+
+// Unsigned decimal as scenario files write counts, pins and times (no sign, no suffix)
+bool                     parseScenarioUint(const std::string& text, uint32_t& out);
+
+// INPUT_BIT_* for "arm", "reset" or "launch"; 0 for anything else
+uint8_t                  scenarioInputBit(const std::string& name);
+
+#endif // SCENARIO_H
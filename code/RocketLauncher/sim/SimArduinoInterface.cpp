@@ -0,0 +1,280 @@
+#include "SimArduinoInterface.h"
+#include "LoadCellCapture.h"
+#include "RawCapture.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+SimArduinoInterface::SimArduinoInterface()
+{
+   memset(pins, 0, sizeof(pins));
+   memset(stuck, NOT_STUCK, sizeof(stuck));
+   memset(eeprom, 0xFF, sizeof(eeprom));
+   lcdClear();
+}
+
+// Pin control
+void SimArduinoInterface::digitalWrite(uint8_t pin, uint8_t state)
+{
+   if (pin < PIN_COUNT)
+      pins[pin] = state ? HIGH : LOW;
+}
+
+uint8_t SimArduinoInterface::digitalRead(uint8_t pin) const
+{
+   if (pin >= PIN_COUNT)
+      return LOW;
+   return stuck[pin] != NOT_STUCK ? stuck[pin] : pins[pin];
+}
+
+void SimArduinoInterface::relayWrite(uint8_t pin, bool on)
+{
+   if (pin == PIN_RELAY && on && !relayOn)
+      relayOnAt = now;
+   if (pin == PIN_RELAY)
+      relayOn = on;
+   digitalWrite(pin, on ? HIGH : LOW);
+}
+
+double SimArduinoInterface::getCoilDuty() const
+{
+   if (!relayOn)
+      return 0;
+   return now - relayOnAt < relayPullInMs ? 1.0 : relayHoldPct / 100.0;
+}
+
+void SimArduinoInterface::stickPin(uint8_t pin, uint8_t level)
+{
+   if (pin < PIN_COUNT)
+      stuck[pin] = level ? HIGH : LOW;
+}
+
+void SimArduinoInterface::freePin(uint8_t pin)
+{
+   if (pin < PIN_COUNT)
+      stuck[pin] = NOT_STUCK;
+}
+
+void SimArduinoInterface::pinMode(uint8_t pin, uint8_t mode)
+{
+   (void)pin;
+   (void)mode;
+}
+
+// Time functions
+uint32_t SimArduinoInterface::millis() const
+{
+   return now;
+}
+
+void SimArduinoInterface::delay(uint32_t ms)
+{
+   now += ms;
+}
+
+// Audio functions
+void SimArduinoInterface::tone(uint8_t pin, uint16_t freq)
+{
+   (void)pin;
+   toneFreq = freq;
+}
+
+void SimArduinoInterface::tone(uint8_t pin, uint16_t freq, uint32_t duration)
+{
+   (void)pin;
+   (void)duration;
+   toneFreq = freq;
+}
+
+void SimArduinoInterface::noTone(uint8_t pin)
+{
+   (void)pin;
+   toneFreq = 0;
+}
+
+// LCD functions
+void SimArduinoInterface::lcdClear()
+{
+   for (uint8_t r = 0; r < LCD_ROWS; r++)
+   {
+      memset(lcd[r], ' ', LCD_COLS);
+      lcd[r][LCD_COLS] = '\0';
+   }
+   cursorCol = 0;
+   cursorRow = 0;
+}
+
+void SimArduinoInterface::lcdSetCursor(uint8_t col, uint8_t row)
+{
+   cursorCol = col;
+   cursorRow = row < LCD_ROWS ? row : LCD_ROWS - 1;
+}
+
+void SimArduinoInterface::lcdPrint(const char* text)
+{
+   // Characters past column 16 land in off-screen DDRAM, as on the real panel
+   for (; *text; text++, cursorCol++)
+   {
+      if (cursorCol < LCD_COLS)
+         lcd[cursorRow][cursorCol] = *text;
+   }
+}
+
+void SimArduinoInterface::lcdPrint(int number)
+{
+   char buf[12];
+   snprintf(buf, sizeof(buf), "%d", number);
+   lcdPrint(buf);
+}
+
+const char* SimArduinoInterface::getLcdLine(uint8_t row) const
+{
+   memcpy(trimmed, lcd[row < LCD_ROWS ? row : 0], LCD_COLS + 1);
+   for (int i = LCD_COLS - 1; i >= 0 && trimmed[i] == ' '; i--)
+      trimmed[i] = '\0';
+   return trimmed;
+}
+
+// Button debouncing
+void SimArduinoInterface::updateDebouncers()
+{
+   // Scenario inputs are already clean levels
+}
+
+bool SimArduinoInterface::isArmPressed() const
+{
+   return inputs & INPUT_BIT_ARM;
+}
+
+bool SimArduinoInterface::isResetPressed() const
+{
+   return inputs & INPUT_BIT_RESET;
+}
+
+bool SimArduinoInterface::isLaunchPressed() const
+{
+   return inputs & INPUT_BIT_LAUNCH;
+}
+
+// Load cell and serial
+uint16_t SimArduinoInterface::startLoadCell(LoadCellCapture* target)
+{
+   capture    = target;
+   lastSample = now;
+   return LOADCELL_RATE_HZ;
+}
+
+void SimArduinoInterface::stopLoadCell()
+{
+   capture = nullptr;
+}
+
+uint16_t SimArduinoInterface::startRawCapture(RawCapture* target)
+{
+   rawTarget  = target;
+   rawSampled = (uint64_t)now * (RAW_RATE_HZ / 1000);
+   return RAW_RATE_HZ;
+}
+
+void SimArduinoInterface::stopRawCapture()
+{
+   rawTarget = nullptr;
+}
+
+void SimArduinoInterface::glitch(uint8_t mask, uint32_t us)
+{
+   const uint32_t samplePeriodUs = 1000000 / RAW_RATE_HZ;
+   glitchMask                    = mask;
+   glitchLeft                    = (us + samplePeriodUs - 1) / samplePeriodUs;
+}
+
+void SimArduinoInterface::serviceTimers()
+{
+   for (; capture && lastSample < now; lastSample++)
+      capture->push(loadCell);
+   for (; rawTarget && rawSampled < (uint64_t)now * (RAW_RATE_HZ / 1000); rawSampled++)
+   {
+      uint8_t levels = inputs;
+      if (glitchLeft)
+      {
+         levels ^= glitchMask;
+         glitchLeft--;
+      }
+      rawTarget->sample(levels);
+   }
+   if (!rawTarget)
+      glitchLeft = 0;
+   drainEeprom(now);
+}
+
+// Program queued bytes back to back, each finishing EEPROM_WRITE_MS after it starts
+void SimArduinoInterface::drainEeprom(uint32_t until)
+{
+   uint32_t at = now; // when the next byte can start
+   for (;;)
+   {
+      if (eepromQueue.isProgramming())
+      {
+         if (eepromDoneAt > until)
+            return;
+         eeprom[eepromAddr] = eepromValue;
+         eepromQueue.programmed();
+         at = eepromDoneAt;
+      }
+      if (!eepromQueue.pop(eepromAddr, eepromValue))
+         return;
+      if (eeprom[eepromAddr] == eepromValue)
+      {
+         eepromQueue.skipped();
+         continue;
+      }
+      eepromDoneAt = at + EEPROM_WRITE_MS;
+      eepromQueue.started();
+   }
+}
+
+bool SimArduinoInterface::persist(uint16_t addr, const uint8_t* data, uint8_t len)
+{
+   if ((uint32_t)addr + len > EEPROM_BYTES)
+      return false;
+   return eepromQueue.write(addr, data, len);
+}
+
+bool SimArduinoInterface::recall(uint16_t addr, uint8_t* data, uint8_t len) const
+{
+   if ((uint32_t)addr + len > EEPROM_BYTES)
+      return false;
+   memcpy(data, eeprom + addr, len);
+   return true;
+}
+
+bool SimArduinoInterface::persistIdle() const
+{
+   return eepromQueue.isIdle();
+}
+
+// Virtual time does not move here, so the remaining bytes complete at once
+void SimArduinoInterface::persistFlush()
+{
+   drainEeprom(UINT32_MAX);
+}
+
+uint16_t SimArduinoInterface::serialWritable() const
+{
+   return 256; // a fast link that never backs up
+}
+
+void SimArduinoInterface::serialWrite(const uint8_t* data, uint16_t len)
+{
+   serialOut.insert(serialOut.end(), data, data + len);
+   for (uint16_t i = 0; i < len; i++)
+   {
+      if (decoder.feed(data[i]))
+         frameCounts[decoder.type()]++;
+   }
+}
+
+uint32_t SimArduinoInterface::getFrameCount(uint8_t type) const
+{
+   return frameCounts[type];
+}
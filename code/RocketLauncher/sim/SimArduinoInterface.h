@@ -0,0 +1,186 @@
+#ifndef SIM_ARDUINO_INTERFACE_H
+#define SIM_ARDUINO_INTERFACE_H
+
+#include <vector>
+#include "ArduinoInterface.h"
+#include "SerialFrame.h"
+#include "EepromQueue.h"
+
+// Host-side hardware model driven in virtual time
+//
+// Inputs are taken as already-debounced levels, pins and the buzzer are
+// recorded, and the LCD is modelled as a 16x2 character buffer with the
+// same cursor semantics as an HD44780. Raw input capture sees the same
+// levels at 10 kHz, plus any injected glitches. The EEPROM is 1 KB, erased
+// to 0xFF, and programs one byte per EEPROM_WRITE_MS of virtual time like
+// the ATmega328P's EE_READY drain.
+class SimArduinoInterface : public ArduinoInterface
+{
+ public:
+   static constexpr uint8_t LCD_COLS  = 16;
+   static constexpr uint8_t LCD_ROWS  = 2;
+   static constexpr uint8_t PIN_COUNT = 20;
+   static constexpr uint8_t NOT_STUCK = 0xFF;
+
+   SimArduinoInterface();
+
+   // Pin control
+   void     digitalWrite(uint8_t pin, uint8_t state) override;
+   uint8_t  digitalRead(uint8_t pin) const override;
+   void     pinMode(uint8_t pin, uint8_t mode) override;
+
+   // Relay on pin 8, with the firmware's pull-in and hold timing for the coil model
+   void     relayWrite(uint8_t pin, bool on) override;
+
+   static constexpr uint8_t PIN_RELAY = 8;
+
+   // Time functions
+   uint32_t millis() const override;
+   void     delay(uint32_t ms) override;
+
+   // Audio functions
+   void     tone(uint8_t pin, uint16_t freq) override;
+   void     tone(uint8_t pin, uint16_t freq, uint32_t duration) override;
+   void     noTone(uint8_t pin) override;
+
+   // LCD functions
+   void     lcdClear() override;
+   void     lcdSetCursor(uint8_t col, uint8_t row) override;
+   void     lcdPrint(const char* text) override;
+   void     lcdPrint(int number) override;
+
+   // Button debouncing
+   void     updateDebouncers() override;
+   bool     isArmPressed() const override;
+   bool     isResetPressed() const override;
+   bool     isLaunchPressed() const override;
+
+   // Load cell sampled once per simulated millisecond; serial output recorded
+   uint16_t startLoadCell(LoadCellCapture* capture) override;
+   void     stopLoadCell() override;
+   uint16_t serialWritable() const override;
+   void     serialWrite(const uint8_t* data, uint16_t len) override;
+
+   static constexpr uint16_t LOADCELL_RATE_HZ = 1000;
+
+   // Raw inputs sampled at the firmware's fast-tick rate: the debounced levels, plus glitches
+   uint16_t startRawCapture(RawCapture* capture) override;
+   void     stopRawCapture() override;
+
+   static constexpr uint16_t RAW_RATE_HZ      = 10000;
+
+   // EEPROM queued and programmed in the background
+   bool     persist(uint16_t addr, const uint8_t* data, uint8_t len) override;
+   bool     recall(uint16_t addr, uint8_t* data, uint8_t len) const override;
+   bool     persistIdle() const override;
+   void     persistFlush() override;
+
+   static constexpr uint16_t EEPROM_BYTES    = 1024;
+   static constexpr uint8_t  EEPROM_WRITE_MS = 4; // 3.4 ms byte cycle, rounded up
+
+   // Simulation control
+   void setTime(uint32_t ms)
+   {
+      now = ms;
+   }
+
+   void setInputs(uint8_t mask)
+   {
+      inputs = mask;
+   }
+
+   uint8_t getInputs() const
+   {
+      return inputs;
+   }
+
+   // Coil drive as a ROCKET_RELAY_HOLD_PCT build has it (100: plain drive)
+   void setRelayHold(uint16_t pullInMs, uint8_t holdPct)
+   {
+      relayPullInMs = pullInMs;
+      relayHoldPct  = holdPct;
+   }
+
+   // Average drive on the relay coil right now, 0 to 1
+   double getCoilDuty() const;
+
+   // Invert the raw levels of mask for the next us microseconds (never seen debounced)
+   void glitch(uint8_t mask, uint32_t us);
+
+   // Value the load cell reads from now on
+   void setLoadCell(int32_t value)
+   {
+      loadCell = value;
+   }
+
+   // Deliver the timer-driven samples and EEPROM bytes due up to the current time
+   void serviceTimers();
+
+   // Fault injection: the pin reads level whatever is written (welded relay, shorted LED)
+   void stickPin(uint8_t pin, uint8_t level);
+   void freePin(uint8_t pin);
+
+   // Observation
+   uint16_t getToneFreq() const
+   {
+      return toneFreq;
+   }
+
+   // Row contents with trailing blanks removed
+   const char* getLcdLine(uint8_t row) const;
+
+   const std::vector<uint8_t>& getSerialOutput() const
+   {
+      return serialOut;
+   }
+
+   // Well-formed frames seen on the serial output, by type
+   uint32_t getFrameCount(uint8_t type) const;
+
+   uint8_t getEepromByte(uint16_t addr) const
+   {
+      return eeprom[addr % EEPROM_BYTES];
+   }
+
+   const EepromQueue& getEepromQueue() const
+   {
+      return eepromQueue;
+   }
+
+ private:
+   uint32_t             now        = 0;
+   uint8_t              inputs     = 0;
+   uint8_t              pins[PIN_COUNT];
+   uint8_t              stuck[PIN_COUNT]; // level, or NOT_STUCK
+   uint16_t             toneFreq   = 0;
+   char                 lcd[LCD_ROWS][LCD_COLS + 1];
+   uint8_t              cursorCol  = 0;
+   uint8_t              cursorRow  = 0;
+   mutable char         trimmed[LCD_COLS + 1];
+
+   bool                 relayOn       = false;
+   uint32_t             relayOnAt     = 0;
+   uint16_t             relayPullInMs = 0;
+   uint8_t              relayHoldPct  = 100;
+
+   LoadCellCapture*     capture    = nullptr;
+   int32_t              loadCell   = 0;
+   uint32_t             lastSample = 0;
+   RawCapture*          rawTarget  = nullptr;
+   uint64_t             rawSampled = 0; // raw samples taken since time 0
+   uint8_t              glitchMask = 0;
+   uint32_t             glitchLeft = 0; // samples still inverted
+   std::vector<uint8_t> serialOut;
+   FrameDecoder         decoder;
+   uint32_t             frameCounts[256] = {0};
+
+   uint8_t              eeprom[EEPROM_BYTES];
+   EepromQueue          eepromQueue;
+   uint16_t             eepromAddr   = 0; // byte being programmed
+   uint8_t              eepromValue  = 0;
+   uint32_t             eepromDoneAt = 0;
+
+   void                 drainEeprom(uint32_t until);
+};
+
+#endif // SIM_ARDUINO_INTERFACE_H
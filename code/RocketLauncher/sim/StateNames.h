@@ -0,0 +1,30 @@
+#ifndef STATE_NAMES_H
+#define STATE_NAMES_H
+
+#include <cstring>
+#include "RocketController.h"
+
+// Text names for State, shared by the host tools
+static const char* const STATE_NAMES[] = {"STARTUP",   "SPLASH",   "READY", "ARMED", "LAUNCH_COUNTDOWN",
+                                          "LAUNCHING", "COOLDOWN", "ABORT", "FAULT"};
+static const uint8_t     STATE_NAME_COUNT = sizeof(STATE_NAMES) / sizeof(STATE_NAMES[0]);
+
+inline const char* stateName(State s)
+{
+   return (uint8_t)s < STATE_NAME_COUNT ? STATE_NAMES[(uint8_t)s] : "?";
+}
+
+inline bool parseStateName(const char* text, State& out)
+{
+   for (uint8_t i = 0; i < STATE_NAME_COUNT; i++)
+   {
+      if (strcmp(text, STATE_NAMES[i]) == 0)
+      {
+         out = (State)i;
+         return true;
+      }
+   }
+   return false;
+}
+
+#endif // STATE_NAMES_H
@@ -0,0 +1,248 @@
+#include "TwinVerifier.h"
+#include "StateNames.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+   const char* const KIND_NAMES[] = {"STUCK_RELAY",       "RELAY_NOT_CLOSED",
+                                     "MISSED_TRANSITION", "UNEXPECTED_TRANSITION",
+                                     "STATE_MISMATCH",    "OUTPUT_MISMATCH",
+                                     "MODE_MISMATCH",     "TIMING_DRIFT"};
+
+   const char* stateText(uint8_t state)
+   {
+      return stateName((State)state);
+   }
+
+   std::string outputsText(uint8_t outputs)
+   {
+      static const char* const NAMES[] = {"ready", "armed", "lamp", "relay",
+                                          "aux0",  "aux1",  "aux2", "aux3"};
+      std::string text;
+      for (uint8_t i = 0; i < 8; i++)
+      {
+         if (!(outputs & (1u << i)))
+            continue;
+         if (!text.empty())
+            text += '+';
+         text += NAMES[i];
+      }
+      return text.empty() ? "none" : text;
+   }
+} // namespace
+
+const char* divergenceName(Divergence::Kind kind)
+{
+   return kind < sizeof(KIND_NAMES) / sizeof(KIND_NAMES[0]) ? KIND_NAMES[kind] : "?";
+}
+
+bool parseDivergenceName(const char* text, Divergence::Kind& out)
+{
+   for (uint8_t i = 0; i < sizeof(KIND_NAMES) / sizeof(KIND_NAMES[0]); i++)
+   {
+      if (strcmp(text, KIND_NAMES[i]) == 0)
+      {
+         out = (Divergence::Kind)i;
+         return true;
+      }
+   }
+   return false;
+}
+
+TwinVerifier::TwinVerifier(const Options& options) : options(options)
+{
+}
+
+TwinVerifier::~TwinVerifier() = default;
+
+void TwinVerifier::onSample(const TelemetrySample& sample, double hostMs)
+{
+   samples++;
+
+   // Anything the twin did not see makes the replay unreliable until the next sync point
+   if (seenAny)
+   {
+      // Time going backwards is a device reset, which also restarts the sequence
+      const bool     reset   = (int32_t)(sample.ms - lastMs) < 0;
+      const uint16_t missing = reset ? 0 : (uint16_t)(sample.seq - nextSeq);
+      lostSamples += missing + sample.lost;
+      if (synced && (reset || missing || sample.lost || sample.ms - lastMs > MAX_GAP_MS))
+         desync();
+   }
+   seenAny = true;
+   nextSeq = (uint16_t)(sample.seq + 1);
+   lastMs  = sample.ms;
+
+   if (!synced)
+   {
+      if (sample.state != (uint8_t)State::SPLASH && sample.state != (uint8_t)State::READY)
+         return;
+      sync(sample, hostMs);
+   }
+   else
+   {
+      stepTo(sample);
+   }
+
+   compare(sample);
+   if (synced)
+      checkClock(sample, hostMs);
+}
+
+void TwinVerifier::sync(const TelemetrySample& sample, double hostMs)
+{
+   twin.reset();
+   hal.reset(new SimArduinoInterface());
+   hal->setTime(sample.ms);
+   hal->setInputs(sample.inputs);
+
+   twin.reset(new RocketController(hal.get()));
+   twin->setRangeMode(sample.flags & TELEMETRY_FLAG_RANGE);
+   twin->setStaticFireMode(sample.flags & TELEMETRY_FLAG_STATIC);
+   twin->setRelayPulseMs(options.relayPulseMs);
+   for (const AuxScheduler::Channel& c : options.auxChannels)
+      twin->addAuxChannel(c.pin, c.offsetMs, c.pulseMs);
+   twin->enter((State)sample.state);
+
+   synced       = true;
+   pending      = false;
+   agreedState  = sample.state;
+   syncMs       = sample.ms;
+   windowStart  = sample.ms;
+   windowOffset = hostMs - sample.ms;
+   baseSet      = false;
+   driftRaised  = false;
+}
+
+void TwinVerifier::desync()
+{
+   synced  = false;
+   pending = false;
+   resyncs++;
+}
+
+void TwinVerifier::tick(uint32_t t)
+{
+   hal->setTime(t);
+   hal->updateDebouncers();
+   hal->serviceTimers();
+   twin->update(t);
+   twinTicks++;
+}
+
+void TwinVerifier::stepTo(const TelemetrySample& sample)
+{
+   // Inputs only change with a sample, so the previous ones hold until this one
+   uint32_t t = hal->millis();
+   while ((int32_t)(sample.ms - t) > 1)
+      tick(++t);
+   hal->setInputs(sample.inputs);
+   if (sample.ms != t)
+      tick(sample.ms);
+}
+
+void TwinVerifier::compare(const TelemetrySample& device)
+{
+   const TelemetrySample mine = twin->telemetrySnapshot(device.ms);
+   const uint8_t         mask = options.checkAux ? 0xFF : (uint8_t)(TELEMETRY_OUT_AUX0 - 1);
+   const uint8_t         diff = (uint8_t)((mine.outputs ^ device.outputs) & mask);
+
+   if (!diff && mine.state == device.state && mine.flags == device.flags)
+   {
+      if (pending && device.ms - pendingSince > maxLagMs)
+         maxLagMs = device.ms - pendingSince;
+      pending     = false;
+      agreedState = device.state;
+      return;
+   }
+
+   if (!pending)
+   {
+      pending      = true;
+      pendingSince = device.ms;
+   }
+   if (device.ms - pendingSince <= options.toleranceMs)
+      return; // a busy device loop can lag the twin this much
+
+   char detail[128];
+   if (diff & TELEMETRY_OUT_RELAY)
+   {
+      const bool closed = device.outputs & TELEMETRY_OUT_RELAY;
+      snprintf(detail, sizeof(detail),
+               "relay %s on the device, %s on the twin (device %s, twin %s)",
+               closed ? "closed" : "open", closed ? "open" : "closed", stateText(device.state),
+               stateText(mine.state));
+      raise(closed ? Divergence::STUCK_RELAY : Divergence::RELAY_NOT_CLOSED, device.ms,
+            pendingSince, detail);
+   }
+   else if (mine.state != device.state)
+   {
+      Divergence::Kind kind = Divergence::STATE_MISMATCH;
+      if (device.state == agreedState)
+         kind = Divergence::MISSED_TRANSITION;
+      else if (mine.state == agreedState)
+         kind = Divergence::UNEXPECTED_TRANSITION;
+      snprintf(detail, sizeof(detail), "from %s the device is in %s, the twin in %s",
+               stateText(agreedState), stateText(device.state), stateText(mine.state));
+      raise(kind, device.ms, pendingSince, detail);
+   }
+   else if (diff)
+   {
+      snprintf(detail, sizeof(detail), "in %s the device drives %s, the twin %s",
+               stateText(device.state), outputsText(device.outputs & mask).c_str(),
+               outputsText(mine.outputs & mask).c_str());
+      raise(Divergence::OUTPUT_MISMATCH, device.ms, pendingSince, detail);
+   }
+   else
+   {
+      snprintf(detail, sizeof(detail), "mode flags 0x%02x on the device, 0x%02x on the twin",
+               device.flags, mine.flags);
+      raise(Divergence::MODE_MISMATCH, device.ms, pendingSince, detail);
+   }
+
+   // The twin cannot follow a device it disagrees with; rejoin at the next sync point
+   desync();
+}
+
+void TwinVerifier::checkClock(const TelemetrySample& sample, double hostMs)
+{
+   if (hostMs < 0)
+      return;
+
+   // Arrival latency only ever adds to the offset, so each second's minimum tracks the clocks
+   const double offset = hostMs - sample.ms;
+   windowOffset        = std::min(windowOffset, offset);
+   if (sample.ms - windowStart < 1000)
+      return;
+
+   if (!baseSet)
+   {
+      baseOffset = windowOffset;
+      baseSet    = true;
+   }
+   else
+   {
+      const uint32_t elapsed = sample.ms - syncMs;
+      driftPpm               = (windowOffset - baseOffset) / elapsed * 1e6;
+      if (options.maxDriftPpm > 0 && !driftRaised && elapsed >= 10000 &&
+          std::fabs(driftPpm) > options.maxDriftPpm)
+      {
+         char detail[96];
+         snprintf(detail, sizeof(detail), "device clock runs %s by %.0f ppm against the host",
+                  driftPpm > 0 ? "slow" : "fast", std::fabs(driftPpm));
+         raise(Divergence::TIMING_DRIFT, sample.ms, syncMs, detail);
+         driftRaised = true;
+      }
+   }
+   windowStart  = sample.ms;
+   windowOffset = offset;
+}
+
+void TwinVerifier::raise(Divergence::Kind kind, uint32_t now, uint32_t since,
+                         const std::string& detail)
+{
+   divergences.push_back({kind, now, since, detail});
+}
@@ -0,0 +1,150 @@
+#ifndef TWIN_VERIFIER_H
+#define TWIN_VERIFIER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "RocketController.h"
+#include "SimArduinoInterface.h"
+#include "Telemetry.h"
+
+// Where the device and its twin disagreed
+struct Divergence
+{
+   enum Kind : uint8_t
+   {
+      STUCK_RELAY,           // device relay closed, twin's open
+      RELAY_NOT_CLOSED,      // twin fired, device did not
+      MISSED_TRANSITION,     // twin changed state, device stayed
+      UNEXPECTED_TRANSITION, // device changed state, twin stayed
+      STATE_MISMATCH,        // both moved, to different states
+      OUTPUT_MISMATCH,       // LEDs, lamp or aux channels
+      MODE_MISMATCH,         // range / static-fire flags
+      TIMING_DRIFT           // device clock runs off the host clock
+   };
+
+   Kind        kind;
+   uint32_t    deviceMs; // device time the divergence was flagged
+   uint32_t    sinceMs;  // device time the two first disagreed
+   std::string detail;
+};
+
+const char* divergenceName(Divergence::Kind kind);
+bool        parseDivergenceName(const char* text, Divergence::Kind& out);
+
+// Runs RocketController in lockstep with a device's telemetry stream
+//
+// Every sample carries the inputs the device acted on, so the twin is stepped
+// one millisecond at a time up to the sample's timestamp, fed those inputs, and
+// its outputs, state and mode compared with what the device reported. The two
+// may disagree for up to toleranceMs (the device skips milliseconds while its
+// loop is busy); a disagreement older than that is a divergence, raised on the
+// first sample past the tolerance. Heartbeats bound that to one telemetry
+// period.
+//
+// The twin joins at SPLASH or READY, the only states whose behaviour does not
+// depend on history, and rejoins there after a divergence, a device reset or
+// lost telemetry.
+class TwinVerifier
+{
+ public:
+   struct Options
+   {
+      uint32_t                           toleranceMs  = 10;
+      std::vector<AuxScheduler::Channel> auxChannels; // as configured on the device
+      bool                               checkAux     = true;
+      double                             maxDriftPpm  = 0; // 0 = clock not checked
+      uint16_t                           relayPulseMs = RocketController::RELAY_ON_MS;
+   };
+
+   explicit TwinVerifier(const Options& options);
+   ~TwinVerifier();
+
+   // Check one sample; hostMs is its arrival time on the host clock (negative if unknown)
+   void onSample(const TelemetrySample& sample, double hostMs = -1);
+
+   bool isSynced() const
+   {
+      return synced;
+   }
+
+   const std::vector<Divergence>& getDivergences() const
+   {
+      return divergences;
+   }
+
+   // Statistics
+   uint64_t getSamples() const
+   {
+      return samples;
+   }
+
+   uint64_t getTwinTicks() const
+   {
+      return twinTicks;
+   }
+
+   uint32_t getResyncs() const
+   {
+      return resyncs;
+   }
+
+   uint32_t getLostSamples() const
+   {
+      return lostSamples;
+   }
+
+   uint32_t getMaxLagMs() const
+   {
+      return maxLagMs;
+   }
+
+   double getDriftPpm() const
+   {
+      return driftPpm;
+   }
+
+ private:
+   // Longer silences mean a reset or a garbled stream: rejoin rather than replay
+   static constexpr uint32_t MAX_GAP_MS = 60000;
+
+   Options                              options;
+   std::unique_ptr<SimArduinoInterface> hal;
+   std::unique_ptr<RocketController>    twin;
+   std::vector<Divergence>              divergences;
+
+   bool                                 synced       = false;
+   bool                                 seenAny      = false;
+   uint16_t                             nextSeq      = 0;
+   uint32_t                             lastMs       = 0;
+   uint8_t                              agreedState  = 0; // at the last sample both agreed on
+   bool                                 pending      = false; // currently disagreeing
+   uint32_t                             pendingSince = 0;
+
+   // Clock check: smallest host-minus-device offset in the first and the latest second
+   uint32_t                             syncMs       = 0;
+   uint32_t                             windowStart  = 0;
+   double                               windowOffset = 0;
+   double                               baseOffset   = 0;
+   bool                                 baseSet      = false;
+   bool                                 driftRaised  = false;
+
+   uint64_t                             samples      = 0;
+   uint64_t                             twinTicks    = 0;
+   uint32_t                             resyncs      = 0;
+   uint32_t                             lostSamples  = 0;
+   uint32_t                             maxLagMs     = 0;
+   double                               driftPpm     = 0;
+
+   void                                 sync(const TelemetrySample& sample, double hostMs);
+   void                                 desync();
+   void                                 tick(uint32_t t);
+   void                                 stepTo(const TelemetrySample& sample);
+   void                                 compare(const TelemetrySample& device);
+   void                                 checkClock(const TelemetrySample& sample, double hostMs);
+   void                                 raise(Divergence::Kind kind, uint32_t now, uint32_t since,
+                                              const std::string& detail);
+};
+
+#endif // TWIN_VERIFIER_H
@@ -0,0 +1,92 @@
+#include "AdaptiveDebouncer.h"
+
+void AdaptiveDebouncer::begin(bool level, uint32_t now, uint8_t holdMs)
+{
+   hold       = holdMs > MAX_WINDOW_MS ? MAX_WINDOW_MS : holdMs;
+   changedAt  = now - hold; // the starting level is not held
+   stable     = level;
+   raw        = level;
+   inEpisode  = false;
+   committed  = false;
+   lastEdgeAt = now;
+}
+
+bool AdaptiveDebouncer::update(bool rawLevel, uint32_t now)
+{
+   if (rawLevel != raw)
+   {
+      raw = rawLevel;
+      if (!inEpisode)
+      {
+         inEpisode    = true;
+         episodeStart = now;
+      }
+      else if (committed)
+      {
+         // Contact kept bouncing after the level was accepted: widen right away
+         const uint32_t bounce = now - episodeStart;
+         if (bounce + MARGIN_MS > window)
+            setWindowFor(bounce);
+      }
+      lastEdgeAt = now;
+   }
+
+   bool changed = false;
+   if (raw != stable && now - lastEdgeAt >= window && now - changedAt >= hold)
+   {
+      stable    = raw;
+      changedAt = now;
+      committed = true;
+      changed   = true;
+   }
+
+   // The episode is over once the contact has been quiet for the longest window
+   if (inEpisode && now - lastEdgeAt >= MAX_WINDOW_MS)
+   {
+      inEpisode = false;
+      committed = false;
+      recordEpisode(lastEdgeAt - episodeStart);
+   }
+
+   return changed;
+}
+
+void AdaptiveDebouncer::recordEpisode(uint32_t duration)
+{
+   history[historyIdx] = duration > 255 ? 255 : (uint8_t)duration;
+   historyIdx         = (historyIdx + 1) % HISTORY_LEN;
+   if (episodes < 255)
+      episodes++;
+
+   // Second-largest of the recent episodes (~94th percentile of 16): a single
+   // outlier does not stretch the window, a recurring long bounce does
+   const uint8_t n      = episodes < HISTORY_LEN ? episodes : HISTORY_LEN;
+   uint8_t       first  = 0;
+   uint8_t       second = 0;
+   for (uint8_t i = 0; i < n; i++)
+   {
+      if (history[i] > first)
+      {
+         second = first;
+         first  = history[i];
+      }
+      else if (history[i] > second)
+      {
+         second = history[i];
+      }
+   }
+   percentile = second;
+
+   if (learned())
+      setWindowFor(percentile);
+}
+
+void AdaptiveDebouncer::setWindowFor(uint32_t bounce)
+{
+   uint32_t w = bounce + MARGIN_MS;
+   if (w < MIN_WINDOW_MS)
+      w = MIN_WINDOW_MS;
+   if (w > MAX_WINDOW_MS)
+      w = MAX_WINDOW_MS;
+   window = (uint8_t)w;
+}
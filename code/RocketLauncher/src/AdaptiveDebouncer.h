@@ -0,0 +1,81 @@
+#ifndef ADAPTIVE_DEBOUNCER_H
+#define ADAPTIVE_DEBOUNCER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Switch debouncer that learns how long each contact actually bounces
+//
+// Every run of raw edges is timed from the first edge to the last one (a bounce
+// episode). The settle window is set just above a high percentile of recent
+// episodes, so a clean switch reacts in a couple of milliseconds while a worn one
+// gets a longer window and is reported as needing maintenance. A switch that
+// starts to wear can bounce for longer than anything seen so far, and on ARM or
+// LAUNCH one stray edge during the countdown is a fault, so those are given a
+// hold in begin(): an accepted level is kept for INTERLOCK_HOLD_MS before it can
+// change back. A press is still reported after the short learned window, and a
+// release inside the hold is reported when the hold ends, not lost.
+class AdaptiveDebouncer
+{
+ public:
+   static constexpr uint8_t MIN_WINDOW_MS     = 2;
+   static constexpr uint8_t MAX_WINDOW_MS     = 20;
+   static constexpr uint8_t DEFAULT_WINDOW_MS = 10;
+   static constexpr uint8_t INTERLOCK_HOLD_MS = 10;
+   static constexpr uint8_t MARGIN_MS         = 2;
+   static constexpr uint8_t WORN_BOUNCE_MS    = 8;
+   static constexpr uint8_t HISTORY_LEN       = 16;
+   static constexpr uint8_t LEARN_EPISODES    = 4;
+
+   // Start from a known level (no edge is reported for it); holdMs as described above
+   void    begin(bool level, uint32_t now, uint8_t holdMs = 0);
+
+   // Feed the raw pin level; returns true when the debounced level changed
+   bool    update(bool rawLevel, uint32_t now);
+
+   bool read() const
+   {
+      return stable;
+   }
+
+   uint8_t windowMs() const
+   {
+      return window;
+   }
+
+   // Bounce duration at the tracked percentile (0 until enough episodes were seen)
+   uint8_t bounceMs() const
+   {
+      return learned() ? percentile : 0;
+   }
+
+   bool isWorn() const
+   {
+      return learned() && percentile > WORN_BOUNCE_MS;
+   }
+
+ private:
+   bool     stable       = true;
+   bool     raw          = true;
+   bool     inEpisode    = false;
+   bool     committed    = false;
+   uint32_t episodeStart = 0;
+   uint32_t lastEdgeAt   = 0;
+   uint32_t changedAt    = 0; // last accepted change
+   uint8_t  window       = DEFAULT_WINDOW_MS;
+   uint8_t  hold         = 0;
+   uint8_t  percentile   = 0;
+   uint8_t  episodes     = 0;
+   uint8_t  historyIdx   = 0;
+   uint8_t  history[HISTORY_LEN] = {0};
+
+   bool learned() const
+   {
+      return episodes >= LEARN_EPISODES;
+   }
+
+   void recordEpisode(uint32_t duration);
+   void setWindowFor(uint32_t bounce);
+};
+
+#endif // ADAPTIVE_DEBOUNCER_H
@@ -3,6 +3,11 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "ToneTimer.h"
+
+class AuxScheduler;
+class LoadCellCapture;
+class RawCapture;
 
 #if defined(ARDUINO) && ARDUINO >= 100
 #include <Arduino.h>
@@ -20,9 +25,13 @@ typedef bool boolean;
 
 // Arduino classes (forward declarations)
 class LiquidCrystal;
-class Bounce;
 #endif
 
+// Input channel bits used in input masks
+static constexpr uint8_t INPUT_BIT_ARM    = 0x01;
+static constexpr uint8_t INPUT_BIT_RESET  = 0x02;
+static constexpr uint8_t INPUT_BIT_LAUNCH = 0x04;
+
 // Hardware abstraction interface
 class ArduinoInterface
 {
@@ -34,6 +43,13 @@ class ArduinoInterface
    virtual uint8_t  digitalRead(uint8_t pin) const                      = 0;
    virtual void     pinMode(uint8_t pin, uint8_t mode)                  = 0;
 
+   // Relay coil; boards with a hold drive pull in at full voltage and then hold on a PWM
+   // duty, and must still read the pin back as the commanded level
+   virtual void     relayWrite(uint8_t pin, bool on)
+   {
+      digitalWrite(pin, on ? HIGH : LOW);
+   }
+
    // Time functions
    virtual uint32_t millis() const                                      = 0;
    virtual void     delay(uint32_t ms)                                  = 0;
@@ -43,6 +59,14 @@ class ArduinoInterface
    virtual void     tone(uint8_t pin, uint16_t freq, uint32_t duration) = 0;
    virtual void     noTone(uint8_t pin)                                 = 0;
 
+   // Start a note from a precomputed divisor; backends without a register-level
+   // tone generator fall back to tone()
+   virtual void     toneTimer(uint8_t pin, uint16_t freq, ToneTimer timer)
+   {
+      (void)timer;
+      tone(pin, freq);
+   }
+
    // LCD functions
    virtual void     lcdClear()                                          = 0;
    virtual void     lcdSetCursor(uint8_t col, uint8_t row)              = 0;
@@ -54,6 +78,92 @@ class ArduinoInterface
    virtual bool     isArmPressed() const                                = 0;
    virtual bool     isResetPressed() const                              = 0;
    virtual bool     isLaunchPressed() const                             = 0;
+
+   // Inputs whose contacts bounce badly enough to need service (INPUT_BIT_* mask)
+   virtual uint8_t  wornInputMask() const
+   {
+      return 0;
+   }
+
+   // Service the aux channels from a timer interrupt; false means the controller polls them
+   virtual bool     attachAuxTimer(AuxScheduler* aux)
+   {
+      (void)aux;
+      return false;
+   }
+
+   // Keep that interrupt out while the schedule is being changed
+   virtual void     beginAtomic()
+   {
+   }
+
+   virtual void     endAtomic()
+   {
+   }
+
+   // Load-cell acquisition into capture from the timer tick; returns the sample rate (0 = none)
+   virtual uint16_t startLoadCell(LoadCellCapture* capture)
+   {
+      (void)capture;
+      return 0;
+   }
+
+   virtual void     stopLoadCell()
+   {
+   }
+
+   // Raw input levels sampled into capture from the timer tick; returns the sample rate
+   virtual uint16_t startRawCapture(RawCapture* capture)
+   {
+      (void)capture;
+      return 0;
+   }
+
+   virtual void     stopRawCapture()
+   {
+   }
+
+   // Binary serial output: free transmit buffer space, and a write that must fit in it
+   virtual uint16_t serialWritable() const
+   {
+      return 0;
+   }
+
+   virtual void     serialWrite(const uint8_t* data, uint16_t len)
+   {
+      (void)data;
+      (void)len;
+   }
+
+   // Non-volatile storage: queue bytes without waiting for them to be programmed;
+   // false if there is no room (or no storage), in which case nothing was queued
+   virtual bool     persist(uint16_t addr, const uint8_t* data, uint8_t len)
+   {
+      (void)addr;
+      (void)data;
+      (void)len;
+      return false;
+   }
+
+   // Read back what has been programmed; false if there is no storage
+   virtual bool     recall(uint16_t addr, uint8_t* data, uint8_t len) const
+   {
+      (void)addr;
+      (void)data;
+      (void)len;
+      return false;
+   }
+
+   // Everything queued has been programmed
+   virtual bool     persistIdle() const
+   {
+      return true;
+   }
+
+   // Wait for persistIdle(); for shutdown and tests only, never from the update path
+   virtual void     persistFlush()
+   {
+   }
 };
 
 // Note: RealArduinoInterface is implemented in main.cpp
@@ -0,0 +1,87 @@
+#include "AuxScheduler.h"
+#include "ArduinoInterface.h"
+
+bool AuxScheduler::addChannel(uint8_t pin, int16_t offsetMs, uint16_t pulseMs)
+{
+   if (config.count >= MAX_CHANNELS || pulseMs == 0)
+      return false;
+   io->beginAtomic();
+   config.channels[config.count++] = {pin, offsetMs, pulseMs};
+   io->endAtomic();
+   return true;
+}
+
+void AuxScheduler::write(uint8_t pin, bool high)
+{
+   if (pinWrite)
+      pinWrite(pin, high);
+   else
+      io->digitalWrite(pin, high ? HIGH : LOW);
+}
+
+void AuxScheduler::schedule(uint8_t i, uint32_t t0)
+{
+   onAt[i]  = t0 + (int32_t)config.channels[i].offsetMs;
+   phase[i] = PENDING;
+}
+
+void AuxScheduler::arm(uint32_t predictedT0)
+{
+   io->beginAtomic();
+   busy = 0;
+   for (uint8_t i = 0; i < config.count; i++)
+   {
+      if (config.channels[i].offsetMs < 0)
+         schedule(i, predictedT0);
+      else
+         phase[i] = WAIT_T0;
+      busy++;
+   }
+   io->endAtomic();
+}
+
+void AuxScheduler::ignite(uint32_t t0)
+{
+   io->beginAtomic();
+   for (uint8_t i = 0; i < config.count; i++)
+   {
+      if (phase[i] == WAIT_T0)
+         schedule(i, t0);
+   }
+   service(t0); // T+0 goes out together with the relay
+   io->endAtomic();
+}
+
+void AuxScheduler::cancel()
+{
+   io->beginAtomic();
+   for (uint8_t i = 0; i < config.count; i++)
+   {
+      phase[i] = IDLE;
+      write(config.channels[i].pin, false);
+   }
+   busy = 0;
+   io->endAtomic();
+}
+
+void AuxScheduler::service(uint32_t now)
+{
+   if (!busy)
+      return;
+
+   for (uint8_t i = 0; i < config.count; i++)
+   {
+      if (phase[i] == PENDING && (int32_t)(now - onAt[i]) >= 0)
+      {
+         write(config.channels[i].pin, true);
+         offAt[i] = now + config.channels[i].pulseMs; // full width even if switched on late
+         phase[i] = ACTIVE;
+      }
+      if (phase[i] == ACTIVE && (int32_t)(now - offAt[i]) >= 0)
+      {
+         write(config.channels[i].pin, false);
+         phase[i] = IDLE;
+         busy--;
+      }
+   }
+}
@@ -0,0 +1,94 @@
+#ifndef AUX_SCHEDULER_H
+#define AUX_SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+class ArduinoInterface;
+
+// Auxiliary outputs (camera shutter, strobe) pulsed at fixed offsets from ignition
+//
+// Channels are armed when the countdown starts, with T0 predicted from the same
+// millis() timebase the countdown uses, so negative offsets fire ahead of the
+// relay. Channels at T+0 and later wait for the actual LAUNCHING entry and are
+// rebased onto it. service() only compares timestamps and flips pins, so it can
+// run from a timer compare interrupt; otherwise the controller polls it. A board that
+// runs it from an interrupt also hands over a plain pin writer, so no decorator
+// wrapped around the interface (call counters, queues) is entered from the ISR.
+class AuxScheduler
+{
+ public:
+   static constexpr uint8_t MAX_CHANNELS = 4;
+
+   typedef void (*PinWrite)(uint8_t pin, bool high);
+
+   struct Channel
+   {
+      uint8_t  pin;
+      int16_t  offsetMs; // relative to ignition, negative = before
+      uint16_t pulseMs;
+   };
+
+   // Static channel table (scrubbed with the rest of the controller config)
+   struct Config
+   {
+      Channel channels[MAX_CHANNELS];
+      uint8_t count;
+   };
+
+   explicit AuxScheduler(ArduinoInterface* io) : io(io), config{}
+   {
+   }
+
+   // Write the aux pins through this instead of the interface (before the timer starts)
+   void    setPinWrite(PinWrite write)
+   {
+      pinWrite = write;
+   }
+
+   bool    addChannel(uint8_t pin, int16_t offsetMs, uint16_t pulseMs);
+
+   // Countdown started: schedule pre-ignition channels against the predicted T0
+   void    arm(uint32_t predictedT0);
+
+   // Relay just closed: schedule T+0 and later channels from the real ignition time
+   void    ignite(uint32_t t0);
+
+   // Drop everything and force all aux outputs low
+   void    cancel();
+
+   // Switch pins whose time has come (safe to call from an ISR)
+   void    service(uint32_t now);
+
+   const Config& getConfig() const
+   {
+      return config;
+   }
+
+   bool isBusy() const
+   {
+      return busy != 0;
+   }
+
+ private:
+   enum Phase : uint8_t
+   {
+      IDLE,
+      WAIT_T0, // offset >= 0, waiting for ignite()
+      PENDING, // scheduled, pin low
+      ACTIVE   // pin high until offAt
+   };
+
+   ArduinoInterface* io;
+   PinWrite          pinWrite = nullptr;
+   Config            config;
+   volatile uint8_t  phase[MAX_CHANNELS] = {};
+   volatile uint8_t  busy                = 0; // channels not IDLE
+   uint32_t          onAt[MAX_CHANNELS]  = {};
+   uint32_t          offAt[MAX_CHANNELS] = {};
+
+   void              schedule(uint8_t i, uint32_t t0);
+   void              write(uint8_t pin, bool high);
+};
+
+#endif // AUX_SCHEDULER_H
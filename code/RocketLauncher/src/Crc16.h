@@ -0,0 +1,22 @@
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <stdint.h>
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), bitwise so it needs no table in RAM
+static inline uint16_t crc16Update(uint16_t crc, uint8_t data)
+{
+   crc ^= (uint16_t)data << 8;
+   for (uint8_t i = 0; i < 8; i++)
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+   return crc;
+}
+
+static inline uint16_t crc16(const uint8_t* data, uint16_t len, uint16_t crc = 0xFFFF)
+{
+   while (len--)
+      crc = crc16Update(crc, *data++);
+   return crc;
+}
+
+#endif // CRC16_H
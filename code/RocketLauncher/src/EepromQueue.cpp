@@ -0,0 +1,50 @@
+#include "EepromQueue.h"
+
+int16_t EepromQueue::find(uint16_t addr) const
+{
+   for (uint8_t i = 0, at = tail; i < fill; i++, at = (uint8_t)((at + 1) % CAPACITY))
+   {
+      if (ring[at].addr == addr)
+         return at;
+   }
+   return -1;
+}
+
+bool EepromQueue::write(uint16_t addr, const uint8_t* data, uint8_t len)
+{
+   // Count what needs a new slot before touching anything
+   uint8_t needed = 0;
+   for (uint8_t i = 0; i < len; i++)
+   {
+      if (find((uint16_t)(addr + i)) < 0)
+         needed++;
+   }
+   if (needed > CAPACITY - fill)
+      return false;
+
+   for (uint8_t i = 0; i < len; i++)
+   {
+      const int16_t at = find((uint16_t)(addr + i));
+      if (at >= 0)
+      {
+         ring[at].value = data[i];
+         merges++;
+         continue;
+      }
+      ring[head] = {(uint16_t)(addr + i), data[i]};
+      head       = (uint8_t)((head + 1) % CAPACITY);
+      fill       = (uint8_t)(fill + 1);
+   }
+   return true;
+}
+
+bool EepromQueue::pop(uint16_t& addr, uint8_t& value)
+{
+   if (fill == 0)
+      return false;
+   addr  = ring[tail].addr;
+   value = ring[tail].value;
+   tail  = (uint8_t)((tail + 1) % CAPACITY);
+   fill  = (uint8_t)(fill - 1);
+   return true;
+}
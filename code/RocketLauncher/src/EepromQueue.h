@@ -0,0 +1,104 @@
+#ifndef EEPROM_QUEUE_H
+#define EEPROM_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Queue depth in bytes (3 bytes of RAM each)
+#ifndef EEPROM_QUEUE_ENTRIES
+#if defined(__AVR__)
+#define EEPROM_QUEUE_ENTRIES 16
+#else
+#define EEPROM_QUEUE_ENTRIES 64
+#endif
+#endif
+
+// EEPROM writes held in RAM until the hardware can take them
+//
+// The main loop queues whole records with write() and returns at once; the
+// EEPROM-ready interrupt (or whatever programs the memory in the background)
+// takes one byte at a time with pop() and reports bytes it found already
+// holding the value with skipped(), so an unchanged byte costs no write time
+// and no wear. A byte queued again before it was programmed just takes the
+// new value. The loop side must keep the drain interrupt out while it calls
+// write() (ArduinoInterface::beginAtomic).
+class EepromQueue
+{
+ public:
+   static constexpr uint8_t CAPACITY = EEPROM_QUEUE_ENTRIES;
+
+   // All of data or nothing; false if it does not fit
+   bool     write(uint16_t addr, const uint8_t* data, uint8_t len);
+
+   // Drain side: the next byte to program, false when empty
+   bool     pop(uint16_t& addr, uint8_t& value);
+
+   // Drain side bookkeeping: the popped byte already held its value, went to the
+   // hardware, or finished programming (the queue is idle once nothing is left)
+   void skipped()
+   {
+      skips++;
+   }
+
+   void started()
+   {
+      busy = true;
+   }
+
+   void programmed()
+   {
+      writes++;
+      busy = false;
+   }
+
+   bool isProgramming() const
+   {
+      return busy;
+   }
+
+   bool isIdle() const
+   {
+      return fill == 0 && !busy;
+   }
+
+   uint8_t pending() const
+   {
+      return fill;
+   }
+
+   uint32_t getWrites() const
+   {
+      return writes;
+   }
+
+   uint32_t getSkips() const
+   {
+      return skips;
+   }
+
+   // Writes that coalesced into a byte already queued
+   uint32_t getMerges() const
+   {
+      return merges;
+   }
+
+ private:
+   struct Entry
+   {
+      uint16_t addr;
+      uint8_t  value;
+   };
+
+   Entry             ring[CAPACITY];
+   volatile uint8_t  head   = 0;
+   volatile uint8_t  tail   = 0;
+   volatile uint8_t  fill   = 0;
+   volatile bool     busy   = false;
+   volatile uint32_t writes = 0;
+   volatile uint32_t skips  = 0;
+   uint32_t          merges = 0;
+
+   int16_t           find(uint16_t addr) const;
+};
+
+#endif // EEPROM_QUEUE_H
@@ -0,0 +1,185 @@
+#include "FastLcd.h"
+#include <string.h>
+
+// HD44780 commands and execution times, in fast ticks beyond the next one
+static constexpr uint8_t  CMD_CLEAR         = 0x01;
+static constexpr uint8_t  CMD_ENTRY_LEFT    = 0x06;
+static constexpr uint8_t  CMD_DISPLAY_ON    = 0x0C;
+static constexpr uint8_t  CMD_FUNCTION_4BIT = 0x28; // 4-bit, 2 lines, 5x8 font
+static constexpr uint8_t  CMD_SET_DDRAM     = 0x80;
+static constexpr uint8_t  CLEAR_TICKS       = 15;  // 1.52 ms
+static constexpr uint8_t  RESET_TICKS       = 41;  // 4.1 ms after the first 0x3
+static constexpr uint16_t POWER_ON_TICKS    = 500; // 50 ms for Vcc to settle
+
+void FastLcd::begin(uint8_t cols, uint8_t rows)
+{
+   this->cols = cols;
+   waitTicks  = POWER_ON_TICKS;
+
+   // Healing covers the first 16 columns of two lines; narrower displays are left alone
+   cells = cols >= COLS ? (uint8_t)((rows < ROWS ? rows : ROWS) * COLS) : 0;
+
+   // Datasheet figure 24: three 8-bit function sets, then switch to 4-bit
+   put(0x30, NIBBLE | RESET_TICKS);
+   put(0x30, NIBBLE | 1);
+   put(0x30, NIBBLE);
+   put(0x20, NIBBLE);
+   put(CMD_FUNCTION_4BIT, 0);
+   put(CMD_DISPLAY_ON, 0);
+   clear();
+   put(CMD_ENTRY_LEFT, 0);
+}
+
+void FastLcd::clear()
+{
+   put(CMD_CLEAR, CLEAR_TICKS);
+}
+
+void FastLcd::setCursor(uint8_t col, uint8_t row)
+{
+   const uint8_t rowStart[4] = {0x00, 0x40, cols, (uint8_t)(0x40 + cols)};
+   put((uint8_t)(CMD_SET_DDRAM | (rowStart[row & 3] + col)), 0);
+}
+
+void FastLcd::print(const char* text)
+{
+   while (*text)
+      put((uint8_t)*text++, RS);
+}
+
+void FastLcd::print(int number)
+{
+   char       digits[12];
+   char*      p         = digits + sizeof(digits);
+   const bool negative  = number < 0;
+   unsigned   magnitude = negative ? 0u - (unsigned)number : (unsigned)number;
+   *--p                 = '\0';
+   do
+   {
+      *--p = (char)('0' + magnitude % 10);
+      magnitude /= 10;
+   } while (magnitude);
+   if (negative)
+      *--p = '-';
+   print(p);
+}
+
+void FastLcd::put(uint8_t value, uint8_t flags)
+{
+   const uint8_t next = head;
+   while ((uint8_t)(next - tail) >= CAPACITY)
+   {
+      // Full: the tick frees a slot at least every 1.6 ms
+   }
+   queue[next & (CAPACITY - 1)] = {value, flags};
+   head                         = (uint8_t)(next + 1);
+}
+
+void FastLcd::service()
+{
+   if (healWait)
+      healWait = (uint16_t)(healWait - 1);
+   if (waitTicks)
+   {
+      waitTicks = (uint16_t)(waitTicks - 1);
+      return;
+   }
+
+   // A healing pass, once started, finishes before the queue moves on
+   Entry         e;
+   const uint8_t at = tail;
+   if (healStep == 0 && at != head)
+   {
+      e = queue[at & (CAPACITY - 1)];
+      track(e);
+      tail = (uint8_t)(at + 1);
+   }
+   else if (!nextHeal(e))
+      return;
+   send(e);
+}
+
+void FastLcd::send(const Entry& e)
+{
+   const bool rs = (e.flags & RS) != 0;
+   writer(e.value >> 4, rs);
+   if (!(e.flags & NIBBLE))
+      writer(e.value & 0x0F, rs);
+   waitTicks = e.flags & WAIT;
+}
+
+// Follow the caller's bytes into the shadow; the display has two lines, 0x00-0x27 and 0x40-0x67
+void FastLcd::track(const Entry& e)
+{
+   if (e.flags & RS)
+   {
+      const uint8_t col = addr & 0x3F;
+      if (col < COLS)
+         shadow[(addr & 0x40) ? 1 : 0][col] = (char)e.value;
+      addr = addr == 0x27 ? 0x40 : addr == 0x67 ? 0x00 : (uint8_t)(addr + 1);
+   }
+   else if (e.flags & NIBBLE)
+      return;
+   else if (e.value & CMD_SET_DDRAM)
+      addr = e.value & 0x7F;
+   else if (e.value == CMD_CLEAR)
+   {
+      memset(shadow, ' ', sizeof(shadow));
+      addr = 0;
+   }
+}
+
+// Next byte of a healing pass: the sync sequence when a round starts, the cursor to the
+// pass's first cell, its characters, and the cursor back
+bool FastLcd::nextHeal(Entry& e)
+{
+   static const Entry SYNC[RESYNC] = {{0x30, NIBBLE | RESET_TICKS}, {0x30, NIBBLE | 1},
+                                      {0x30, NIBBLE},               {0x20, NIBBLE},
+                                      {CMD_FUNCTION_4BIT, 0},       {CMD_DISPLAY_ON, 0},
+                                      {CMD_ENTRY_LEFT, 0}};
+   if (healStep == 0)
+   {
+      if (healRequested)
+      {
+         healRequested = false;
+         healCell      = 0;
+         resyncDue     = true;
+         healWait      = SETTLE_TICKS;
+         return false;
+      }
+      if (cells == 0 || healWait)
+         return false;
+      healStep  = resyncDue ? 1 : RESYNC + 1;
+      resyncDue = false;
+   }
+
+   const uint8_t step = healStep;
+   healStep           = (uint8_t)(step + 1);
+   if (step <= RESYNC)
+   {
+      if (step == 1)
+         resyncCount++;
+      e = SYNC[step - 1];
+      return true;
+   }
+   const uint8_t row  = healCell / COLS;
+   const uint8_t col  = healCell % COLS;
+   const uint8_t byte = (uint8_t)(step - RESYNC - 1);
+   if (byte == 0)
+      e = {(uint8_t)(CMD_SET_DDRAM | (row ? 0x40 : 0x00) | col), 0};
+   else if (byte <= HEAL_CELLS)
+      e = {(uint8_t)shadow[row][col + byte - 1], RS};
+   else
+   {
+      e        = {(uint8_t)(CMD_SET_DDRAM | addr), 0};
+      healStep = 0;
+      healCell = (uint8_t)(healCell + HEAL_CELLS);
+      if (healCell >= cells)
+      {
+         healCell  = 0;
+         resyncDue = true;
+      }
+      healWait = PASS_TICKS;
+   }
+   return true;
+}
@@ -0,0 +1,118 @@
+#ifndef FAST_LCD_H
+#define FAST_LCD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Queue depth in bytes sent to the LCD (2 bytes of RAM each); a full two-line
+// redraw is a clear, two cursor moves and 32 characters
+#ifndef FAST_LCD_QUEUE
+#define FAST_LCD_QUEUE 64
+#endif
+
+// HD44780 in 4-bit mode, written from a timer tick instead of by the caller
+//
+// The print calls only queue bytes and return. service(), called from a
+// periodic tick of at least 37 us (the 10 kHz fast tick), sends one queued
+// byte per call as two nibbles through the board's NibbleWriter, then sits
+// out as many ticks as the byte needs (a clear takes 1.52 ms). R/W is tied
+// low, so the busy flag cannot be read and every wait is timed this way. If
+// the queue is full the caller waits for the tick to make room.
+//
+// The display is also kept healed in the background: noise from the relay
+// can knock a 4-bit HD44780 out of nibble sync or drop stray characters on
+// it, and nothing would redraw it until the next state change. service()
+// keeps a copy of every character it sends to the 16x2 screen, and whenever
+// the queue is empty it rewrites HEAL_CELLS of them from that copy every
+// PASS_TICKS, round-robin, then puts the cursor back where the caller's
+// bytes left it. Each round of the screen (200 ms) starts by resending the
+// 4-bit sync sequence, which brings the controller back in step whatever
+// half of a byte it was waiting for, without clearing it. heal() restarts
+// the round from the first cell, sync included, SETTLE_TICKS later; the
+// board calls it on every relay transition. A pass is at most 13 bytes and
+// only starts with the queue empty, so it never holds the caller up.
+class FastLcd
+{
+ public:
+   // Put nibble (bits 0-3) on D4-D7 with RS and pulse E; called from service()
+   typedef void (*NibbleWriter)(uint8_t nibble, bool rs);
+
+   static constexpr uint16_t TICK_US  = 100;
+   static constexpr uint8_t  CAPACITY = FAST_LCD_QUEUE;
+   static_assert((CAPACITY & (CAPACITY - 1)) == 0, "queue size must be a power of two");
+
+   static constexpr uint8_t  HEAL_CELLS   = 4;   // cells rewritten per pass
+   static constexpr uint16_t PASS_TICKS   = 250; // 25 ms between passes: 8 passes a round
+   static constexpr uint16_t SETTLE_TICKS = 200; // 20 ms after heal() for the contacts to settle
+
+   explicit FastLcd(NibbleWriter writer) : writer(writer)
+   {
+   }
+
+   // Power-on wait and 4-bit initialisation, all queued
+   void begin(uint8_t cols, uint8_t rows);
+   void clear();
+   void setCursor(uint8_t col, uint8_t row);
+   void print(const char* text);
+   void print(int number);
+
+   // Resync and rewrite the whole screen soon; safe from any context, interrupts included
+   void heal()
+   {
+      healRequested = true;
+   }
+
+   // One tick: send the next byte once the previous one has had its time
+   void service();
+
+   bool idle() const
+   {
+      return head == tail && waitTicks == 0 && healStep == 0;
+   }
+
+   // Resyncs sent so far, one per round
+   uint16_t resyncs() const
+   {
+      return resyncCount;
+   }
+
+ private:
+   static constexpr uint8_t RS     = 0x80; // data, not a command
+   static constexpr uint8_t NIBBLE = 0x40; // high nibble only (8-bit mode during init)
+   static constexpr uint8_t WAIT   = 0x3F; // ticks to sit out afterwards
+   static constexpr uint8_t ROWS   = 2;
+   static constexpr uint8_t COLS   = 16;
+   static constexpr uint8_t RESYNC = 7; // bytes in the sync sequence
+   static_assert(COLS % HEAL_CELLS == 0, "a pass must not run off the end of a line");
+
+   struct Entry
+   {
+      uint8_t value;
+      uint8_t flags;
+   };
+
+   NibbleWriter      writer;
+   Entry             queue[CAPACITY];
+   volatile uint8_t  head      = 0; // written by the caller only
+   volatile uint8_t  tail      = 0; // written by service() only
+   volatile uint16_t waitTicks = 0;
+   uint8_t           cols      = 16;
+
+   // Healing, all owned by service() but the request flag
+   char              shadow[ROWS][COLS]; // as last sent, from the first clear on
+   uint8_t           addr          = 0;  // DDRAM address the caller's bytes left the cursor at
+   uint8_t           cells         = 0;  // screen cells to heal, 0 before begin()
+   volatile bool     healRequested = false;
+   bool              resyncDue     = true;
+   uint16_t          healWait      = PASS_TICKS;
+   uint8_t           healCell      = 0;
+   volatile uint8_t  healStep      = 0; // next byte of the pass in progress, 0 = none
+   uint16_t          resyncCount   = 0;
+
+   void              put(uint8_t value, uint8_t flags);
+   void              send(const Entry& e);
+   void              track(const Entry& e);
+   bool              nextHeal(Entry& e);
+};
+
+#endif // FAST_LCD_H
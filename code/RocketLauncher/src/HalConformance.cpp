@@ -0,0 +1,328 @@
+#include "HalConformance.h"
+#include <stdio.h>
+#include <string.h>
+
+static constexpr uint8_t  DELAY_MS = 5;
+static constexpr uint8_t  ROW_MAX  = 20; // widest HD44780 row
+static volatile uint8_t   readSink;      // keeps timed reads from being optimised away
+
+HalConformance::HalConformance(ArduinoInterface* hal, HalProbe* probe, NanosClock clock)
+    : hal(hal), probe(probe), clock(clock)
+{
+   for (uint8_t m = 0; m < METHOD_COUNT; m++)
+   {
+      results[m] = NOT_CHECKED;
+      nanos[m]   = NOT_TIMED;
+   }
+}
+
+void HalConformance::run(const Config& config)
+{
+   this->config = config;
+   if (this->config.iterations == 0)
+      this->config.iterations = 1;
+   for (uint8_t m = 0; m < METHOD_COUNT; m++)
+      results[m] = NOT_CHECKED;
+
+   checkPins();
+   checkTime();
+   checkTone();
+   checkLcd();
+   checkInputs();
+   for (uint8_t m = 0; m < METHOD_COUNT; m++)
+      nanos[m] = timeBatch((Method)m);
+
+   // Leave the backend as quiet as it was found
+   hal->digitalWrite(config.outputPin, LOW);
+   if (config.relayPin != NO_PIN)
+      hal->relayWrite(config.relayPin, false);
+   hal->noTone(config.buzzerPin);
+   hal->lcdClear();
+   probe->driveInputs(0);
+   probe->settle();
+}
+
+uint8_t HalConformance::count(Result result) const
+{
+   uint8_t n = 0;
+   for (uint8_t m = 0; m < METHOD_COUNT; m++)
+   {
+      if (results[m] == result)
+         n++;
+   }
+   return n;
+}
+
+void HalConformance::report(const char* backend, LineSink sink) const
+{
+   char line[64];
+   snprintf(line, sizeof(line), "HAL %s: %u passed, %u failed, %u n/a", backend, count(PASS),
+            count(FAIL), count(UNOBSERVABLE));
+   sink(line);
+   snprintf(line, sizeof(line), "  %-18s %-5s %10s", "method", "check", "ns/call");
+   sink(line);
+   for (uint8_t m = 0; m < METHOD_COUNT; m++)
+   {
+      const char* name   = methodName((Method)m);
+      const char* result = resultName(results[m]);
+      if (nanos[m] == NOT_TIMED)
+         snprintf(line, sizeof(line), "  %-18s %-5s %10s", name, result, "-");
+      else
+         snprintf(line, sizeof(line), "  %-18s %-5s %10lu", name, result, (unsigned long)nanos[m]);
+      sink(line);
+   }
+}
+
+const char* HalConformance::methodName(Method method)
+{
+   static const char* const NAMES[METHOD_COUNT] = {
+       "digitalWrite", "digitalRead",   "relayWrite",     "millis",          "delay",
+       "tone",         "tone(duration)", "toneTimer",     "noTone",          "lcdClear",
+       "lcdSetCursor", "lcdPrint(text)", "lcdPrint(int)", "updateDebouncers", "is*Pressed",
+       "begin/endAtomic"};
+   return method < METHOD_COUNT ? NAMES[method] : "?";
+}
+
+const char* HalConformance::resultName(Result result)
+{
+   switch (result)
+   {
+      case PASS:
+         return "pass";
+      case FAIL:
+         return "FAIL";
+      case UNOBSERVABLE:
+         return "n/a";
+      default:
+         return "-";
+   }
+}
+
+// A method that fails any of its checks stays failed
+void HalConformance::mark(Method method, bool passed)
+{
+   if (results[method] != FAIL)
+      results[method] = passed ? PASS : FAIL;
+}
+
+void HalConformance::checkPins()
+{
+   const uint8_t pin = config.outputPin;
+   hal->pinMode(pin, OUTPUT);
+   hal->digitalWrite(pin, HIGH);
+   const bool high = hal->digitalRead(pin) == HIGH;
+   hal->digitalWrite(pin, LOW);
+   const bool low = hal->digitalRead(pin) == LOW;
+   mark(DIGITAL_WRITE, high && low);
+   mark(DIGITAL_READ, high && low);
+
+   // Whatever drives the coil, the pin reads back as commanded
+   if (config.relayPin == NO_PIN)
+      return;
+   hal->relayWrite(config.relayPin, true);
+   const bool closed = hal->digitalRead(config.relayPin) == HIGH;
+   hal->relayWrite(config.relayPin, false);
+   const bool open = hal->digitalRead(config.relayPin) == LOW;
+   mark(RELAY_WRITE, closed && open);
+}
+
+void HalConformance::checkTime()
+{
+   const uint32_t first  = hal->millis();
+   const uint32_t second = hal->millis();
+   hal->delay(DELAY_MS);
+   const uint32_t after = hal->millis();
+   mark(MILLIS, (int32_t)(second - first) >= 0 && (int32_t)(after - second) >= 0);
+   mark(DELAY, after - second >= DELAY_MS);
+}
+
+void HalConformance::checkTone()
+{
+   const uint8_t pin  = config.buzzerPin;
+   uint16_t      freq = 0;
+   hal->tone(pin, 1000);
+   probe->settle();
+   if (!probe->toneFrequency(freq))
+   {
+      results[TONE] = results[TONE_FOR] = results[TONE_TIMER] = results[NO_TONE] = UNOBSERVABLE;
+      hal->noTone(pin);
+      return;
+   }
+   mark(TONE, freq == 1000);
+
+   hal->tone(pin, 1200, 50);
+   probe->settle();
+   mark(TONE_FOR, probe->toneFrequency(freq) && freq == 1200);
+
+   hal->toneTimer(pin, 1500, toneTimerFor(1500));
+   probe->settle();
+   mark(TONE_TIMER, probe->toneFrequency(freq) && freq == 1500);
+
+   hal->noTone(pin);
+   probe->settle();
+   mark(NO_TONE, probe->toneFrequency(freq) && freq == 0);
+}
+
+bool HalConformance::rowIs(uint8_t row, const char* expected)
+{
+   char text[ROW_MAX + 1];
+   return probe->lcdRow(row, text, sizeof(text)) && strcmp(text, expected) == 0;
+}
+
+void HalConformance::checkLcd()
+{
+   char text[ROW_MAX + 1];
+   hal->lcdSetCursor(0, 0);
+   hal->lcdPrint("junk");
+   hal->lcdClear();
+   probe->settle();
+   if (!probe->lcdRow(0, text, sizeof(text)))
+   {
+      results[LCD_CLEAR] = results[LCD_SET_CURSOR] = UNOBSERVABLE;
+      results[LCD_PRINT_TEXT] = results[LCD_PRINT_NUMBER] = UNOBSERVABLE;
+      return;
+   }
+   mark(LCD_CLEAR, rowIs(0, "") && rowIs(1, ""));
+
+   // Each print continues where the last one stopped
+   hal->lcdSetCursor(0, 0);
+   hal->lcdPrint("AB");
+   probe->settle();
+   mark(LCD_PRINT_TEXT, rowIs(0, "AB"));
+   hal->lcdPrint(7);
+   hal->lcdSetCursor(4, 1);
+   hal->lcdPrint(-12);
+   probe->settle();
+   mark(LCD_PRINT_NUMBER, rowIs(0, "AB7") && rowIs(1, "    -12"));
+
+   // Moving the cursor overwrites in place and leaves the rest of the row
+   hal->lcdSetCursor(1, 0);
+   hal->lcdPrint("x");
+   probe->settle();
+   mark(LCD_SET_CURSOR, rowIs(0, "Ax7") && rowIs(1, "    -12"));
+
+   hal->lcdClear();
+   probe->settle();
+   mark(LCD_CLEAR, rowIs(0, "") && rowIs(1, ""));
+}
+
+bool HalConformance::settleTo(uint8_t mask)
+{
+   for (uint16_t ms = 0; ms <= config.settleMs; ms++)
+   {
+      hal->updateDebouncers();
+      const uint8_t pressed = (hal->isArmPressed() ? INPUT_BIT_ARM : 0) |
+                              (hal->isResetPressed() ? INPUT_BIT_RESET : 0) |
+                              (hal->isLaunchPressed() ? INPUT_BIT_LAUNCH : 0);
+      if (pressed == mask)
+         return true;
+      hal->delay(1);
+   }
+   return false;
+}
+
+void HalConformance::checkInputs()
+{
+   if (!probe->driveInputs(0))
+   {
+      results[UPDATE_DEBOUNCERS] = results[IS_PRESSED] = UNOBSERVABLE;
+      return;
+   }
+
+   // Each input alone, pressed then released, without disturbing the other two
+   bool                 ok     = settleTo(0);
+   static const uint8_t BITS[] = {INPUT_BIT_ARM, INPUT_BIT_RESET, INPUT_BIT_LAUNCH};
+   for (uint8_t i = 0; i < sizeof(BITS); i++)
+   {
+      probe->driveInputs(BITS[i]);
+      ok = settleTo(BITS[i]) && ok;
+      probe->driveInputs(0);
+      ok = settleTo(0) && ok;
+   }
+   mark(UPDATE_DEBOUNCERS, ok);
+   mark(IS_PRESSED, ok);
+}
+
+uint32_t HalConformance::timeBatch(Method method)
+{
+   const uint16_t  n      = config.iterations;
+   const uint8_t   out    = config.outputPin;
+   const uint8_t   buzzer = config.buzzerPin;
+   const ToneTimer note   = toneTimerFor(1000);
+   uint8_t         seen   = 0;
+   const uint32_t  start  = clock();
+   switch (method)
+   {
+      case DIGITAL_WRITE:
+         for (uint16_t i = 0; i < n; i++)
+            hal->digitalWrite(out, (uint8_t)(i & 1));
+         break;
+      case DIGITAL_READ:
+         for (uint16_t i = 0; i < n; i++)
+            seen ^= hal->digitalRead(out);
+         break;
+      case RELAY_WRITE:
+         if (config.relayPin == NO_PIN)
+            return NOT_TIMED;
+         for (uint16_t i = 0; i < n; i++)
+            hal->relayWrite(config.relayPin, (i & 1) == 0);
+         break;
+      case MILLIS:
+         for (uint16_t i = 0; i < n; i++)
+            seen ^= (uint8_t)hal->millis();
+         break;
+      case TONE:
+         for (uint16_t i = 0; i < n; i++)
+            hal->tone(buzzer, (i & 1) ? 1200 : 1000);
+         break;
+      case TONE_FOR:
+         for (uint16_t i = 0; i < n; i++)
+            hal->tone(buzzer, (i & 1) ? 1200 : 1000, 50);
+         break;
+      case TONE_TIMER:
+         for (uint16_t i = 0; i < n; i++)
+            hal->toneTimer(buzzer, 1000, note);
+         break;
+      case NO_TONE:
+         for (uint16_t i = 0; i < n; i++)
+            hal->noTone(buzzer);
+         break;
+      case LCD_CLEAR:
+         for (uint16_t i = 0; i < n; i++)
+            hal->lcdClear();
+         break;
+      case LCD_SET_CURSOR:
+         for (uint16_t i = 0; i < n; i++)
+            hal->lcdSetCursor((uint8_t)(i & 15), (uint8_t)((i >> 4) & 1));
+         break;
+      case LCD_PRINT_TEXT:
+         for (uint16_t i = 0; i < n; i++)
+            hal->lcdPrint("0123456789ABCDEF"); // a full row
+         break;
+      case LCD_PRINT_NUMBER:
+         for (uint16_t i = 0; i < n; i++)
+            hal->lcdPrint((int)i);
+         break;
+      case UPDATE_DEBOUNCERS:
+         for (uint16_t i = 0; i < n; i++)
+            hal->updateDebouncers();
+         break;
+      case IS_PRESSED:
+         for (uint16_t i = 0; i < n; i++)
+            seen ^= hal->isArmPressed() ? 1 : 0;
+         break;
+      case ATOMIC:
+         for (uint16_t i = 0; i < n; i++)
+         {
+            hal->beginAtomic();
+            hal->endAtomic();
+         }
+         break;
+      default:
+         return NOT_TIMED;
+   }
+   const uint32_t elapsed = clock() - start;
+   readSink               = seen;
+   probe->settle();
+   return elapsed / n;
+}
@@ -0,0 +1,146 @@
+#ifndef HAL_CONFORMANCE_H
+#define HAL_CONFORMANCE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ArduinoInterface.h"
+
+// What a backend can show or drive that ArduinoInterface itself cannot; a hook
+// that returns false leaves its checks "n/a" instead of failed. The defaults
+// see nothing, which is all a board can offer from the inside.
+class HalProbe
+{
+ public:
+   virtual ~HalProbe() = default;
+
+   // Frequency sounding now (0 = silent)
+   virtual bool toneFrequency(uint16_t& freq)
+   {
+      (void)freq;
+      return false;
+   }
+
+   // Row contents without trailing blanks; size includes the terminator
+   virtual bool lcdRow(uint8_t row, char* text, uint8_t size)
+   {
+      (void)row;
+      (void)text;
+      (void)size;
+      return false;
+   }
+
+   // Hold the raw inputs in mask (INPUT_BIT_*) pressed and the others released
+   virtual bool driveInputs(uint8_t mask)
+   {
+      (void)mask;
+      return false;
+   }
+
+   // Let deferred work (a queued display or buzzer) catch up before anything is observed
+   virtual void settle()
+   {
+   }
+};
+
+// Conformance and per-call cost of one ArduinoInterface backend
+//
+// run() first checks what each method promises, as far as the probe lets it
+// see: outputs and the relay read back as written, millis() follows delay(),
+// the buzzer sounds the last frequency asked for, the LCD prints at the
+// cursor like an HD44780, and each debounced input follows its own raw input
+// within settleMs. It then times every method over a batch of calls. report()
+// prints one table with the same row per method for every backend, so tables
+// from different backends compare line by line. Times include the loop and
+// the virtual call and are only as fine as the clock over a batch; a batch
+// must take less than the clock's 4.29 s wrap.
+class HalConformance
+{
+ public:
+   enum Method : uint8_t
+   {
+      DIGITAL_WRITE,
+      DIGITAL_READ,
+      RELAY_WRITE,
+      MILLIS,
+      DELAY,
+      TONE,
+      TONE_FOR,
+      TONE_TIMER,
+      NO_TONE,
+      LCD_CLEAR,
+      LCD_SET_CURSOR,
+      LCD_PRINT_TEXT,
+      LCD_PRINT_NUMBER,
+      UPDATE_DEBOUNCERS,
+      IS_PRESSED,
+      ATOMIC,
+      METHOD_COUNT
+   };
+
+   enum Result : uint8_t
+   {
+      NOT_CHECKED,
+      PASS,
+      FAIL,
+      UNOBSERVABLE
+   };
+
+   // Free-running nanoseconds (micros() * 1000 on a board); only differences are used
+   typedef uint32_t (*NanosClock)();
+   typedef void (*LineSink)(const char* line);
+
+   static constexpr uint32_t NOT_TIMED = 0xFFFFFFFF;
+   static constexpr uint8_t  NO_PIN    = 0xFF;
+
+   struct Config
+   {
+      uint8_t  outputPin  = 5;      // toggled freely (PIN_LED_READY)
+      uint8_t  relayPin   = NO_PIN; // only with nothing on the relay contacts (PIN_RELAY = 8)
+      uint8_t  buzzerPin  = 9;      // PIN_BUZZER
+      uint16_t iterations = 1000;   // calls per timed batch
+      uint16_t settleMs   = 100;    // debounced inputs must follow within this
+   };
+
+   HalConformance(ArduinoInterface* hal, HalProbe* probe, NanosClock clock);
+
+   // Check, then time; leaves outputs low, the buzzer silent and the LCD clear
+   void run(const Config& config);
+
+   Result result(Method method) const
+   {
+      return results[method];
+   }
+
+   // Mean cost of one call, or NOT_TIMED
+   uint32_t nanosPerCall(Method method) const
+   {
+      return nanos[method];
+   }
+
+   uint8_t count(Result result) const;
+
+   void    report(const char* backend, LineSink sink) const;
+
+   static const char* methodName(Method method);
+   static const char* resultName(Result result);
+
+ private:
+   ArduinoInterface* hal;
+   HalProbe*         probe;
+   NanosClock        clock;
+   Config            config;
+   Result            results[METHOD_COUNT];
+   uint32_t          nanos[METHOD_COUNT];
+
+   void              mark(Method method, bool passed);
+   void              checkPins();
+   void              checkTime();
+   void              checkTone();
+   void              checkLcd();
+   void              checkInputs();
+   bool              rowIs(uint8_t row, const char* expected);
+   bool              settleTo(uint8_t mask);
+   uint32_t          timeBatch(Method method);
+};
+
+#endif // HAL_CONFORMANCE_H
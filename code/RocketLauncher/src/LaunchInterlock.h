@@ -0,0 +1,107 @@
+#ifndef LAUNCH_INTERLOCK_H
+#define LAUNCH_INTERLOCK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ArduinoInterface.h"
+#include "RocketController.h"
+
+// The input interlock of the launch sequence, as constant-evaluable functions
+//
+// RocketController takes its READY, ARMED and LAUNCH_COUNTDOWN transitions
+// from these, and replay() runs scripted inputs through the same functions at
+// compile time, so the safety scenarios in RocketController.cpp are
+// static_asserts: a change that lets the relay close without the full ARM +
+// LAUNCH hold fails to build in every env and costs the board nothing.
+// Inputs are INPUT_BIT_* masks; locked is RocketController::isSystemLocked().
+namespace LaunchInterlock
+{
+   // READY: arming is the only way on
+   constexpr State fromReady(uint8_t inputs, bool locked)
+   {
+      return !locked && (inputs & INPUT_BIT_ARM) ? State::ARMED : State::READY;
+   }
+
+   // ARMED: heldSince is when LAUNCH was first seen held (0 = not held), kept by the caller
+   constexpr State fromArmed(uint8_t inputs, bool locked, uint32_t now, uint32_t& heldSince)
+   {
+      if (!locked && !(inputs & INPUT_BIT_ARM))
+         return State::READY;
+      if (!locked && (inputs & INPUT_BIT_LAUNCH))
+      {
+         if (heldSince == 0)
+            heldSince = now;
+         return now - heldSince >= RocketController::LAUNCH_HOLD_MS ? State::LAUNCH_COUNTDOWN
+                                                                    : State::ARMED;
+      }
+      heldSince = 0;
+      return State::ARMED;
+   }
+
+   // LAUNCH_COUNTDOWN: losing ARM is an interlock fault, letting go of LAUNCH an abort
+   constexpr State fromCountdown(uint8_t inputs, bool locked, uint32_t now, uint32_t enteredAt)
+   {
+      if (!locked && !(inputs & INPUT_BIT_ARM))
+         return State::FAULT;
+      if (!locked && !(inputs & INPUT_BIT_LAUNCH))
+         return State::ABORT;
+      return now - enteredAt >= RocketController::HOLD_TO_LAUNCH_MS ? State::LAUNCHING
+                                                                    : State::LAUNCH_COUNTDOWN;
+   }
+
+   // Scripted pad: inputs from at (ms) until the next press
+   struct Press
+   {
+      uint32_t at;
+      uint8_t  inputs;
+   };
+
+   struct Outcome
+   {
+      State    final;
+      uint32_t firedAt; // when LAUNCHING closed the relay, 0 if it never did
+   };
+
+   // Run script from READY, unlocked, in 1 ms ticks up to endMs, calling the functions above
+   // as RocketController::update() does. The replay ends in LAUNCHING, ABORT or FAULT, as
+   // from there on the inputs no longer decide whether the relay closes.
+   template <size_t N> constexpr Outcome replay(const Press (&script)[N], uint32_t endMs)
+   {
+      State    state     = State::READY;
+      uint32_t enteredAt = 0;
+      uint32_t heldSince = 0;
+      uint8_t  inputs    = 0;
+      size_t   next      = 0;
+      for (uint32_t now = 1; now <= endMs; now++)
+      {
+         while (next < N && script[next].at <= now)
+            inputs = script[next++].inputs;
+
+         State to = state;
+         switch (state)
+         {
+            case State::READY:
+               to = fromReady(inputs, false);
+               break;
+            case State::ARMED:
+               to = fromArmed(inputs, false, now, heldSince);
+               break;
+            case State::LAUNCH_COUNTDOWN:
+               to = fromCountdown(inputs, false, now, enteredAt);
+               break;
+            default:
+               return Outcome{state, state == State::LAUNCHING ? enteredAt : 0};
+         }
+         if (to != state)
+         {
+            state     = to;
+            enteredAt = now;
+            if (to == State::ARMED)
+               heldSince = 0;
+         }
+      }
+      return Outcome{state, state == State::LAUNCHING ? enteredAt : 0};
+   }
+} // namespace LaunchInterlock
+
+#endif // LAUNCH_INTERLOCK_H
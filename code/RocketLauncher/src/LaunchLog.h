@@ -0,0 +1,44 @@
+#ifndef LAUNCH_LOG_H
+#define LAUNCH_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Crc16.h"
+#include "SerialFrame.h"
+
+// Lifetime counters kept in EEPROM, at LAUNCH_LOG_ADDR
+static constexpr uint16_t LAUNCH_LOG_ADDR  = 0;
+static constexpr uint8_t  LAUNCH_LOG_MAGIC = 0x4C;
+static constexpr uint8_t  LAUNCH_LOG_BYTES = 10; // magic, fires, faults, violation, crc
+
+// lastViolation for a FAULT the safety monitor did not raise (clear of its codes)
+static constexpr uint8_t  LAUNCH_LOG_FAULT_RAM = 0x80; // scrubber or redundant-field check
+
+struct LaunchLog
+{
+   uint32_t fires         = 0; // relay closures (contact wear)
+   uint16_t faults        = 0;
+   uint8_t  lastViolation = 0; // SafetyMonitor::Violation or LAUNCH_LOG_FAULT_*
+};
+
+static inline void encodeLaunchLog(uint8_t* p, const LaunchLog& log)
+{
+   p[0]       = LAUNCH_LOG_MAGIC;
+   uint8_t* q = framePutU16(framePutU32(p + 1, log.fires), log.faults);
+   *q++       = log.lastViolation;
+   framePutU16(q, crc16(p, LAUNCH_LOG_BYTES - 2));
+}
+
+// False for blank or damaged EEPROM (log left untouched)
+static inline bool decodeLaunchLog(const uint8_t* p, LaunchLog& log)
+{
+   if (p[0] != LAUNCH_LOG_MAGIC ||
+       frameGetU16(p + LAUNCH_LOG_BYTES - 2) != crc16(p, LAUNCH_LOG_BYTES - 2))
+      return false;
+   log.fires         = frameGetU32(p + 1);
+   log.faults        = frameGetU16(p + 5);
+   log.lastViolation = p[7];
+   return true;
+}
+
+#endif // LAUNCH_LOG_H
@@ -0,0 +1,61 @@
+#include "LoadCellCapture.h"
+
+void LoadCellCapture::begin()
+{
+   active = false;
+   head   = 0;
+   tail   = 0;
+   fill   = 0;
+   total  = 0;
+   drops  = 0;
+   active = true;
+}
+
+void LoadCellCapture::end()
+{
+   active = false;
+}
+
+void LoadCellCapture::push(int32_t sample)
+{
+   if (!active)
+      return;
+   if (fill == CAPACITY)
+   {
+      drops++; // consumer fell behind
+      return;
+   }
+
+   uint8_t* slot = ring[head];
+   slot[0]       = (uint8_t)sample;
+   slot[1]       = (uint8_t)(sample >> 8);
+   slot[2]       = (uint8_t)(sample >> 16);
+   head          = head + 1 == CAPACITY ? 0 : head + 1;
+   fill          = fill + 1;
+   total         = total + 1;
+}
+
+void LoadCellCapture::missed(uint16_t slots)
+{
+   if (active)
+      drops = drops + slots;
+}
+
+uint16_t LoadCellCapture::available() const
+{
+   return fill;
+}
+
+uint16_t LoadCellCapture::read(int32_t* out, uint16_t max)
+{
+   uint16_t n = 0;
+   while (n < max && fill)
+   {
+      const uint8_t* slot = ring[tail];
+      const uint32_t v    = slot[0] | ((uint32_t)slot[1] << 8) | ((uint32_t)slot[2] << 16);
+      out[n++]            = (int32_t)(v ^ 0x800000u) - 0x800000;
+      tail                = tail + 1 == CAPACITY ? 0 : tail + 1;
+      fill                = fill - 1;
+   }
+   return n;
+}
@@ -0,0 +1,67 @@
+#ifndef LOAD_CELL_CAPTURE_H
+#define LOAD_CELL_CAPTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Ring size in samples (3 bytes each), sized to what the board can spare
+#ifndef LOADCELL_RING_SAMPLES
+#if defined(__AVR__)
+#define LOADCELL_RING_SAMPLES 96
+#else
+#define LOADCELL_RING_SAMPLES 2048
+#endif
+#endif
+
+// Static-fire thrust samples captured from a timer tick into a fixed ring
+//
+// The acquisition side (timer ISR) calls push() for every conversion and
+// missed() for every conversion slot that went by without one; the main loop
+// drains the ring into serial frames. Nothing is allocated after construction,
+// and every sample that could not be stored is counted, so the dump proves
+// whether acquisition kept up. The consumer must keep the producer's interrupt
+// out while it calls available()/read() (ArduinoInterface::beginAtomic).
+class LoadCellCapture
+{
+ public:
+   static constexpr uint16_t CAPACITY = LOADCELL_RING_SAMPLES;
+
+   // Empty the ring and start accepting samples
+   void     begin();
+   void     end();
+
+   bool isCapturing() const
+   {
+      return active;
+   }
+
+   // Producer side (24-bit signed samples)
+   void     push(int32_t sample);
+   void     missed(uint16_t slots = 1);
+
+   // Consumer side
+   uint16_t available() const;
+   uint16_t read(int32_t* out, uint16_t max);
+
+   // Samples stored since begin() (the index of the next sample read is captured - available)
+   uint32_t captured() const
+   {
+      return total;
+   }
+
+   uint32_t dropped() const
+   {
+      return drops;
+   }
+
+ private:
+   uint8_t           ring[CAPACITY][3];
+   volatile uint16_t head   = 0;
+   volatile uint16_t tail   = 0;
+   volatile uint16_t fill   = 0;
+   volatile uint32_t total  = 0;
+   volatile uint32_t drops  = 0;
+   volatile bool     active = false;
+};
+
+#endif // LOAD_CELL_CAPTURE_H
@@ -0,0 +1,196 @@
+// Needs <atomic> (SpscRing.h): the RTOS build and host tools only, never avr-gcc
+#if !defined(__AVR__)
+
+#include "QueuedUiInterface.h"
+#include <stdio.h>
+
+void QueuedUiInterface::queueAudio(UiCommand::Kind kind, uint8_t pin, uint16_t freq,
+                                   uint32_t duration, ToneTimer timer)
+{
+   UiCommand c;
+   c.kind     = kind;
+   c.pin      = pin;
+   c.freq     = freq;
+   c.duration = duration;
+   c.timer    = timer;
+   if (!audioQueue.push(c))
+      countDrop();
+}
+
+uint16_t QueuedUiInterface::drainAudio(uint16_t max)
+{
+   UiCommand c;
+   uint16_t  n = 0;
+   while (n < max && audioQueue.pop(c))
+   {
+      n++;
+      switch (c.kind)
+      {
+         case UiCommand::TONE:
+            hw->tone(c.pin, c.freq);
+            break;
+         case UiCommand::TONE_FOR:
+            hw->tone(c.pin, c.freq, c.duration);
+            break;
+         case UiCommand::TONE_TIMER:
+            hw->toneTimer(c.pin, c.freq, c.timer);
+            break;
+         case UiCommand::NO_TONE:
+            hw->noTone(c.pin);
+            break;
+      }
+   }
+   return n;
+}
+
+// Longer writes than a frame are split; only frames are promised to stay whole
+void QueuedUiInterface::serialWrite(const uint8_t* data, uint16_t len)
+{
+   while (len)
+   {
+      SerialChunk chunk;
+      chunk.len = len < SerialChunk::SIZE ? (uint8_t)len : SerialChunk::SIZE;
+      memcpy(chunk.data, data, chunk.len);
+      if (!serialQueue.push(chunk))
+      {
+         countDrop();
+         return;
+      }
+      data += chunk.len;
+      len = (uint16_t)(len - chunk.len);
+   }
+}
+
+bool QueuedUiInterface::drainSerial()
+{
+   for (;;)
+   {
+      if (!sendingBusy)
+      {
+         if (!serialQueue.pop(sending))
+            return true;
+         sendingAt   = 0;
+         sendingBusy = true;
+      }
+      const uint16_t room = hw->serialWritable();
+      const uint8_t  left = (uint8_t)(sending.len - sendingAt);
+      const uint8_t  n    = room < left ? (uint8_t)room : left;
+      if (n == 0)
+         return false;
+      hw->serialWrite(sending.data + sendingAt, n);
+      sendingAt   = (uint8_t)(sendingAt + n);
+      sendingBusy = sendingAt < sending.len;
+   }
+}
+
+// Producer side: the buffer only changes where the text differs, as the display would
+void QueuedUiInterface::lcdClear()
+{
+   for (uint8_t r = 0; r < LCD_ROWS; r++)
+   {
+      for (uint8_t c = 0; c < LCD_COLS; c++)
+         screen[r][c].store(' ', std::memory_order_relaxed);
+   }
+   cursorCol = 0;
+   cursorRow = 0;
+   screenGen.fetch_add(1, std::memory_order_release);
+}
+
+void QueuedUiInterface::lcdSetCursor(uint8_t col, uint8_t row)
+{
+   cursorCol = col;
+   cursorRow = row < LCD_ROWS ? row : LCD_ROWS - 1;
+}
+
+void QueuedUiInterface::lcdPrint(const char* text)
+{
+   bool changed = false;
+   for (; *text; text++)
+   {
+      // Past the last column the characters land off screen, as on the panel
+      if (cursorCol < LCD_COLS)
+      {
+         std::atomic<char>& cell = screen[cursorRow][cursorCol];
+         if (cell.load(std::memory_order_relaxed) != *text)
+         {
+            cell.store(*text, std::memory_order_relaxed);
+            changed = true;
+         }
+      }
+      if (cursorCol != 0xFF)
+         cursorCol++;
+   }
+   if (changed)
+      screenGen.fetch_add(1, std::memory_order_release);
+}
+
+void QueuedUiInterface::lcdPrint(int number)
+{
+   char text[12];
+   snprintf(text, sizeof(text), "%d", number);
+   lcdPrint(text);
+}
+
+// Consumer side. A generation taken before the copy means a write that races the copy is
+// picked up by the next drain, whatever part of it this one saw.
+uint16_t QueuedUiInterface::drainLcd(uint16_t max)
+{
+   const uint32_t gen = screenGen.load(std::memory_order_acquire);
+   if (gen == shownGen)
+      return 0;
+
+   char want[LCD_ROWS][LCD_COLS];
+   bool blank = true;
+   bool clear = false;
+   for (uint8_t r = 0; r < LCD_ROWS; r++)
+   {
+      for (uint8_t c = 0; c < LCD_COLS; c++)
+      {
+         want[r][c] = screen[r][c].load(std::memory_order_relaxed);
+         blank      = blank && want[r][c] == ' ';
+         clear      = clear || shown[r][c] != ' ';
+      }
+   }
+
+   uint16_t n = 0;
+   if (blank && clear)
+   {
+      if (max == 0)
+         return 0;
+      hw->lcdClear();
+      memset(shown, ' ', sizeof(shown));
+      n++;
+   }
+
+   // One span per row, from its first changed character to its last
+   for (uint8_t r = 0; r < LCD_ROWS; r++)
+   {
+      uint8_t first = LCD_COLS;
+      uint8_t last  = 0;
+      for (uint8_t c = 0; c < LCD_COLS; c++)
+      {
+         if (want[r][c] != shown[r][c])
+         {
+            if (first == LCD_COLS)
+               first = c;
+            last = c;
+         }
+      }
+      if (first == LCD_COLS)
+         continue;
+      if (n + 2 > max)
+         return n; // the rest on the next drain
+
+      char span[LCD_COLS + 1];
+      memcpy(span, &want[r][first], last - first + 1);
+      span[last - first + 1] = '\0';
+      hw->lcdSetCursor(first, r);
+      hw->lcdPrint(span);
+      memcpy(&shown[r][first], span, last - first + 1);
+      n = (uint16_t)(n + 2);
+   }
+   shownGen = gen;
+   return n;
+}
+
+#endif // !__AVR__
@@ -0,0 +1,263 @@
+#ifndef QUEUED_UI_INTERFACE_H
+#define QUEUED_UI_INTERFACE_H
+
+#include <atomic>
+#include <string.h>
+#include "ArduinoInterface.h"
+#include "SerialFrame.h"
+#include "SpscRing.h"
+
+// One buzzer call held for a lower-priority task
+struct UiCommand
+{
+   enum Kind : uint8_t
+   {
+      TONE,
+      TONE_FOR,
+      TONE_TIMER,
+      NO_TONE
+   };
+
+   Kind      kind;
+   uint8_t   pin;
+   uint16_t  freq;
+   uint32_t  duration;
+   ToneTimer timer;
+};
+
+// One serialWrite() held for the task that owns the port; a whole frame fits
+struct SerialChunk
+{
+   static constexpr uint8_t SIZE = FRAME_OVERHEAD + FRAME_MAX_PAYLOAD;
+
+   uint8_t                  len;
+   uint8_t                  data[SIZE];
+};
+
+// ArduinoInterface for the safety task of a preemptive build
+//
+// Pins, inputs, time, storage and the timer hooks go straight to the hardware
+// interface. Everything slow is handed to lower-priority tasks without locks,
+// so the controller never waits on it:
+//   - the LCD calls draw into a 16x2 screen buffer, and drainLcd() brings the
+//     display up to date with what the buffer holds, a changed span per row.
+//     Redundant cursor and print calls merge there, so a burst of redraws
+//     costs the latest screen and nothing is ever dropped or left stale;
+//   - buzzer calls are queued in order and replayed by drainAudio(); a full
+//     ring drops the call and counts it;
+//   - serial writes are queued whole and sent by drainSerial(), so the task
+//     that owns the port can put its text between frames, never inside one.
+class QueuedUiInterface : public ArduinoInterface
+{
+ public:
+   static constexpr size_t  AUDIO_QUEUE  = 16;
+   static constexpr size_t  SERIAL_QUEUE = 16;
+   static constexpr uint8_t LCD_COLS     = 16;
+   static constexpr uint8_t LCD_ROWS     = 2;
+
+   explicit QueuedUiInterface(ArduinoInterface* hw) : hw(hw)
+   {
+      for (uint8_t r = 0; r < LCD_ROWS; r++)
+      {
+         for (uint8_t c = 0; c < LCD_COLS; c++)
+         {
+            screen[r][c].store(' ', std::memory_order_relaxed);
+            shown[r][c] = ' ';
+         }
+      }
+   }
+
+   // Straight through
+   void digitalWrite(uint8_t pin, uint8_t state) override
+   {
+      hw->digitalWrite(pin, state);
+   }
+
+   uint8_t digitalRead(uint8_t pin) const override
+   {
+      return hw->digitalRead(pin);
+   }
+
+   void pinMode(uint8_t pin, uint8_t mode) override
+   {
+      hw->pinMode(pin, mode);
+   }
+
+   void relayWrite(uint8_t pin, bool on) override
+   {
+      hw->relayWrite(pin, on);
+   }
+
+   uint32_t millis() const override
+   {
+      return hw->millis();
+   }
+
+   void delay(uint32_t ms) override
+   {
+      hw->delay(ms);
+   }
+
+   void updateDebouncers() override
+   {
+      hw->updateDebouncers();
+   }
+
+   bool isArmPressed() const override
+   {
+      return hw->isArmPressed();
+   }
+
+   bool isResetPressed() const override
+   {
+      return hw->isResetPressed();
+   }
+
+   bool isLaunchPressed() const override
+   {
+      return hw->isLaunchPressed();
+   }
+
+   uint8_t wornInputMask() const override
+   {
+      return hw->wornInputMask();
+   }
+
+   bool attachAuxTimer(AuxScheduler* aux) override
+   {
+      return hw->attachAuxTimer(aux);
+   }
+
+   void beginAtomic() override
+   {
+      hw->beginAtomic();
+   }
+
+   void endAtomic() override
+   {
+      hw->endAtomic();
+   }
+
+   uint16_t startLoadCell(LoadCellCapture* capture) override
+   {
+      return hw->startLoadCell(capture);
+   }
+
+   void stopLoadCell() override
+   {
+      hw->stopLoadCell();
+   }
+
+   uint16_t startRawCapture(RawCapture* capture) override
+   {
+      return hw->startRawCapture(capture);
+   }
+
+   void stopRawCapture() override
+   {
+      hw->stopRawCapture();
+   }
+
+   // Persisting stays direct: the hardware interface already queues it
+
+   bool persist(uint16_t addr, const uint8_t* data, uint8_t len) override
+   {
+      return hw->persist(addr, data, len);
+   }
+
+   bool recall(uint16_t addr, uint8_t* data, uint8_t len) const override
+   {
+      return hw->recall(addr, data, len);
+   }
+
+   bool persistIdle() const override
+   {
+      return hw->persistIdle();
+   }
+
+   void persistFlush() override
+   {
+      hw->persistFlush();
+   }
+
+   // Queued
+   void tone(uint8_t pin, uint16_t freq) override
+   {
+      queueAudio(UiCommand::TONE, pin, freq);
+   }
+
+   void tone(uint8_t pin, uint16_t freq, uint32_t duration) override
+   {
+      queueAudio(UiCommand::TONE_FOR, pin, freq, duration);
+   }
+
+   void noTone(uint8_t pin) override
+   {
+      queueAudio(UiCommand::NO_TONE, pin, 0);
+   }
+
+   void toneTimer(uint8_t pin, uint16_t freq, ToneTimer timer) override
+   {
+      queueAudio(UiCommand::TONE_TIMER, pin, freq, 0, timer);
+   }
+
+   // A frame fits whenever the ring has a slot for it
+   uint16_t serialWritable() const override
+   {
+      return serialQueue.space() ? SerialChunk::SIZE : 0;
+   }
+
+   void serialWrite(const uint8_t* data, uint16_t len) override;
+
+   // Drawn into the screen buffer
+   void lcdClear() override;
+   void lcdSetCursor(uint8_t col, uint8_t row) override;
+   void lcdPrint(const char* text) override;
+   void lcdPrint(int number) override;
+
+   // Consumer side: bring the display up to date in at most max hardware calls (a cursor
+   // move and a print per changed row, or a clear); returns how many it made
+   uint16_t drainLcd(uint16_t max);
+
+   // Replay up to max buzzer calls; returns how many
+   uint16_t drainAudio(uint16_t max);
+
+   // Send what the port will take; true once every queued write has gone out whole
+   bool     drainSerial();
+
+   // Buzzer calls and serial writes lost to a full ring since start
+   uint32_t getDropped() const
+   {
+      return dropped.load(std::memory_order_relaxed);
+   }
+
+ private:
+   ArduinoInterface*                    hw;
+   SpscRing<UiCommand, AUDIO_QUEUE>     audioQueue;
+   SpscRing<SerialChunk, SERIAL_QUEUE>  serialQueue;
+   std::atomic<uint32_t>                dropped{0};
+
+   // Screen buffer: characters written by the producer, published by bumping screenGen
+   std::atomic<char>                    screen[LCD_ROWS][LCD_COLS];
+   std::atomic<uint32_t>                screenGen{0};
+   uint8_t                              cursorCol = 0; // producer only
+   uint8_t                              cursorRow = 0;
+
+   // Consumer only: what the display shows, and the buffer generation it matches
+   char                                 shown[LCD_ROWS][LCD_COLS];
+   uint32_t                             shownGen = 0;
+   SerialChunk                          sending;
+   uint8_t                              sendingAt = 0;
+   bool                                 sendingBusy = false;
+
+   void                                 queueAudio(UiCommand::Kind kind, uint8_t pin,
+                                                   uint16_t freq, uint32_t duration = 0,
+                                                   ToneTimer timer = {0, 0});
+
+   void                                 countDrop()
+   {
+      dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+   }
+};
+
+#endif // QUEUED_UI_INTERFACE_H
@@ -0,0 +1,50 @@
+#include "RamIntegrity.h"
+#include "Crc16.h"
+
+bool IncrementalCrc::addRegion(const void* start, uint16_t len)
+{
+   if (regionCount >= MAX_REGIONS || len == 0)
+      return false;
+   regions[regionCount].start = static_cast<const uint8_t*>(start);
+   regions[regionCount].len   = len;
+   regionCount++;
+   return true;
+}
+
+void IncrementalCrc::seal()
+{
+   uint16_t crc = 0xFFFF;
+   for (uint8_t i = 0; i < regionCount; i++)
+      crc = crc16(regions[i].start, regions[i].len, crc);
+   reference = crc;
+   running   = 0xFFFF;
+   regionIdx = 0;
+   offset    = 0;
+}
+
+bool IncrementalCrc::step(uint8_t budget)
+{
+   if (regionCount == 0)
+      return true;
+
+   while (budget--)
+   {
+      const Region& r = regions[regionIdx];
+      running         = crc16Update(running, r.start[offset]);
+      if (++offset < r.len)
+         continue;
+
+      offset = 0;
+      if (++regionIdx < regionCount)
+         continue;
+
+      // Full pass complete
+      regionIdx           = 0;
+      const bool matches  = running == reference;
+      running             = 0xFFFF;
+      passes++;
+      if (!matches)
+         return false;
+   }
+   return true;
+}
@@ -0,0 +1,75 @@
+#ifndef RAM_INTEGRITY_H
+#define RAM_INTEGRITY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Value stored alongside its bitwise complement; any single upset breaks the pair
+template <typename T>
+class Redundant
+{
+ public:
+   Redundant(T v = T())
+   {
+      set(v);
+   }
+
+   void set(T v)
+   {
+      value   = v;
+      inverse = (T)~v;
+   }
+
+   T get() const
+   {
+      return value;
+   }
+
+   bool intact() const
+   {
+      return (T)(value ^ inverse) == (T)~T(0);
+   }
+
+ private:
+   T value;
+   T inverse;
+};
+
+// Background CRC over registered RAM regions, advanced a few bytes per call
+//
+// seal() records the reference CRC; step() then walks the regions
+// incrementally and compares at the end of every full pass. Regions must only
+// hold data that does not change between seal() calls.
+class IncrementalCrc
+{
+ public:
+   static constexpr uint8_t MAX_REGIONS = 12;
+
+   bool     addRegion(const void* start, uint16_t len);
+   void     seal();
+
+   // Hash up to `budget` bytes; returns false when a completed pass does not match
+   bool     step(uint8_t budget);
+
+   uint16_t completedPasses() const
+   {
+      return passes;
+   }
+
+ private:
+   struct Region
+   {
+      const uint8_t* start;
+      uint16_t       len;
+   };
+
+   Region   regions[MAX_REGIONS];
+   uint8_t  regionCount = 0;
+   uint8_t  regionIdx   = 0;
+   uint16_t offset      = 0;
+   uint16_t running     = 0xFFFF;
+   uint16_t reference   = 0xFFFF;
+   uint16_t passes      = 0;
+};
+
+#endif // RAM_INTEGRITY_H
@@ -0,0 +1,46 @@
+#include "RawCapture.h"
+
+void RawCapture::begin()
+{
+   frozen   = true; // keep the tick out of the ring until it is reset
+   head     = 0;
+   filled   = 0;
+   postLeft = 0;
+   pending  = false;
+   pre      = 0;
+   why      = NONE;
+   misses   = 0;
+   frozen   = false;
+}
+
+bool RawCapture::trigger(Reason reason, uint32_t ms, uint8_t stateCode)
+{
+   if (pending)
+   {
+      if (misses != 0xFFFF)
+         misses++;
+      return false;
+   }
+   pending  = true;
+   pre      = filled < PRE ? filled : PRE;
+   why      = reason;
+   atMs     = ms;
+   state    = stateCode;
+   postLeft = POST;
+   return true;
+}
+
+void RawCapture::rearm()
+{
+   // Samples from before the freeze would sit right next to new ones with a gap between
+   filled  = 0;
+   pending = false;
+   frozen  = false;
+}
+
+uint8_t RawCapture::level(uint16_t i) const
+{
+   const uint16_t at = (uint16_t)(head - samples() + i);
+   const uint8_t  b  = ring[(at >> 1) & (SAMPLES / 2 - 1)];
+   return (at & 1) ? (uint8_t)(b >> 4) : (uint8_t)(b & 0x0F);
+}
@@ -0,0 +1,123 @@
+#ifndef RAW_CAPTURE_H
+#define RAW_CAPTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Ring size in samples (half a byte each); at 10 kHz, 25.6 ms on the UNO and 410 ms elsewhere
+#ifndef RAW_CAPTURE_SAMPLES
+#if defined(__AVR__)
+#define RAW_CAPTURE_SAMPLES 256
+#else
+#define RAW_CAPTURE_SAMPLES 4096
+#endif
+#endif
+
+// Undebounced input levels around an event, for tracing spurious triggers
+//
+// The timer tick calls sample() with the raw INPUT_BIT_* levels (1 = pressed);
+// they go into a ring two to a byte. trigger() marks an event: the tick keeps
+// sampling for POST more samples and then freezes, leaving up to PRE samples
+// from before the event and POST after it. The frozen window stays put until
+// the main loop has read it out and calls rearm(); triggers in the meantime
+// are only counted. The consumer must keep the tick's interrupt out while it
+// calls trigger() and rearm() (ArduinoInterface::beginAtomic); a frozen
+// window can be read without that, as the tick no longer writes to it.
+class RawCapture
+{
+ public:
+   static constexpr uint16_t SAMPLES = RAW_CAPTURE_SAMPLES;
+   static constexpr uint16_t PRE     = SAMPLES / 4 * 3; // a debounced edge lags the raw one
+   static constexpr uint16_t POST    = SAMPLES - PRE;
+   static_assert((SAMPLES & (SAMPLES - 1)) == 0 && SAMPLES >= 8,
+                 "sample count must be a power of two");
+
+   // What froze the window
+   enum Reason : uint8_t
+   {
+      NONE  = 0,
+      EDGE  = 1, // a debounced input changed
+      ABORT = 2,
+      FAULT = 3
+   };
+
+   // Forget everything and start waiting for a trigger
+   void begin();
+
+   // Producer side, from the tick; inline as it runs 10000 times a second
+   void sample(uint8_t levels)
+   {
+      if (frozen)
+         return;
+      const uint16_t at   = head;
+      uint8_t&       cell = ring[(at >> 1) & (SAMPLES / 2 - 1)];
+      cell = (at & 1) ? (uint8_t)((cell & 0x0F) | (levels << 4))
+                      : (uint8_t)((cell & 0xF0) | (levels & 0x0F));
+      head = (uint16_t)(at + 1);
+      if (filled < SAMPLES)
+         filled = (uint16_t)(filled + 1);
+      if (postLeft)
+      {
+         postLeft = (uint16_t)(postLeft - 1);
+         frozen   = postLeft == 0;
+      }
+   }
+
+   // Consumer side: freeze the window around now; false (and counted) if one is pending
+   bool     trigger(Reason reason, uint32_t ms, uint8_t stateCode);
+   void     rearm();
+
+   bool isFrozen() const
+   {
+      return frozen;
+   }
+
+   // Frozen window, oldest sample first; the trigger is at preSamples()
+   uint16_t samples() const
+   {
+      return (uint16_t)(pre + POST);
+   }
+
+   uint16_t preSamples() const
+   {
+      return pre;
+   }
+
+   uint8_t  level(uint16_t i) const;
+
+   Reason reason() const
+   {
+      return why;
+   }
+
+   uint32_t triggerMs() const
+   {
+      return atMs;
+   }
+
+   uint8_t triggerState() const
+   {
+      return state;
+   }
+
+   // Triggers that came while a window was pending
+   uint16_t missed() const
+   {
+      return misses;
+   }
+
+ private:
+   uint8_t           ring[SAMPLES / 2];
+   volatile uint16_t head     = 0;
+   volatile uint16_t filled   = 0; // samples in the ring since begin() or rearm()
+   volatile uint16_t postLeft = 0;
+   volatile bool     frozen   = false;
+   bool              pending  = false;
+   uint16_t          pre      = 0;
+   Reason            why      = NONE;
+   uint32_t          atMs     = 0;
+   uint8_t           state    = 0;
+   uint16_t          misses   = 0;
+};
+
+#endif // RAW_CAPTURE_H
@@ -0,0 +1,31 @@
+#include "RelayDrive.h"
+
+void RelayDrive::configure(uint16_t pullIn, uint8_t hold, uint8_t period)
+{
+   pullInTicks = pullIn;
+   periodTicks = period ? period : 1;
+   holdTicks   = hold < periodTicks ? hold : periodTicks;
+}
+
+void RelayDrive::set(bool state)
+{
+   if (state == on)
+      return;
+   on         = state;
+   pullInLeft = pullInTicks;
+   phase      = 0;
+   writer(state);
+}
+
+void RelayDrive::service()
+{
+   if (!on)
+      return;
+   if (pullInLeft)
+   {
+      pullInLeft = (uint16_t)(pullInLeft - 1);
+      return;
+   }
+   writer(phase < holdTicks);
+   phase = (uint8_t)(phase + 1 == periodTicks ? 0 : phase + 1);
+}
@@ -0,0 +1,48 @@
+#ifndef RELAY_DRIVE_H
+#define RELAY_DRIVE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Relay coil fed its full voltage to pull in, then held on a lower average voltage
+//
+// A relay needs its rated coil voltage to close but only a fraction of it to
+// stay closed, and a plainly driven coil draws full current for the whole
+// pulse. set(true) drives the pin high at once; after pullInTicks of a timer
+// tick, service() switches it holdTicks high out of every periodTicks, and the
+// coil's inductance (across its flyback diode) smooths that into a lower hold
+// current. set(false) drives the pin low at once, so opening never waits for
+// the tick. The caller must keep the tick's interrupt out around set().
+class RelayDrive
+{
+ public:
+   // Drive the relay pin; called from set() and service()
+   typedef void (*PinWriter)(bool high);
+
+   explicit RelayDrive(PinWriter writer) : writer(writer)
+   {
+   }
+
+   void configure(uint16_t pullInTicks, uint8_t holdTicks, uint8_t periodTicks);
+   void set(bool on);
+
+   // One tick: count down the pull-in, then step the hold PWM
+   void service();
+
+   // Commanded state, whatever the pin is at this instant
+   bool isOn() const
+   {
+      return on;
+   }
+
+ private:
+   PinWriter         writer;
+   uint16_t          pullInTicks = 0;
+   uint8_t           holdTicks   = 1;
+   uint8_t           periodTicks = 1;
+   volatile bool     on          = false;
+   volatile uint16_t pullInLeft  = 0;
+   uint8_t           phase       = 0; // position in the hold period
+};
+
+#endif // RELAY_DRIVE_H
@@ -1,5 +1,7 @@
 #include "RocketController.h"
 #include "ArduinoInterface.h"
+#include "LaunchInterlock.h"
+#include "SerialFrame.h"
 #include <string.h>
 
 // Buzzer sequence definitions
@@ -19,63 +21,270 @@ const char*    STARTUP_CHECKS[]      = {
     "Relay driver",     "Safety locks",   "Countdown timer", "Abort circuits",  "Fault detection",
     "Cooldown timer",   "ARM interlock",  "Reset hold",      "Global fault",    "Final check"};
 
+// State codes: extended Hamming(8,4) codewords, pairwise distance 4 and never 0x00/0xFF
+static const uint8_t STATE_CODES[]  = {0x87, 0x99, 0x1E, 0xAA, 0x2D, 0x33, 0xB4, 0x4B, 0xCC};
+static const uint8_t STATE_COUNT    = sizeof(STATE_CODES);
+static const uint8_t LOCKED_CODE    = 0xA5;
+static const uint8_t UNLOCKED_CODE  = 0x5A;
+
+// Safety scenarios, replayed through the interlock at compile time
+namespace
+{
+   using LaunchInterlock::Press;
+   using LaunchInterlock::replay;
+
+   constexpr uint8_t  ARM     = INPUT_BIT_ARM;
+   constexpr uint8_t  LAUNCH  = INPUT_BIT_LAUNCH;
+   constexpr uint32_t FIRE_AT = 20 + RocketController::LAUNCH_HOLD_MS +
+                                RocketController::HOLD_TO_LAUNCH_MS;
+
+   // ARM, then LAUNCH held with it: the relay closes after the LAUNCH hold and full countdown
+   constexpr Press    HOLD_BOTH[] = {{10, ARM}, {20, ARM | LAUNCH}};
+   static_assert(replay(HOLD_BOTH, FIRE_AT + 10).firedAt == FIRE_AT, "launch timing changed");
+
+   // No relay without both held
+   constexpr Press    LAUNCH_ONLY[] = {{10, LAUNCH}};
+   constexpr Press    ARM_ONLY[]    = {{10, ARM}};
+   constexpr Press    LAUNCH_TAPS[] = {{10, ARM},          {20, ARM | LAUNCH}, {269, ARM},
+                                       {280, ARM | LAUNCH}, {529, ARM},         {540, ARM | LAUNCH},
+                                       {789, ARM}};
+   static_assert(replay(LAUNCH_ONLY, 10000).final == State::READY, "LAUNCH alone must not arm");
+   static_assert(replay(ARM_ONLY, 10000).firedAt == 0, "ARM alone must not fire");
+   static_assert(replay(LAUNCH_TAPS, 10000).final == State::ARMED,
+                 "LAUNCH taps shorter than the hold must not start the countdown");
+
+   // Letting go of LAUNCH during the countdown aborts, even a tick before ignition
+   constexpr Press    EARLY_RELEASE[] = {{10, ARM}, {20, ARM | LAUNCH}, {3000, ARM}};
+   constexpr Press    LATE_RELEASE[]  = {{10, ARM}, {20, ARM | LAUNCH}, {FIRE_AT - 1, ARM}};
+   static_assert(replay(EARLY_RELEASE, 10000).final == State::ABORT, "early release must abort");
+   static_assert(replay(LATE_RELEASE, 10000).final == State::ABORT, "late release must abort");
+
+   // Dropping ARM during the countdown breaks the interlock: FAULT, with or without LAUNCH
+   constexpr Press    ARM_DROPPED[] = {{10, ARM}, {20, ARM | LAUNCH}, {3000, LAUNCH}};
+   constexpr Press    BOTH_DROPPED[] = {{10, ARM}, {20, ARM | LAUNCH}, {3000, 0}};
+   static_assert(replay(ARM_DROPPED, 10000).final == State::FAULT, "interlock break must fault");
+   static_assert(replay(BOTH_DROPPED, 10000).final == State::FAULT, "interlock break must fault");
+} // namespace
+
 // Constructor
 RocketController::RocketController(ArduinoInterface* interface)
-    : interface(interface), state(State::STARTUP), systemLocked(true)
+    : interface(interface), aux(interface)
+{
+   setState(State::STARTUP);
+   setLocked(true);
+   monitor.setLimits(HOLD_TO_LAUNCH_MS, RELAY_ON_MS);
+
+   // Data that must not change at runtime is scrubbed in the background
+   scrubber.addRegion(&this->interface, sizeof(this->interface));
+   scrubber.addRegion(&config, sizeof(config));
+   scrubber.addRegion(&aux.getConfig(), sizeof(AuxScheduler::Config));
+   scrubber.addRegion(STARTUP_CHECKS, sizeof(STARTUP_CHECKS));
+   scrubber.addRegion(SND_CHIRP, sizeof(SND_CHIRP));
+   scrubber.addRegion(SND_ARMED, sizeof(SND_ARMED));
+   scrubber.addRegion(SND_COUNTDOWN, sizeof(SND_COUNTDOWN));
+   scrubber.addRegion(SND_COUNTDOWN_SIREN, sizeof(SND_COUNTDOWN_SIREN));
+   scrubber.addRegion(SND_LAUNCH, sizeof(SND_LAUNCH));
+   scrubber.addRegion(SND_ABORT, sizeof(SND_ABORT));
+   scrubber.addRegion(SND_FAULT, sizeof(SND_FAULT));
+   scrubber.addRegion(SND_CHECK, sizeof(SND_CHECK));
+   scrubber.seal();
+
+   auxTimerDriven = interface->attachAuxTimer(&aux);
+
+   uint8_t raw[LAUNCH_LOG_BYTES];
+   logStorage = interface->recall(LAUNCH_LOG_ADDR, raw, sizeof(raw));
+   if (logStorage)
+      decodeLaunchLog(raw, launchLog);
+}
+
+State RocketController::getState() const
+{
+   if (stateCode.intact())
+   {
+      for (uint8_t i = 0; i < STATE_COUNT; i++)
+      {
+         if (STATE_CODES[i] == stateCode.get())
+            return (State)i;
+      }
+   }
+   return State::FAULT;
+}
+
+bool RocketController::isSystemLocked() const
 {
+   return !(lockCode.intact() && lockCode.get() == UNLOCKED_CODE);
+}
+
+bool RocketController::addAuxChannel(uint8_t pin, int16_t offsetMs, uint16_t pulseMs)
+{
+   interface->pinMode(pin, OUTPUT);
+   interface->digitalWrite(pin, LOW);
+   if (!aux.addChannel(pin, offsetMs, pulseMs))
+      return false;
+   scrubber.seal();
+   return true;
+}
+
+void RocketController::setStaticFireMode(bool enabled)
+{
+   config.staticFire = enabled;
+   scrubber.seal();
+}
+
+void RocketController::setRelayPulseMs(uint16_t ms)
+{
+   if (ms < MIN_RELAY_PULSE_MS)
+      ms = MIN_RELAY_PULSE_MS;
+   if (ms > RELAY_ON_MS)
+      ms = RELAY_ON_MS;
+   config.relayPulseMs = ms;
+   monitor.setLimits(HOLD_TO_LAUNCH_MS, ms);
+   scrubber.seal();
+}
+
+void RocketController::setTelemetry(bool enabled)
+{
+   config.telemetry = enabled;
+   scrubber.seal();
+   telemetryLast.state = 0xFF; // first update always reports
+}
+
+bool RocketController::setRawCapture(bool enabled)
+{
+   interface->stopRawCapture();
+   rawRateHz = 0;
+   if (!enabled)
+      return true;
+   rawCapture.begin();
+   rawDumpAt     = 0;
+   rawWindows    = 0;
+   rawInputsLast = inputMask();
+   rawRateHz     = interface->startRawCapture(&rawCapture);
+   return rawRateHz != 0;
+}
+
+void RocketController::setRangeMode(bool enabled)
+{
+   config.rangeMode = enabled;
+   scrubber.seal();
+}
+
+void RocketController::setState(State newState)
+{
+   stateCode.set(STATE_CODES[(uint8_t)newState]);
+}
+
+void RocketController::setLocked(bool locked)
+{
+   lockCode.set(locked ? LOCKED_CODE : UNLOCKED_CODE);
 }
 
 // Main update method
 void RocketController::update(uint32_t now)
 {
+   // RAM integrity: critical fields every tick, the rest a few bytes per tick
+   if (!criticalFieldsIntact() || !scrubber.step(SCRUB_BYTES_PER_TICK))
+   {
+      integrityFault();
+   }
+
    // Update buzzer first
    updateBuzzer(now);
 
    // Global fault check
+   State state = getState();
    if (state != State::FAULT && globalFaultActive())
    {
       enter(State::FAULT);
-      return;
+      recordFault((uint8_t)SafetyMonitor::Violation::NONE);
    }
-
-   // Update based on current state
-   switch (state)
+   else
    {
-      case State::STARTUP:
-         updateStartup(now);
-         break;
-      case State::SPLASH:
-         updateSplash(now);
-         break;
-      case State::READY:
-         updateReady(now);
-         break;
-      case State::ARMED:
-         updateArmed(now);
-         break;
-      case State::LAUNCH_COUNTDOWN:
-         updateLaunchCountdown(now);
-         break;
-      case State::LAUNCHING:
-         updateLaunching(now);
-         break;
-      case State::COOLDOWN:
-         updateCooldown(now);
-         break;
-      case State::ABORT:
-         updateAbort(now);
-         break;
-      case State::FAULT:
-         updateFault(now);
-         break;
+      // Update based on current state
+      switch (state)
+      {
+         case State::STARTUP:
+            updateStartup(now);
+            break;
+         case State::SPLASH:
+            updateSplash(now);
+            break;
+         case State::READY:
+            updateReady(now);
+            break;
+         case State::ARMED:
+            updateArmed(now);
+            break;
+         case State::LAUNCH_COUNTDOWN:
+            updateLaunchCountdown(now);
+            break;
+         case State::LAUNCHING:
+            updateLaunching(now);
+            break;
+         case State::COOLDOWN:
+            updateCooldown(now);
+            break;
+         case State::ABORT:
+            updateAbort(now);
+            break;
+         case State::FAULT:
+            updateFault(now);
+            break;
+      }
    }
+
+   if (!auxTimerDriven)
+      aux.service(now);
+
+   if (dumpPhase != DUMP_IDLE)
+      serviceCaptureDump();
+
+   // Runtime monitor checks the outputs the state machine just produced
+   verifySafety(now);
+
+   // After the monitor, so a FAULT it raised freezes a window too
+   if (rawRateHz)
+      serviceRawCapture(now, state);
+
+   if (config.telemetry)
+      serviceTelemetry(now);
+
+   // Last, so the relay path above never waits on it
+   if (logDirty)
+      persistLog();
 }
 
 // State transition method
 void RocketController::enter(State newState)
 {
-   state     = newState;
-   enteredAt = interface->millis();
+   const State previous = getState();
+   setState(newState);
+   enteredAt.set(interface->millis());
+
+   // Cycle time: from arming out of READY until READY again after a launch
+   if (newState == State::ARMED && previous == State::READY)
+   {
+      cycleStart = enteredAt.get();
+      cycleFired = false;
+   }
+   else if (newState == State::READY && cycleFired)
+   {
+      lastCycleMs = enteredAt.get() - cycleStart;
+      totalCycleMs += lastCycleMs;
+      launchCount++;
+      cycleFired = false;
+   }
+
+   // Thrust is only captured while the relay is closed
+   if (capture.isCapturing() && newState != State::LAUNCHING)
+      stopCapture();
+
+   // Aux channels live from countdown through cooldown only
+   if (newState != State::LAUNCH_COUNTDOWN && newState != State::LAUNCHING &&
+       newState != State::COOLDOWN)
+   {
+      aux.cancel();
+   }
 
    switch (newState)
    {
@@ -86,64 +295,77 @@ void RocketController::enter(State newState)
          startupComplete   = false;
          updateLCD("STARTUP", "Self-check...");
          playBuzzerSequence(SND_CHIRP, 2, false);
-         systemLocked = true;
+         setLocked(true);
          break;
 
       case State::SPLASH:
          setOutputs(false, false, false, false);
          updateLCD("Luke's Rocket", "Controller v0.1");
          playBuzzerSequence(SND_CHIRP, 2, false);
-         deadline     = interface->millis() + 5000; // 5s splash
-         systemLocked = true;
+         deadline.set(interface->millis() + 5000); // 5s splash
+         setLocked(true);
          break;
 
       case State::READY:
          setOutputs(true, false, false, false);
-         updateLCD("READY", "Disarmed");
+         updateLCD(config.staticFire ? "READY STATIC" : "READY",
+                   interface->wornInputMask() ? "Disarmed SW WORN" : "Disarmed");
          stopBuzzer();
-         systemLocked = false;
+         setLocked(false);
+         resetHeldSince.set(0);
+         resetReleased  = !interface->isResetPressed(); // a FAULT clear must not toggle the mode
          break;
 
       case State::ARMED:
          setOutputs(false, true, false, false);
          updateLCD("ARMED", "Hold LAUNCH");
          playBuzzerSequence(SND_ARMED, 2, true);
-         launchHeldSince = 0;
+         launchHeldSince.set(0);
          break;
 
       case State::LAUNCH_COUNTDOWN:
          setOutputs(false, true, false, false);
          updateLCD("COUNTDOWN", "Hold...");
          playBuzzerSequence(SND_COUNTDOWN_SIREN, 2, true);
+         aux.arm(enteredAt.get() + HOLD_TO_LAUNCH_MS);
          break;
 
       case State::LAUNCHING:
          setOutputs(false, false, true, true);
+         aux.ignite(enteredAt.get());
+         if (config.staticFire)
+            startCapture();
          updateLCD("LAUNCHING", "Relay ON");
-         deadline = interface->millis() + RELAY_ON_MS;
+         deadline.set(interface->millis() + config.relayPulseMs);
+         cycleFired = true;
+         cleanFire  = true; // until an anomaly says otherwise
+         launchLog.fires++;
+         logDirty = logStorage;
          playBuzzerSequence(SND_LAUNCH, 1, true);
          break;
 
       case State::COOLDOWN:
          setOutputs(false, false, false, false);
          updateLCD("COOLDOWN", "Post-fire");
-         deadline = interface->millis() + COOLDOWN_MS;
+         deadline.set(interface->millis() + (config.rangeMode ? RANGE_COOLDOWN_MS : COOLDOWN_MS));
          stopBuzzer();
          break;
 
       case State::ABORT:
          setOutputs(false, false, false, false);
          updateLCD("ABORT", "Inhibit...");
-         deadline = interface->millis() + ABORT_INHIBIT_MS;
+         deadline.set(interface->millis() + ABORT_INHIBIT_MS);
          playBuzzerSequence(SND_ABORT, 2, false);
          break;
 
       case State::FAULT:
          setOutputs(false, false, false, false);
-         updateLCD("FAULT", "Disarm + Reset");
-         resetHeldSince = 0;
+         cleanFire = false;
+         updateLCD(faultHeadline ? faultHeadline : "FAULT", "Disarm + Reset");
+         faultHeadline = nullptr;
+         resetHeldSince.set(0);
          playBuzzerSequence(SND_FAULT, 2, true);
-         systemLocked = false;
+         setLocked(false);
          break;
    }
 }
@@ -230,7 +452,7 @@ void RocketController::updateStartup(uint32_t now)
 
 void RocketController::updateSplash(uint32_t now)
 {
-   if ((long)(now - deadline) >= 0)
+   if ((int32_t)(now - deadline.get()) >= 0)
    {
       enter(State::STARTUP);
    }
@@ -238,56 +460,58 @@ void RocketController::updateSplash(uint32_t now)
 
 void RocketController::updateReady(uint32_t now)
 {
-   (void)now;  // Suppress unused parameter warning
-   if (!systemLocked && interface->isArmPressed())
+   if (LaunchInterlock::fromReady(inputMask(), isSystemLocked()) == State::ARMED)
    {
       enter(State::ARMED);
+      return;
    }
-}
 
-void RocketController::updateArmed(uint32_t now)
-{
-   if (!systemLocked && !interface->isArmPressed())
+   // Holding RESET toggles static-fire mode (once per press)
+   if (!interface->isResetPressed())
    {
-      enter(State::READY);
-      return;
+      resetReleased  = true;
+      resetHeldSince.set(0);
    }
-
-   if (!systemLocked && interface->isLaunchPressed())
+   else if (resetReleased)
    {
-      if (launchHeldSince == 0)
-         launchHeldSince = now;
-      if (now - launchHeldSince >= 250)
+      if (resetHeldSince.get() == 0)
+         resetHeldSince.set(now);
+      if (now - resetHeldSince.get() >= STATIC_FIRE_HOLD_MS)
       {
-         enter(State::LAUNCH_COUNTDOWN);
+         resetReleased = false;
+         setStaticFireMode(!config.staticFire);
+         interface->lcdSetCursor(0, 0);
+         interface->lcdPrint(config.staticFire ? "READY STATIC    " : "READY           ");
       }
    }
-   else
-   {
-      launchHeldSince = 0;
-   }
 }
 
-void RocketController::updateLaunchCountdown(uint32_t now)
+void RocketController::updateArmed(uint32_t now)
 {
-   if (!systemLocked && !interface->isArmPressed())
-   {
-      enter(State::FAULT); // interlock change -> fault
-      return;
-   }
+   uint32_t    heldSince = launchHeldSince.get();
+   const State next =
+       LaunchInterlock::fromArmed(inputMask(), isSystemLocked(), now, heldSince);
+   launchHeldSince.set(heldSince);
+   if (next != State::ARMED)
+      enter(next);
+}
 
-   if (!systemLocked && !interface->isLaunchPressed())
+void RocketController::updateLaunchCountdown(uint32_t now)
+{
+   // Interlock change -> FAULT, early release -> ABORT
+   const State next =
+       LaunchInterlock::fromCountdown(inputMask(), isSystemLocked(), now, enteredAt.get());
+   if (next == State::FAULT || next == State::ABORT)
    {
-      enter(State::ABORT); // early release -> abort
+      enter(next);
       return;
    }
 
    // Update countdown display every 250ms
-   static uint32_t lastUpd = 0;
-   if (now - lastUpd > 250)
+   if (now - lastDisplayUpdate > 250)
    {
-      lastUpd               = now;
-      const uint32_t held   = now - enteredAt;
+      lastDisplayUpdate     = now;
+      const uint32_t held   = now - enteredAt.get();
       long           remain = (long)HOLD_TO_LAUNCH_MS - (long)held;
       if (remain < 0)
          remain = 0;
@@ -298,7 +522,7 @@ void RocketController::updateLaunchCountdown(uint32_t now)
       interface->lcdPrint("s           ");
    }
 
-   if (now - enteredAt >= HOLD_TO_LAUNCH_MS)
+   if (next == State::LAUNCHING)
    {
       enter(State::LAUNCHING);
    }
@@ -306,7 +530,11 @@ void RocketController::updateLaunchCountdown(uint32_t now)
 
 void RocketController::updateLaunching(uint32_t now)
 {
-   if ((long)(now - deadline) >= 0)
+   // A fire is only clean if ARM stayed closed for the whole pulse
+   if (!interface->isArmPressed())
+      cleanFire = false;
+
+   if ((int32_t)(now - deadline.get()) >= 0)
    {
       setOutputs(false, false, false, false); // ensure relay & lamp off
       enter(State::COOLDOWN);
@@ -315,15 +543,34 @@ void RocketController::updateLaunching(uint32_t now)
 
 void RocketController::updateCooldown(uint32_t now)
 {
-   if ((long)(now - deadline) >= 0)
+   if ((int32_t)(now - deadline.get()) < 0)
+      return;
+
+   if (!config.rangeMode || !cleanFire)
    {
       enter(State::FAULT); // requires disarm + reset to clear
+      return;
+   }
+
+   // Range mode: clean fire only needs a disarm to be ready again
+   if (interface->isArmPressed())
+   {
+      if (now - lastDisplayUpdate > 250)
+      {
+         lastDisplayUpdate = now;
+         interface->lcdSetCursor(0, 1);
+         interface->lcdPrint("Disarm to reset ");
+      }
+   }
+   else
+   {
+      enter(State::READY);
    }
 }
 
 void RocketController::updateAbort(uint32_t now)
 {
-   if ((long)(now - deadline) >= 0)
+   if ((int32_t)(now - deadline.get()) >= 0)
    {
       if (interface->isArmPressed())
       {
@@ -339,19 +586,18 @@ void RocketController::updateAbort(uint32_t now)
 void RocketController::updateFault(uint32_t now)
 {
    // Only exit if Arm OFF and Reset held for ≥2.5s and no active fault
-   if (!systemLocked && !interface->isArmPressed())
+   if (!isSystemLocked() && !interface->isArmPressed())
    {
       if (interface->isResetPressed())
       {
-         if (resetHeldSince == 0)
-            resetHeldSince = now;
+         if (resetHeldSince.get() == 0)
+            resetHeldSince.set(now);
 
          // Update reset countdown display
-         static uint32_t lastUpd = 0;
-         if (now - lastUpd > 250)
+         if (now - lastDisplayUpdate > 250)
          {
-            lastUpd     = now;
-            long remain = (long)RESET_HOLD_MS - (long)(now - resetHeldSince);
+            lastDisplayUpdate = now;
+            long remain = (long)RESET_HOLD_MS - (long)(now - resetHeldSince.get());
             if (remain < 0)
                remain = 0;
             interface->lcdSetCursor(0, 1);
@@ -360,21 +606,21 @@ void RocketController::updateFault(uint32_t now)
             interface->lcdPrint("s               ");
          }
 
-         if (now - resetHeldSince >= RESET_HOLD_MS && !globalFaultActive())
+         if (now - resetHeldSince.get() >= RESET_HOLD_MS && !globalFaultActive())
          {
             enter(State::READY);
          }
       }
       else
       {
-         resetHeldSince = 0;
+         resetHeldSince.set(0);
       }
    }
    else
    {
       interface->lcdSetCursor(0, 1);
       interface->lcdPrint("Disarm & Reset ");
-      resetHeldSince = 0;
+      resetHeldSince.set(0);
    }
 }
 
@@ -390,7 +636,7 @@ void RocketController::updateBuzzer(uint32_t now)
       if (!buzzer.inGap)
       {
          if (n.freq > 0)
-            interface->tone(9, n.freq, n.ms); // PIN_BUZZER
+            interface->toneTimer(9, n.freq, n.timer); // PIN_BUZZER
          else
             interface->noTone(9);
          buzzer.stepDeadline = now + n.ms;
@@ -403,7 +649,7 @@ void RocketController::updateBuzzer(uint32_t now)
       return;
    }
 
-   if ((long)(now - buzzer.stepDeadline) >= 0)
+   if ((int32_t)(now - buzzer.stepDeadline) >= 0)
    {
       if (!buzzer.inGap && n.gap_ms > 0)
       {
@@ -429,6 +675,213 @@ void RocketController::updateBuzzer(uint32_t now)
    }
 }
 
+// Static-fire capture
+void RocketController::startCapture()
+{
+   capture.begin();
+   captureStart  = enteredAt.get();
+   dumpIndex     = 0;
+   captureRateHz = interface->startLoadCell(&capture);
+   dumpPhase     = DUMP_START;
+}
+
+void RocketController::stopCapture()
+{
+   interface->stopLoadCell();
+   interface->beginAtomic();
+   capture.end();
+   interface->endAtomic();
+}
+
+bool RocketController::sendFrame(uint8_t type, const uint8_t* payload, uint8_t len)
+{
+   if (interface->serialWritable() < FRAME_OVERHEAD + len)
+      return false; // never block the loop on the serial port
+   uint8_t frame[FRAME_OVERHEAD + FRAME_MAX_PAYLOAD];
+   interface->serialWrite(frame, encodeFrame(frame, type, payload, len));
+   return true;
+}
+
+void RocketController::serviceCaptureDump()
+{
+   uint8_t payload[4 + 3 * CAPTURE_FRAME_SAMPLES];
+
+   switch (dumpPhase)
+   {
+      case DUMP_START:
+      {
+         uint8_t* p = framePutU16(payload, captureRateHz);
+         *p++       = 3;
+         p          = framePutU32(p, captureStart);
+         if (sendFrame(FRAME_CAPTURE_START, payload, (uint8_t)(p - payload)))
+            dumpPhase = DUMP_DATA;
+         break;
+      }
+
+      case DUMP_DATA:
+      {
+         // While firing, only drain what the ring could not hold much longer
+         interface->beginAtomic();
+         const uint16_t pending   = capture.available();
+         const bool     capturing = capture.isCapturing();
+         interface->endAtomic();
+         if (capturing && pending < LoadCellCapture::CAPACITY / 2)
+            break;
+         if (pending == 0)
+         {
+            dumpPhase = DUMP_END;
+            break;
+         }
+
+         const uint8_t n = pending < CAPTURE_FRAME_SAMPLES ? (uint8_t)pending : CAPTURE_FRAME_SAMPLES;
+         if (interface->serialWritable() < FRAME_OVERHEAD + 4 + 3 * n)
+            break;
+         int32_t samples[CAPTURE_FRAME_SAMPLES];
+         interface->beginAtomic();
+         capture.read(samples, n);
+         interface->endAtomic();
+
+         uint8_t* p = framePutU32(payload, dumpIndex);
+         for (uint8_t i = 0; i < n; i++)
+            p = framePutU24(p, (uint32_t)samples[i]);
+         sendFrame(FRAME_CAPTURE_DATA, payload, (uint8_t)(p - payload));
+         dumpIndex += n;
+         break;
+      }
+
+      case DUMP_END:
+      {
+         uint8_t* p = framePutU32(payload, capture.captured());
+         p          = framePutU32(p, capture.dropped());
+         if (sendFrame(FRAME_CAPTURE_END, payload, (uint8_t)(p - payload)))
+            dumpPhase = DUMP_IDLE;
+         break;
+      }
+
+      case DUMP_IDLE:
+         break;
+   }
+}
+
+// Raw input windows: freeze on a debounced edge or on entering ABORT/FAULT, then send the
+// window a frame per update and rearm once it is all out
+void RocketController::serviceRawCapture(uint32_t now, State before)
+{
+   static_assert(RAW_WINDOW_HEADER + RAW_FRAME_BYTES <= FRAME_MAX_PAYLOAD, "'R' frame too long");
+
+   const State        state  = getState();
+   const uint8_t      inputs = inputMask();
+   RawCapture::Reason why    = RawCapture::NONE;
+   if (state != before && state == State::ABORT)
+      why = RawCapture::ABORT;
+   else if (state != before && state == State::FAULT)
+      why = RawCapture::FAULT;
+   else if (inputs != rawInputsLast)
+      why = RawCapture::EDGE;
+   rawInputsLast = inputs;
+   if (why != RawCapture::NONE)
+   {
+      interface->beginAtomic();
+      rawCapture.trigger(why, now, (uint8_t)state);
+      interface->endAtomic();
+   }
+
+   // The tick leaves a frozen window alone, so it is read without masking the tick
+   if (!rawCapture.isFrozen())
+      return;
+   const uint16_t total = rawCapture.samples();
+   const uint16_t left  = (uint16_t)(total - rawDumpAt);
+   const uint8_t  n     = left < 2 * RAW_FRAME_BYTES ? (uint8_t)left : 2 * RAW_FRAME_BYTES;
+   const uint8_t  bytes = (uint8_t)((n + 1) / 2);
+   if (interface->serialWritable() < FRAME_OVERHEAD + RAW_WINDOW_HEADER + bytes)
+      return;
+
+   uint8_t  payload[RAW_WINDOW_HEADER + RAW_FRAME_BYTES];
+   uint8_t* p = framePutU32(payload, rawCapture.triggerMs());
+   *p++       = rawCapture.reason();
+   *p++       = rawCapture.triggerState();
+   p          = framePutU16(p, rawRateHz);
+   p          = framePutU16(p, rawCapture.preSamples());
+   p          = framePutU16(p, total);
+   p          = framePutU16(p, rawCapture.missed());
+   p          = framePutU16(p, rawDumpAt);
+   for (uint8_t i = 0; i < n; i += 2)
+   {
+      const uint8_t low  = rawCapture.level((uint16_t)(rawDumpAt + i));
+      const uint8_t high = i + 1 < n ? rawCapture.level((uint16_t)(rawDumpAt + i + 1)) : 0;
+      *p++               = (uint8_t)(low | (high << 4));
+   }
+   sendFrame(FRAME_RAW_WINDOW, payload, (uint8_t)(p - payload));
+
+   rawDumpAt = (uint16_t)(rawDumpAt + n);
+   if (rawDumpAt < total)
+      return;
+   rawDumpAt = 0;
+   rawWindows++;
+   interface->beginAtomic();
+   rawCapture.rearm();
+   interface->endAtomic();
+}
+
+uint8_t RocketController::inputMask() const
+{
+   return (interface->isArmPressed() ? INPUT_BIT_ARM : 0) |
+          (interface->isResetPressed() ? INPUT_BIT_RESET : 0) |
+          (interface->isLaunchPressed() ? INPUT_BIT_LAUNCH : 0);
+}
+
+// Telemetry
+TelemetrySample RocketController::telemetrySnapshot(uint32_t now) const
+{
+   TelemetrySample s;
+   s.ms     = now;
+   s.inputs = inputMask();
+
+   static const uint8_t OUTPUT_PINS[] = {5, 6, 7, 8}; // PIN_LED_READY .. PIN_RELAY
+   for (uint8_t i = 0; i < sizeof(OUTPUT_PINS); i++)
+   {
+      if (interface->digitalRead(OUTPUT_PINS[i]) == HIGH)
+         s.outputs |= (uint8_t)(TELEMETRY_OUT_READY << i);
+   }
+   const AuxScheduler::Config& auxConfig = aux.getConfig();
+   for (uint8_t i = 0; i < auxConfig.count; i++)
+   {
+      if (interface->digitalRead(auxConfig.channels[i].pin) == HIGH)
+         s.outputs |= (uint8_t)(TELEMETRY_OUT_AUX0 << i);
+   }
+
+   s.state = (uint8_t)getState();
+   s.flags = (config.rangeMode ? TELEMETRY_FLAG_RANGE : 0) |
+             (config.staticFire ? TELEMETRY_FLAG_STATIC : 0);
+   return s;
+}
+
+void RocketController::serviceTelemetry(uint32_t now)
+{
+   TelemetrySample s     = telemetrySnapshot(now);
+   const bool      fresh = !sameTelemetry(s, telemetryLast);
+   telemetryLast         = s;
+   if (fresh)
+      telemetryDirty = true;
+   if (!telemetryDirty && now - telemetryAt < TELEMETRY_PERIOD_MS)
+      return;
+
+   // A full port loses this change; the count tells the receiver its replay is off
+   s.seq  = telemetrySeq;
+   s.lost = telemetryLost;
+   uint8_t payload[TELEMETRY_PAYLOAD];
+   if (!sendFrame(FRAME_TELEMETRY, payload, encodeTelemetry(payload, s)))
+   {
+      if (fresh && telemetryLost < 255)
+         telemetryLost++;
+      return;
+   }
+   telemetrySeq++;
+   telemetryLost  = 0;
+   telemetryDirty = false;
+   telemetryAt    = now;
+}
+
 // Safety check methods
 bool RocketController::globalFaultActive() const
 {
@@ -443,13 +896,89 @@ bool RocketController::checkStartupSafety() const
             interface->isLaunchPressed());
 }
 
+void RocketController::verifySafety(uint32_t now)
+{
+   const SafetyMonitor::Violation v =
+       monitor.observe(getState() == State::LAUNCH_COUNTDOWN, getState() == State::LAUNCHING,
+                       interface->digitalRead(8) == HIGH, // PIN_RELAY
+                       interface->digitalRead(7) == HIGH, // PIN_LAUNCH_LIGHT
+                       interface->isArmPressed(), now);
+   if (v == SafetyMonitor::Violation::NONE)
+      return;
+
+   // Property broken: force everything safe and latch FAULT
+   lastViolation = v;
+   setOutputs(false, false, false, false);
+   // Logged once per fault: a welded relay breaks the property on every pass after this
+   if (getState() != State::FAULT)
+   {
+      enterFault("FAULT: MONITOR");
+      recordFault((uint8_t)v);
+   }
+}
+
+bool RocketController::criticalFieldsIntact() const
+{
+   if (!stateCode.intact() || !deadline.intact() || !lockCode.intact())
+      return false;
+   if (!enteredAt.intact() || !launchHeldSince.intact() || !resetHeldSince.intact())
+      return false;
+   if (lockCode.get() != LOCKED_CODE && lockCode.get() != UNLOCKED_CODE)
+      return false;
+   for (uint8_t i = 0; i < STATE_COUNT; i++)
+   {
+      if (STATE_CODES[i] == stateCode.get())
+         return true;
+   }
+   return false;
+}
+
+void RocketController::integrityFault()
+{
+   // Rebuild the critical timers from a known-safe value on every failing pass
+   deadline.set(0);
+   launchHeldSince.set(0);
+   // Logged once per fault: a damaged region fails every scrubber pass until it is resealed
+   if (getState() == State::FAULT)
+      return;
+
+   // Relay path first
+   setOutputs(false, false, false, false);
+   if (integrityFaults < 255)
+      integrityFaults++;
+   enterFault("FAULT: RAM");
+   recordFault(LAUNCH_LOG_FAULT_RAM);
+}
+
+void RocketController::enterFault(const char* headline)
+{
+   faultHeadline = headline;
+   enter(State::FAULT);
+}
+
+void RocketController::recordFault(uint8_t cause)
+{
+   if (launchLog.faults != 0xFFFF)
+      launchLog.faults++;
+   launchLog.lastViolation = cause;
+   logDirty                = logStorage;
+}
+
+// Queue the counters; a full queue just means trying again next pass
+void RocketController::persistLog()
+{
+   uint8_t raw[LAUNCH_LOG_BYTES];
+   encodeLaunchLog(raw, launchLog);
+   logDirty = !interface->persist(LAUNCH_LOG_ADDR, raw, sizeof(raw));
+}
+
 // Helper methods
 void RocketController::setOutputs(bool readyLed, bool armedLed, bool launchLamp, bool relayOn)
 {
    interface->digitalWrite(5, readyLed ? HIGH : LOW);   // PIN_LED_READY
    interface->digitalWrite(6, armedLed ? HIGH : LOW);   // PIN_LED_ARMED
    interface->digitalWrite(7, launchLamp ? HIGH : LOW); // PIN_LAUNCH_LIGHT
-   interface->digitalWrite(8, relayOn ? HIGH : LOW);    // PIN_RELAY
+   interface->relayWrite(8, relayOn);                   // PIN_RELAY
 }
 
 void RocketController::updateLCD(const char* line1, const char* line2)
@@ -3,6 +3,14 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "ToneTimer.h"
+#include "SafetyMonitor.h"
+#include "RamIntegrity.h"
+#include "AuxScheduler.h"
+#include "LoadCellCapture.h"
+#include "RawCapture.h"
+#include "Telemetry.h"
+#include "LaunchLog.h"
 
 // Forward declarations for hardware interface
 class ArduinoInterface;
@@ -21,12 +29,18 @@ enum class State
    FAULT
 };
 
-// Buzzer note structure
+// Buzzer note structure (timer divisor is resolved at compile time from freq)
 struct BuzzNote
 {
-   uint16_t freq;
-   uint16_t ms;
-   uint16_t gap_ms;
+   uint16_t  freq;
+   uint16_t  ms;
+   uint16_t  gap_ms;
+   ToneTimer timer;
+
+   constexpr BuzzNote(uint16_t freq, uint16_t ms, uint16_t gap_ms)
+       : freq(freq), ms(ms), gap_ms(gap_ms), timer(toneTimerFor(freq))
+   {
+   }
 };
 
 // Buzzer player for non-blocking audio
@@ -52,25 +66,123 @@ class RocketController
    void  update(uint32_t now);
    void  enter(State newState);
 
-   // State queries
-   State getState() const
+   // State queries (decoded from redundant storage; corruption reads as FAULT / locked)
+   State getState() const;
+   bool  isSystemLocked() const;
+
+   bool isArmed() const
    {
-      return state;
+      return getState() == State::ARMED;
    }
 
-   bool isSystemLocked() const
+   bool isLaunching() const
    {
-      return systemLocked;
+      return getState() == State::LAUNCHING;
    }
 
-   bool isArmed() const
+   uint8_t getIntegrityFaults() const
    {
-      return state == State::ARMED;
+      return integrityFaults;
    }
 
-   bool isLaunching() const
+   // Auxiliary output pulsed at offsetMs from ignition (negative = before the relay closes)
+   bool addAuxChannel(uint8_t pin, int16_t offsetMs, uint16_t pulseMs);
+
+   const AuxScheduler& getAux() const
+   {
+      return aux;
+   }
+
+   // Static-fire mode: thrust is captured during LAUNCHING and dumped over serial afterwards
+   void setStaticFireMode(bool enabled);
+
+   bool isStaticFireMode() const
+   {
+      return config.staticFire;
+   }
+
+   const LoadCellCapture& getCapture() const
+   {
+      return capture;
+   }
+
+   bool isDumpingCapture() const
+   {
+      return dumpPhase != DUMP_IDLE;
+   }
+
+   // Raw input forensics: the undebounced inputs around every debounced edge and every
+   // ABORT or FAULT entry, sent as 'R' frames; false if the board cannot sample them
+   bool setRawCapture(bool enabled);
+
+   bool isRawCaptureEnabled() const
+   {
+      return rawRateHz != 0;
+   }
+
+   const RawCapture& getRawCapture() const
+   {
+      return rawCapture;
+   }
+
+   // Windows sent in full since raw capture was enabled
+   uint16_t getRawWindowsSent() const
+   {
+      return rawWindows;
+   }
+
+   // Telemetry: a 'T' frame on every observable change and at least every TELEMETRY_PERIOD_MS
+   void setTelemetry(bool enabled);
+
+   bool isTelemetryEnabled() const
+   {
+      return config.telemetry;
+   }
+
+   // What a telemetry sample taken now would report (seq and lost left at 0)
+   TelemetrySample telemetrySnapshot(uint32_t now) const;
+
+   // Relay pulse length, clamped to MIN_RELAY_PULSE_MS .. RELAY_ON_MS (size it with igniter_sweep)
+   void setRelayPulseMs(uint16_t ms);
+
+   uint16_t getRelayPulseMs() const
+   {
+      return config.relayPulseMs;
+   }
+
+   // Range mode: a clean fire returns to READY after a short cooldown and a disarm
+   void setRangeMode(bool enabled);
+
+   bool isRangeMode() const
    {
-      return state == State::LAUNCHING;
+      return config.rangeMode;
+   }
+
+   // Launch cycle statistics (ARM from READY until READY again after firing)
+   uint16_t getLaunchCount() const
+   {
+      return launchCount;
+   }
+
+   uint32_t getLastCycleMs() const
+   {
+      return lastCycleMs;
+   }
+
+   uint32_t getTotalCycleMs() const
+   {
+      return totalCycleMs;
+   }
+
+   SafetyMonitor::Violation getLastViolation() const
+   {
+      return lastViolation;
+   }
+
+   // Lifetime counters, loaded from EEPROM at construction and saved as they change
+   const LaunchLog& getLaunchLog() const
+   {
+      return launchLog;
    }
 
    // Input handling
@@ -83,35 +195,112 @@ class RocketController
    void stopBuzzer();
 
    // Timing constants
+   static constexpr uint32_t LAUNCH_HOLD_MS         = 250; // LAUNCH held in ARMED to count down
    static constexpr uint32_t HOLD_TO_LAUNCH_MS      = 5000;
-   static constexpr uint32_t RELAY_ON_MS            = 5000;
+   static constexpr uint32_t RELAY_ON_MS            = 5000; // default and longest pulse
+   static constexpr uint32_t MIN_RELAY_PULSE_MS     = 50;
    static constexpr uint32_t COOLDOWN_MS            = 5000;
+   static constexpr uint32_t RANGE_COOLDOWN_MS      = 2000;
+   static constexpr uint32_t STATIC_FIRE_HOLD_MS    = 2000; // RESET held in READY toggles it
+   static constexpr uint8_t  CAPTURE_FRAME_SAMPLES  = 16;
+   static constexpr uint8_t  RAW_FRAME_BYTES        = 48; // 96 raw samples per 'R' frame
+   static constexpr uint32_t TELEMETRY_PERIOD_MS    = 20;
    static constexpr uint32_t ABORT_INHIBIT_MS       = 1500;
    static constexpr uint32_t RESET_HOLD_MS          = 2500;
    static constexpr uint8_t  STARTUP_CHECKS_COUNT   = 20;
    static constexpr uint32_t STARTUP_TOTAL_TIME_MS  = 5000;
    static constexpr uint32_t STARTUP_CHECK_INTERVAL = STARTUP_TOTAL_TIME_MS / STARTUP_CHECKS_COUNT;
 
+   // Background RAM check budget
+   static constexpr uint8_t  SCRUB_BYTES_PER_TICK   = 4;
+
  private:
    // Hardware interface
    ArduinoInterface* interface;
 
-   // State machine
-   State             state             = State::STARTUP;
-   uint32_t          enteredAt         = 0;
-   uint32_t          deadline          = 0;
-   uint32_t          launchHeldSince   = 0;
-   uint32_t          resetHeldSince    = 0;
-   uint8_t           startupCheckIndex = 0;
-   uint32_t          lastCheckTime     = 0;
-   uint32_t          completionTime    = 0;
-   bool              startupComplete   = false;
+   // State machine: the state and every time that gates the relay or a fault reset are kept
+   // with complemented copies, as the scrubber only covers data that never changes
+   Redundant<uint8_t>       stateCode;
+   Redundant<uint32_t>      enteredAt;
+   Redundant<uint32_t>      deadline;
+   Redundant<uint32_t>      launchHeldSince;
+   Redundant<uint32_t>      resetHeldSince;
+   uint8_t                  startupCheckIndex = 0;
+   uint32_t                 lastCheckTime     = 0;
+   uint32_t                 completionTime    = 0;
+   bool                     startupComplete   = false;
+   uint32_t                 lastDisplayUpdate = 0;
 
    // System state
-   bool              systemLocked      = true;
+   Redundant<uint8_t>       lockCode;
+
+   // Settings changed only through setters (covered by the RAM scrubber)
+   struct Config
+   {
+      uint16_t relayPulseMs = RELAY_ON_MS;
+      bool     rangeMode    = false;
+      bool     staticFire   = false;
+      bool     telemetry    = false;
+   } config;
+
+   // Camera / strobe outputs timed from ignition
+   AuxScheduler             aux;
+   bool                     auxTimerDriven    = false;
+
+   // Static-fire capture and its serial dump
+   enum DumpPhase : uint8_t
+   {
+      DUMP_IDLE,
+      DUMP_START,
+      DUMP_DATA,
+      DUMP_END
+   };
+
+   LoadCellCapture          capture;
+   uint16_t                 captureRateHz     = 0;
+   uint32_t                 captureStart      = 0;
+   uint32_t                 dumpIndex         = 0;
+   DumpPhase                dumpPhase         = DUMP_IDLE;
+   bool                     resetReleased     = false;
+
+   // Raw input windows and their serial dump
+   RawCapture               rawCapture;
+   uint16_t                 rawRateHz         = 0;
+   uint16_t                 rawDumpAt         = 0; // next sample of the frozen window to send
+   uint16_t                 rawWindows        = 0;
+   uint8_t                  rawInputsLast     = 0;
+
+   // Telemetry stream (last observed sample, so changes are sent as they happen)
+   TelemetrySample          telemetryLast;
+   uint32_t                 telemetryAt       = 0;
+   uint16_t                 telemetrySeq      = 0;
+   uint8_t                  telemetryLost     = 0;
+   bool                     telemetryDirty    = false;
+
+   // Launch cycle tracking
+   uint32_t                 cycleStart        = 0;
+   bool                     cycleFired        = false;
+   bool                     cleanFire         = false;
+   uint16_t                 launchCount       = 0;
+   uint32_t                 lastCycleMs       = 0;
+   uint32_t                 totalCycleMs      = 0;
+
+   // Lifetime counters; queued for EEPROM at the end of update(), after every output
+   LaunchLog                launchLog;
+   bool                     logStorage        = false; // the interface has EEPROM
+   bool                     logDirty          = false;
+
+   // RAM integrity
+   IncrementalCrc           scrubber;
+   uint8_t                  integrityFaults   = 0;
 
    // Buzzer control
-   BuzzPlayer        buzzer;
+   BuzzPlayer               buzzer;
+
+   // Runtime verification
+   SafetyMonitor            monitor;
+   SafetyMonitor::Violation lastViolation     = SafetyMonitor::Violation::NONE;
+   const char*              faultHeadline     = nullptr; // FAULT screen's first line, once
 
    // Internal methods
    void              updateBuzzer(uint32_t now);
@@ -125,9 +314,33 @@ class RocketController
    void              updateAbort(uint32_t now);
    void              updateFault(uint32_t now);
 
+   // FAULT entry with the cause on the first line, in the one redraw enter() does
+   void              enterFault(const char* headline);
+
+   // Anomalous FAULT entry (monitor, RAM or global fault) for the lifetime log; cause is a
+   // SafetyMonitor::Violation or a LAUNCH_LOG_FAULT_* code
+   void              recordFault(uint8_t cause);
+   void              persistLog();
+
+   // Static-fire capture
+   void              startCapture();
+   void              stopCapture();
+   void              serviceCaptureDump();
+   bool              sendFrame(uint8_t type, const uint8_t* payload, uint8_t len);
+   void              serviceRawCapture(uint32_t now, State before);
+   uint8_t           inputMask() const;
+   void              serviceTelemetry(uint32_t now);
+
    // Safety checks
    bool              globalFaultActive() const;
    bool              checkStartupSafety() const;
+   void              verifySafety(uint32_t now);
+   bool              criticalFieldsIntact() const;
+   void              integrityFault();
+
+   // Redundant field writers
+   void              setState(State newState);
+   void              setLocked(bool locked);
 
    // State transition helpers
    void              transitionTo(State newState);
@@ -0,0 +1,136 @@
+#include "SafetyMonitor.h"
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#define MONITOR_TABLE_ATTR    PROGMEM
+#define MONITOR_TABLE_READ(p) pgm_read_byte(p)
+#else
+#define MONITOR_TABLE_ATTR
+#define MONITOR_TABLE_READ(p) (*(p))
+#endif
+
+namespace
+{
+   // Observation symbol bits
+   constexpr uint8_t OBS_RELAY     = 0x01;
+   constexpr uint8_t OBS_LAMP      = 0x02;
+   constexpr uint8_t OBS_ARM       = 0x04;
+   constexpr uint8_t OBS_COUNTDOWN = 0x08;
+   constexpr uint8_t OBS_LAUNCHING = 0x10;
+   constexpr uint8_t SYMBOLS       = 32;
+
+   // Automaton phases
+   constexpr uint8_t PH_IDLE   = 0; // no launch in progress
+   constexpr uint8_t PH_HOLD   = 1; // countdown with ARM held since it began
+   constexpr uint8_t PH_BROKEN = 2; // countdown during which ARM dropped
+   constexpr uint8_t PH_FIRING = 3; // LAUNCHING reached through a valid hold
+   constexpr uint8_t PHASES    = 4;
+
+   // Table entry: next phase (bits 0-1), violation (bits 2-4), actions (bits 5-6)
+   constexpr uint8_t ACT_START_TIMER = 0x20;
+   constexpr uint8_t ACT_CHECK_HOLD  = 0x40;
+
+   constexpr uint8_t entry(uint8_t next, SafetyMonitor::Violation v = SafetyMonitor::Violation::NONE,
+                           uint8_t actions = 0)
+   {
+      return (uint8_t)(next | ((uint8_t)v << 2) | actions);
+   }
+
+   constexpr bool has(uint8_t symbol, uint8_t bit)
+   {
+      return (symbol & bit) != 0;
+   }
+
+   // The declared property set, evaluated for one (phase, symbol) pair
+   constexpr uint8_t step(uint8_t phase, uint8_t symbol)
+   {
+      using V = SafetyMonitor::Violation;
+
+      // P4: lamp mirrors relay
+      if (has(symbol, OBS_RELAY) != has(symbol, OBS_LAMP))
+         return entry(PH_IDLE, V::LAMP_MISMATCH);
+
+      // P1: relay only in LAUNCHING
+      if (has(symbol, OBS_RELAY) && !has(symbol, OBS_LAUNCHING))
+         return entry(PH_IDLE, V::RELAY_OUTSIDE_LAUNCHING);
+
+      // P3: LAUNCHING only through an unbroken hold (duration checked on the transition)
+      if (has(symbol, OBS_LAUNCHING))
+      {
+         if (phase == PH_FIRING)
+            return entry(PH_FIRING);
+         if (phase == PH_HOLD)
+            return entry(PH_FIRING, V::NONE, ACT_CHECK_HOLD | ACT_START_TIMER);
+         return entry(PH_IDLE, V::LAUNCH_WITHOUT_HOLD);
+      }
+
+      if (has(symbol, OBS_COUNTDOWN))
+      {
+         if (!has(symbol, OBS_ARM))
+            return entry(PH_BROKEN);
+         if (phase == PH_HOLD || phase == PH_BROKEN)
+            return entry(phase);
+         return entry(PH_HOLD, V::NONE, ACT_START_TIMER);
+      }
+
+      return entry(PH_IDLE);
+   }
+
+   struct MonitorTable
+   {
+      uint8_t next[PHASES][SYMBOLS];
+   };
+
+   constexpr MonitorTable buildTable()
+   {
+      MonitorTable t{};
+      for (uint8_t p = 0; p < PHASES; p++)
+         for (uint8_t s = 0; s < SYMBOLS; s++)
+            t.next[p][s] = step(p, s);
+      return t;
+   }
+
+   constexpr MonitorTable TABLE_VALUES = buildTable();
+
+   // Sanity checks on the compiled automaton
+   static_assert((TABLE_VALUES.next[PH_IDLE][OBS_RELAY | OBS_LAMP | OBS_LAUNCHING] >> 2 & 0x07) ==
+                     (uint8_t)SafetyMonitor::Violation::LAUNCH_WITHOUT_HOLD,
+                 "LAUNCHING without a hold must trip the monitor");
+   static_assert((TABLE_VALUES.next[PH_HOLD][OBS_RELAY | OBS_LAMP | OBS_LAUNCHING] & 0x03) ==
+                     PH_FIRING,
+                 "a valid hold must allow LAUNCHING");
+   static_assert((TABLE_VALUES.next[PH_FIRING][OBS_RELAY] >> 2 & 0x07) ==
+                     (uint8_t)SafetyMonitor::Violation::LAMP_MISMATCH,
+                 "relay without lamp must trip the monitor");
+
+   const MonitorTable TABLE MONITOR_TABLE_ATTR = TABLE_VALUES;
+} // namespace
+
+void SafetyMonitor::reset()
+{
+   phase      = PH_IDLE;
+   phaseSince = 0;
+}
+
+SafetyMonitor::Violation SafetyMonitor::observe(bool inCountdown, bool inLaunching, bool relay,
+                                                bool lamp, bool armHeld, uint32_t now)
+{
+   const uint8_t symbol = (relay ? OBS_RELAY : 0) | (lamp ? OBS_LAMP : 0) |
+                          (armHeld ? OBS_ARM : 0) | (inCountdown ? OBS_COUNTDOWN : 0) |
+                          (inLaunching ? OBS_LAUNCHING : 0);
+   const uint8_t e      = MONITOR_TABLE_READ(&TABLE.next[phase][symbol]);
+
+   Violation     v      = (Violation)((e >> 2) & 0x07);
+   if ((e & ACT_CHECK_HOLD) && now - phaseSince < holdLimitMs)
+      v = Violation::LAUNCH_WITHOUT_HOLD;
+   if (e & ACT_START_TIMER)
+      phaseSince = now;
+
+   phase = v == Violation::NONE ? (e & 0x03) : PH_IDLE;
+
+   // P2: timed property, only meaningful while firing
+   if (phase == PH_FIRING && relay && now - phaseSince > relayLimitMs + RELAY_SLACK_MS)
+      v = Violation::RELAY_TOO_LONG;
+
+   return v;
+}
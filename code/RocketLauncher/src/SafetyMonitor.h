@@ -0,0 +1,52 @@
+#ifndef SAFETY_MONITOR_H
+#define SAFETY_MONITOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Runtime verification of the launch safety properties
+//
+//   P1  relay is only energised in LAUNCHING
+//   P2  relay is never on longer than the configured pulse (+ slack)
+//   P3  LAUNCHING is only reached after ARM was held through a full LAUNCH_COUNTDOWN
+//   P4  launch lamp mirrors the relay
+//
+// The properties are compiled into a transition table over (phase, observation
+// symbol) at build time, so each tick costs one table lookup and at most two
+// timer compares regardless of history.
+class SafetyMonitor
+{
+ public:
+   enum class Violation : uint8_t
+   {
+      NONE,
+      RELAY_OUTSIDE_LAUNCHING,
+      RELAY_TOO_LONG,
+      LAUNCH_WITHOUT_HOLD,
+      LAMP_MISMATCH
+   };
+
+   // Allowance for loop latency on top of the relay pulse
+   static constexpr uint32_t RELAY_SLACK_MS = 20;
+
+   void      reset();
+
+   // Feed one tick of observed state and outputs; returns the property broken on this tick
+   Violation observe(bool inCountdown, bool inLaunching, bool relay, bool lamp, bool armHeld,
+                     uint32_t now);
+
+   // Durations P2/P3 are checked against
+   void setLimits(uint32_t holdMs, uint32_t relayMs)
+   {
+      holdLimitMs  = holdMs;
+      relayLimitMs = relayMs;
+   }
+
+ private:
+   uint8_t  phase        = 0;
+   uint32_t phaseSince   = 0;
+   uint32_t holdLimitMs  = 0;
+   uint32_t relayLimitMs = 0;
+};
+
+#endif // SAFETY_MONITOR_H
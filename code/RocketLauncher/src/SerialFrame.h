@@ -0,0 +1,169 @@
+#ifndef SERIAL_FRAME_H
+#define SERIAL_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Crc16.h"
+
+// Binary frames on the serial port
+//
+//   A5 5A <type> <len> <payload: len bytes> <crc16 lo> <crc16 hi>
+//
+// The CRC (CCITT-FALSE) covers type, length and payload. Multi-byte payload
+// fields are little-endian. A receiver that loses sync simply hunts for the
+// next A5 5A, so frames can share the port with plain-text messages.
+static constexpr uint8_t FRAME_SYNC0         = 0xA5;
+static constexpr uint8_t FRAME_SYNC1         = 0x5A;
+static constexpr uint8_t FRAME_OVERHEAD      = 6;
+static constexpr uint8_t FRAME_MAX_PAYLOAD   = 64;
+
+// Frame types
+static constexpr uint8_t FRAME_CAPTURE_START = 'S'; // u16 rate Hz, u8 bytes/sample, u32 t0 ms
+static constexpr uint8_t FRAME_CAPTURE_DATA  = 'D'; // u32 first index, n x s24 samples
+static constexpr uint8_t FRAME_CAPTURE_END   = 'E'; // u32 samples, u32 dropped
+static constexpr uint8_t FRAME_TELEMETRY     = 'T'; // TelemetrySample (Telemetry.h)
+static constexpr uint8_t FRAME_RAW_WINDOW    = 'R'; // raw input window chunk, see below
+
+// 'R' payload: u32 trigger ms, u8 reason, u8 state, u16 rate Hz, u16 samples before the
+// trigger, u16 samples, u16 missed triggers, u16 first sample, then the chunk's samples
+// two to a byte (INPUT_BIT_* levels, the earlier sample in the low nibble)
+static constexpr uint8_t RAW_WINDOW_HEADER   = 16;
+
+static inline uint8_t* framePutU16(uint8_t* p, uint16_t v)
+{
+   p[0] = (uint8_t)v;
+   p[1] = (uint8_t)(v >> 8);
+   return p + 2;
+}
+
+static inline uint8_t* framePutU24(uint8_t* p, uint32_t v)
+{
+   p[0] = (uint8_t)v;
+   p[1] = (uint8_t)(v >> 8);
+   p[2] = (uint8_t)(v >> 16);
+   return p + 3;
+}
+
+static inline uint8_t* framePutU32(uint8_t* p, uint32_t v)
+{
+   return framePutU16(framePutU16(p, (uint16_t)v), (uint16_t)(v >> 16));
+}
+
+static inline uint16_t frameGetU16(const uint8_t* p)
+{
+   return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t frameGetU32(const uint8_t* p)
+{
+   return frameGetU16(p) | ((uint32_t)frameGetU16(p + 2) << 16);
+}
+
+// Sign-extended 24-bit sample
+static inline int32_t frameGetS24(const uint8_t* p)
+{
+   const uint32_t v = p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+   return (int32_t)(v ^ 0x800000u) - 0x800000;
+}
+
+// Wrap a payload into out (FRAME_OVERHEAD + len bytes); returns the frame length
+static inline uint8_t encodeFrame(uint8_t* out, uint8_t type, const uint8_t* payload, uint8_t len)
+{
+   out[0] = FRAME_SYNC0;
+   out[1] = FRAME_SYNC1;
+   out[2] = type;
+   out[3] = len;
+   for (uint8_t i = 0; i < len; i++)
+      out[4 + i] = payload[i];
+   const uint16_t crc = crc16(out + 2, (uint16_t)(len + 2));
+   framePutU16(out + 4 + len, crc);
+   return (uint8_t)(FRAME_OVERHEAD + len);
+}
+
+// Byte-at-a-time frame parser for the receiving side
+class FrameDecoder
+{
+ public:
+   // Returns true when a frame with a good CRC has just been completed
+   bool feed(uint8_t b)
+   {
+      switch (pos)
+      {
+         case 0:
+            pos = b == FRAME_SYNC0 ? 1 : 0;
+            return false;
+         case 1:
+            pos = b == FRAME_SYNC1 ? 2 : (b == FRAME_SYNC0 ? 1 : 0);
+            return false;
+         case 2:
+            frameType = b;
+            pos       = 3;
+            return false;
+         case 3:
+            if (b > FRAME_MAX_PAYLOAD)
+            {
+               errors++;
+               pos = 0;
+               return false;
+            }
+            len = b;
+            pos = 4;
+            return false;
+         default:
+            break;
+      }
+
+      const uint8_t i = (uint8_t)(pos - 4);
+      pos++;
+      if (i < len)
+      {
+         buf[i] = b;
+         return false;
+      }
+      if (i == len)
+      {
+         crcLo = b;
+         return false;
+      }
+
+      pos                 = 0;
+      const uint8_t hdr[] = {frameType, len};
+      const uint16_t crc  = crc16(buf, len, crc16(hdr, 2));
+      if (crc != (uint16_t)(crcLo | (b << 8)))
+      {
+         errors++;
+         return false;
+      }
+      return true;
+   }
+
+   uint8_t type() const
+   {
+      return frameType;
+   }
+
+   uint8_t length() const
+   {
+      return len;
+   }
+
+   const uint8_t* payload() const
+   {
+      return buf;
+   }
+
+   uint32_t errorCount() const
+   {
+      return errors;
+   }
+
+ private:
+   uint8_t  pos       = 0;
+   uint8_t  frameType = 0;
+   uint8_t  len       = 0;
+   uint8_t  crcLo     = 0;
+   uint32_t errors    = 0;
+   uint8_t  buf[FRAME_MAX_PAYLOAD];
+};
+
+#endif // SERIAL_FRAME_H
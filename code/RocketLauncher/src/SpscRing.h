@@ -0,0 +1,63 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+
+// Bounded single-producer / single-consumer queue without locks
+//
+// Each index is written by one side only; the release store publishing a slot
+// pairs with the acquire load on the other side, so no slot is read before it
+// is fully written. Head and tail sit on separate cache lines so the two
+// threads do not invalidate each other on every operation.
+// Needs <atomic>, so host tools and 32-bit boards only (not avr-gcc).
+template <typename T, size_t N> class SpscRing
+{
+   static_assert(N >= 2 && (N & (N - 1)) == 0, "capacity must be a power of two");
+
+ public:
+   // Producer side; false when full
+   bool push(const T& item)
+   {
+      const size_t head = this->head.load(std::memory_order_relaxed);
+      if (head - tailCache == N)
+      {
+         tailCache = tail.load(std::memory_order_acquire);
+         if (head - tailCache == N)
+            return false;
+      }
+      slots[head & (N - 1)] = item;
+      this->head.store(head + 1, std::memory_order_release);
+      return true;
+   }
+
+   // Producer side: pushes that will succeed at least
+   size_t space() const
+   {
+      return N - (head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire));
+   }
+
+   // Consumer side; false when empty
+   bool pop(T& item)
+   {
+      const size_t tail = this->tail.load(std::memory_order_relaxed);
+      if (tail == headCache)
+      {
+         headCache = head.load(std::memory_order_acquire);
+         if (tail == headCache)
+            return false;
+      }
+      item = slots[tail & (N - 1)];
+      this->tail.store(tail + 1, std::memory_order_release);
+      return true;
+   }
+
+ private:
+   alignas(64) std::atomic<size_t> head{0};
+   size_t tailCache = 0; // producer's last view of tail
+   alignas(64) std::atomic<size_t> tail{0};
+   size_t headCache = 0; // consumer's last view of head
+   alignas(64) T slots[N];
+};
+
+#endif // SPSC_RING_H
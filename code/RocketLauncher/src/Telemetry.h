@@ -0,0 +1,69 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "SerialFrame.h"
+
+// Output bits in a telemetry sample (pins as the controller last drove them)
+static constexpr uint8_t TELEMETRY_OUT_READY   = 0x01; // pin 5
+static constexpr uint8_t TELEMETRY_OUT_ARMED   = 0x02; // pin 6
+static constexpr uint8_t TELEMETRY_OUT_LAMP    = 0x04; // pin 7
+static constexpr uint8_t TELEMETRY_OUT_RELAY   = 0x08; // pin 8
+static constexpr uint8_t TELEMETRY_OUT_AUX0    = 0x10; // aux channels 0-3 in bits 4-7
+
+// Mode flags
+static constexpr uint8_t TELEMETRY_FLAG_RANGE  = 0x01;
+static constexpr uint8_t TELEMETRY_FLAG_STATIC = 0x02;
+
+static constexpr uint8_t TELEMETRY_PAYLOAD     = 11;
+
+// One controller update as seen from outside: the inputs it acted on and what it produced
+//
+// The controller sends a sample whenever any field changes and at least every
+// TELEMETRY_PERIOD_MS, so a host replaying the inputs can check every output
+// and state change at the millisecond it happened.
+struct TelemetrySample
+{
+   uint16_t seq     = 0;
+   uint32_t ms      = 0;
+   uint8_t  inputs  = 0; // INPUT_BIT_*, debounced
+   uint8_t  outputs = 0; // TELEMETRY_OUT_*
+   uint8_t  state   = 0; // State
+   uint8_t  flags   = 0; // TELEMETRY_FLAG_*
+   uint8_t  lost    = 0; // changes that could not be sent since the previous sample
+};
+
+// Same observable behaviour (sequence, time and loss count aside)
+static inline bool sameTelemetry(const TelemetrySample& a, const TelemetrySample& b)
+{
+   return a.inputs == b.inputs && a.outputs == b.outputs && a.state == b.state &&
+          a.flags == b.flags;
+}
+
+static inline uint8_t encodeTelemetry(uint8_t* p, const TelemetrySample& s)
+{
+   uint8_t* q = framePutU32(framePutU16(p, s.seq), s.ms);
+   *q++       = s.inputs;
+   *q++       = s.outputs;
+   *q++       = s.state;
+   *q++       = s.flags;
+   *q++       = s.lost;
+   return (uint8_t)(q - p);
+}
+
+static inline bool decodeTelemetry(const uint8_t* p, uint8_t len, TelemetrySample& s)
+{
+   if (len < TELEMETRY_PAYLOAD)
+      return false;
+   s.seq     = frameGetU16(p);
+   s.ms      = frameGetU32(p + 2);
+   s.inputs  = p[6];
+   s.outputs = p[7];
+   s.state   = p[8];
+   s.flags   = p[9];
+   s.lost    = p[10];
+   return true;
+}
+
+#endif // TELEMETRY_H
@@ -0,0 +1,62 @@
+#ifndef TONE_TIMER_H
+#define TONE_TIMER_H
+
+#include <stdint.h>
+
+// Clock feeding the tone timer. Arduino cores define F_CPU; the native build
+// assumes the 16 MHz UNO clock so the computed divisors match the AVR firmware.
+#ifdef F_CPU
+#define TONE_TIMER_CLOCK_HZ F_CPU
+#else
+#define TONE_TIMER_CLOCK_HZ 16000000UL
+#endif
+
+// Precomputed timer settings for one buzzer frequency
+// clockSelect is the Timer1 CS1[2:0] field (1 = clk/1, 2 = /8, 3 = /64, 4 = /256, 5 = /1024),
+// top is the OCR1A value for CTC mode with OC1A toggling on every compare match.
+// clockSelect == 0 means silence.
+struct ToneTimer
+{
+   uint8_t  clockSelect;
+   uint16_t top;
+};
+
+// Compile-time divisor search (C++11 constexpr so it also builds with the AVR toolchain)
+namespace ToneTimerCalc
+{
+   constexpr uint16_t prescaler(uint8_t clockSelect)
+   {
+      return clockSelect == 1   ? 1
+             : clockSelect == 2 ? 8
+             : clockSelect == 3 ? 64
+             : clockSelect == 4 ? 256
+                                : 1024;
+   }
+
+   // Timer ticks per half period, rounded to nearest
+   constexpr uint32_t halfPeriodTicks(uint32_t clockHz, uint16_t freq, uint8_t clockSelect)
+   {
+      return (clockHz + (uint32_t)prescaler(clockSelect) * freq) /
+             (2UL * prescaler(clockSelect) * freq);
+   }
+
+   constexpr uint16_t topFor(uint32_t ticks)
+   {
+      return ticks == 0 ? 0 : ticks > 65536UL ? 65535 : (uint16_t)(ticks - 1);
+   }
+
+   constexpr ToneTimer search(uint32_t clockHz, uint16_t freq, uint8_t clockSelect)
+   {
+      return (clockSelect >= 5 || halfPeriodTicks(clockHz, freq, clockSelect) <= 65536UL)
+                 ? ToneTimer{clockSelect, topFor(halfPeriodTicks(clockHz, freq, clockSelect))}
+                 : search(clockHz, freq, clockSelect + 1);
+   }
+} // namespace ToneTimerCalc
+
+// Smallest prescaler that fits the 16-bit compare register gives the best pitch accuracy
+constexpr ToneTimer toneTimerFor(uint16_t freq, uint32_t clockHz = TONE_TIMER_CLOCK_HZ)
+{
+   return freq == 0 ? ToneTimer{0, 0} : ToneTimerCalc::search(clockHz, freq, 1);
+}
+
+#endif // TONE_TIMER_H
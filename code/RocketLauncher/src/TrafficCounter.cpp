@@ -0,0 +1,165 @@
+#include "TrafficCounter.h"
+#include <stdio.h>
+#include <string.h>
+
+TrafficCounter::TrafficCounter(ArduinoInterface* hw) : hw(hw)
+{
+   memset(profile, 0, sizeof(profile));
+   memset(thisTick, 0, sizeof(thisTick));
+   memset(levels, LEVEL_UNKNOWN, sizeof(levels));
+   memset(shadow, 0, sizeof(shadow));
+}
+
+void TrafficCounter::beginTick(State state)
+{
+   Profile& done = profile[tickState];
+   for (uint8_t c = 0; c < CALL_COUNT; c++)
+   {
+      if (thisTick[c] > done.peak[c])
+         done.peak[c] = thisTick[c];
+      thisTick[c] = 0;
+   }
+   tickState = (uint8_t)state < STATES ? (uint8_t)state : 0;
+   profile[tickState].ticks++;
+}
+
+uint16_t TrafficCounter::peak(State state, Call call) const
+{
+   const uint16_t closed = profile[(uint8_t)state].peak[call];
+   if ((uint8_t)state == tickState && thisTick[call] > closed)
+      return thisTick[call];
+   return closed;
+}
+
+void TrafficCounter::lcdClear()
+{
+   bool blank = true;
+   for (uint8_t r = 0; r < LCD_ROWS; r++)
+   {
+      for (uint8_t c = 0; c < LCD_COLS; c++)
+         blank = blank && shadow[r][c] == ' ';
+   }
+   count(LCD_CLEAR, blank);
+   profile[tickState].lcdBytes++;
+   memset(shadow, ' ', sizeof(shadow));
+   cursorCol = 0;
+   cursorRow = 0;
+   hw->lcdClear();
+}
+
+void TrafficCounter::lcdSetCursor(uint8_t col, uint8_t row)
+{
+   count(LCD_SET_CURSOR, col == cursorCol && row == cursorRow);
+   profile[tickState].lcdBytes++;
+   cursorCol = col;
+   cursorRow = row;
+   hw->lcdSetCursor(col, row);
+}
+
+void TrafficCounter::lcdPrint(int number)
+{
+   char       digits[12];
+   char*      p         = digits + sizeof(digits);
+   const bool negative  = number < 0;
+   unsigned   magnitude = negative ? 0u - (unsigned)number : (unsigned)number;
+   *--p                 = '\0';
+   do
+   {
+      *--p = (char)('0' + magnitude % 10);
+      magnitude /= 10;
+   } while (magnitude);
+   if (negative)
+      *--p = '-';
+   lcdText(LCD_PRINT_NUMBER, p);
+   hw->lcdPrint(number);
+}
+
+// Characters past the visible columns, or at an unknown cursor, are never unchanged
+void TrafficCounter::lcdText(Call call, const char* text)
+{
+   Profile& p    = profile[tickState];
+   uint8_t  sent = 0;
+   uint8_t  same = 0;
+   for (; *text; text++)
+   {
+      sent++;
+      if (cursorRow < LCD_ROWS && cursorCol < LCD_COLS)
+      {
+         char& cell = shadow[cursorRow][cursorCol];
+         if (cell == *text)
+            same++;
+         cell = *text;
+      }
+      if (cursorCol != LEVEL_UNKNOWN)
+         cursorCol++;
+   }
+   count(call, sent > 0 && same == sent);
+   p.lcdBytes += sent;
+   p.lcdSame += same;
+}
+
+const char* TrafficCounter::callName(Call call)
+{
+   static const char* const NAMES[CALL_COUNT] = {
+       "digitalWrite", "digitalRead",    "pinMode",        "relayWrite",    "millis",
+       "delay",        "tone",           "noTone",         "lcdClear",      "lcdSetCursor",
+       "lcdPrint(text)", "lcdPrint(int)", "updateDebouncers", "is*Pressed",  "serial",
+       "persist",      "begin/endAtomic", "timers/captures"};
+   return call < CALL_COUNT ? NAMES[call] : "?";
+}
+
+// Calls per tick with two decimals, without floating point (not in every printf)
+static void perTick(char* out, size_t size, uint32_t calls, uint32_t ticks)
+{
+   if (ticks == 0)
+   {
+      snprintf(out, size, "-");
+      return;
+   }
+   const uint64_t hundredths = ((uint64_t)calls * 100 + ticks / 2) / ticks;
+   snprintf(out, size, "%lu.%02u", (unsigned long)(hundredths / 100),
+            (unsigned)(hundredths % 100));
+}
+
+void TrafficCounter::report(LineSink sink, const char* const* stateNames) const
+{
+   char line[72];
+   char rate[16];
+   for (uint8_t s = 0; s < STATES; s++)
+   {
+      const Profile& p     = profile[s];
+      uint32_t       total = 0;
+      for (uint8_t c = 0; c < CALL_COUNT; c++)
+         total += p.calls[c];
+      if (total == 0 && p.ticks == 0)
+         continue;
+
+      if (stateNames)
+         snprintf(line, sizeof(line), "traffic in %s: %lu ticks, %lu calls", stateNames[s],
+                  (unsigned long)p.ticks, (unsigned long)total);
+      else
+         snprintf(line, sizeof(line), "traffic in state %u: %lu ticks, %lu calls", s,
+                  (unsigned long)p.ticks, (unsigned long)total);
+      sink(line);
+      snprintf(line, sizeof(line), "  %-18s %10s %9s %6s %10s", "method", "calls", "per tick",
+               "peak", "unchanged");
+      sink(line);
+      for (uint8_t c = 0; c < CALL_COUNT; c++)
+      {
+         if (p.calls[c] == 0)
+            continue;
+         perTick(rate, sizeof(rate), p.calls[c], p.ticks);
+         snprintf(line, sizeof(line), "  %-18s %10lu %9s %6u %10lu", callName((Call)c),
+                  (unsigned long)p.calls[c], rate, peak((State)s, (Call)c),
+                  (unsigned long)p.unchanged[c]);
+         sink(line);
+      }
+      if (p.lcdBytes)
+      {
+         perTick(rate, sizeof(rate), p.lcdBytes, p.ticks);
+         snprintf(line, sizeof(line), "  %-18s %10lu %9s %6s %10lu", "lcd bytes",
+                  (unsigned long)p.lcdBytes, rate, "", (unsigned long)p.lcdSame);
+         sink(line);
+      }
+   }
+}
@@ -0,0 +1,334 @@
+#ifndef TRAFFIC_COUNTER_H
+#define TRAFFIC_COUNTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ArduinoInterface.h"
+#include "RocketController.h"
+
+// Call traffic through an ArduinoInterface, by method and by controller state
+//
+// Wraps any backend and passes every call straight through, counting it
+// against the state named by the latest beginTick(); the caller starts each
+// tick with the controller's state, so the counts divide into calls per
+// tick, and the busiest tick is kept as the peak. Calls that change nothing
+// are counted as unchanged: a pin or the relay written to the level it was
+// last written to, tone() of the note already sounding, noTone() while
+// silent, the cursor moved to where it already is, a clear of a blank
+// display, and a print whose characters are all already on the display.
+// LCD bytes (commands and characters) are counted too, with those that
+// rewrote a character with itself. Levels written before the first call
+// are unknown, so the first write to each is never unchanged.
+//
+// About 1.8 KB of counters: host tools and the UNO R4 only.
+class TrafficCounter : public ArduinoInterface
+{
+ public:
+   enum Call : uint8_t
+   {
+      DIGITAL_WRITE,
+      DIGITAL_READ,
+      PIN_MODE,
+      RELAY_WRITE,
+      MILLIS,
+      DELAY,
+      TONE, // all three forms
+      NO_TONE,
+      LCD_CLEAR,
+      LCD_SET_CURSOR,
+      LCD_PRINT_TEXT,
+      LCD_PRINT_NUMBER,
+      UPDATE_DEBOUNCERS,
+      READ_INPUT, // is*Pressed() and wornInputMask()
+      SERIAL_WRITE,
+      PERSIST, // persist, recall and the idle/flush calls
+      ATOMIC,
+      OTHER, // timer hooks and captures, started once per run
+      CALL_COUNT
+   };
+
+   static constexpr uint8_t STATES   = (uint8_t)State::FAULT + 1;
+   static constexpr uint8_t PINS     = 20;
+   static constexpr uint8_t LCD_COLS = 16;
+   static constexpr uint8_t LCD_ROWS = 2;
+
+   typedef void (*LineSink)(const char* line);
+
+   explicit TrafficCounter(ArduinoInterface* hw);
+
+   // Close the tick in progress and attribute the calls that follow to state
+   void     beginTick(State state);
+
+   // Per-state totals
+   uint32_t calls(State state, Call call) const
+   {
+      return profile[(uint8_t)state].calls[call];
+   }
+
+   uint32_t unchanged(State state, Call call) const
+   {
+      return profile[(uint8_t)state].unchanged[call];
+   }
+
+   // Most calls in any one tick (the tick in progress included)
+   uint16_t peak(State state, Call call) const;
+
+   uint32_t ticks(State state) const
+   {
+      return profile[(uint8_t)state].ticks;
+   }
+
+   uint32_t lcdBytes(State state) const
+   {
+      return profile[(uint8_t)state].lcdBytes;
+   }
+
+   uint32_t lcdUnchangedBytes(State state) const
+   {
+      return profile[(uint8_t)state].lcdSame;
+   }
+
+   // One table per state that saw any call; names indexed by State, or nullptr for numbers
+   void               report(LineSink sink, const char* const* stateNames) const;
+
+   static const char* callName(Call call);
+
+   // Pin control
+   void digitalWrite(uint8_t pin, uint8_t state) override
+   {
+      count(DIGITAL_WRITE, pinLevel(pin, state ? HIGH : LOW));
+      hw->digitalWrite(pin, state);
+   }
+
+   uint8_t digitalRead(uint8_t pin) const override
+   {
+      count(DIGITAL_READ, false);
+      return hw->digitalRead(pin);
+   }
+
+   void pinMode(uint8_t pin, uint8_t mode) override
+   {
+      count(PIN_MODE, false);
+      hw->pinMode(pin, mode);
+   }
+
+   void relayWrite(uint8_t pin, bool on) override
+   {
+      count(RELAY_WRITE, pinLevel(pin, on ? HIGH : LOW));
+      hw->relayWrite(pin, on);
+   }
+
+   // Time functions
+   uint32_t millis() const override
+   {
+      count(MILLIS, false);
+      return hw->millis();
+   }
+
+   void delay(uint32_t ms) override
+   {
+      count(DELAY, false);
+      hw->delay(ms);
+   }
+
+   // Audio functions
+   void tone(uint8_t pin, uint16_t freq) override
+   {
+      count(TONE, sounding == freq);
+      sounding = freq;
+      hw->tone(pin, freq);
+   }
+
+   void tone(uint8_t pin, uint16_t freq, uint32_t duration) override
+   {
+      count(TONE, false);
+      sounding = TONE_UNKNOWN; // stops by itself
+      hw->tone(pin, freq, duration);
+   }
+
+   void toneTimer(uint8_t pin, uint16_t freq, ToneTimer timer) override
+   {
+      count(TONE, sounding == freq);
+      sounding = freq;
+      hw->toneTimer(pin, freq, timer);
+   }
+
+   void noTone(uint8_t pin) override
+   {
+      count(NO_TONE, sounding == 0);
+      sounding = 0;
+      hw->noTone(pin);
+   }
+
+   // LCD functions
+   void lcdClear() override;
+   void lcdSetCursor(uint8_t col, uint8_t row) override;
+
+   void lcdPrint(const char* text) override
+   {
+      lcdText(LCD_PRINT_TEXT, text);
+      hw->lcdPrint(text);
+   }
+
+   void lcdPrint(int number) override;
+
+   // Button debouncing
+   void updateDebouncers() override
+   {
+      count(UPDATE_DEBOUNCERS, false);
+      hw->updateDebouncers();
+   }
+
+   bool isArmPressed() const override
+   {
+      count(READ_INPUT, false);
+      return hw->isArmPressed();
+   }
+
+   bool isResetPressed() const override
+   {
+      count(READ_INPUT, false);
+      return hw->isResetPressed();
+   }
+
+   bool isLaunchPressed() const override
+   {
+      count(READ_INPUT, false);
+      return hw->isLaunchPressed();
+   }
+
+   uint8_t wornInputMask() const override
+   {
+      count(READ_INPUT, false);
+      return hw->wornInputMask();
+   }
+
+   // Timer hooks and captures
+   bool attachAuxTimer(AuxScheduler* aux) override
+   {
+      count(OTHER, false);
+      return hw->attachAuxTimer(aux);
+   }
+
+   void beginAtomic() override
+   {
+      count(ATOMIC, false);
+      hw->beginAtomic();
+   }
+
+   void endAtomic() override
+   {
+      count(ATOMIC, false);
+      hw->endAtomic();
+   }
+
+   uint16_t startLoadCell(LoadCellCapture* capture) override
+   {
+      count(OTHER, false);
+      return hw->startLoadCell(capture);
+   }
+
+   void stopLoadCell() override
+   {
+      count(OTHER, false);
+      hw->stopLoadCell();
+   }
+
+   uint16_t startRawCapture(RawCapture* capture) override
+   {
+      count(OTHER, false);
+      return hw->startRawCapture(capture);
+   }
+
+   void stopRawCapture() override
+   {
+      count(OTHER, false);
+      hw->stopRawCapture();
+   }
+
+   // Serial and storage
+   uint16_t serialWritable() const override
+   {
+      count(SERIAL_WRITE, false);
+      return hw->serialWritable();
+   }
+
+   void serialWrite(const uint8_t* data, uint16_t len) override
+   {
+      count(SERIAL_WRITE, false);
+      hw->serialWrite(data, len);
+   }
+
+   bool persist(uint16_t addr, const uint8_t* data, uint8_t len) override
+   {
+      count(PERSIST, false);
+      return hw->persist(addr, data, len);
+   }
+
+   bool recall(uint16_t addr, uint8_t* data, uint8_t len) const override
+   {
+      count(PERSIST, false);
+      return hw->recall(addr, data, len);
+   }
+
+   bool persistIdle() const override
+   {
+      count(PERSIST, false);
+      return hw->persistIdle();
+   }
+
+   void persistFlush() override
+   {
+      count(PERSIST, false);
+      hw->persistFlush();
+   }
+
+ private:
+   static constexpr uint8_t  LEVEL_UNKNOWN = 0xFF;
+   static constexpr uint16_t TONE_UNKNOWN  = 0xFFFF;
+
+   struct Profile
+   {
+      uint32_t ticks;
+      uint32_t calls[CALL_COUNT];
+      uint32_t unchanged[CALL_COUNT];
+      uint16_t peak[CALL_COUNT];
+      uint32_t lcdBytes;
+      uint32_t lcdSame;
+   };
+
+   ArduinoInterface* hw;
+   mutable Profile   profile[STATES];
+   mutable uint16_t  thisTick[CALL_COUNT]; // calls so far in the tick in progress
+   uint8_t           tickState = 0;
+   uint8_t           levels[PINS];
+   uint16_t          sounding = TONE_UNKNOWN;
+   char              shadow[LCD_ROWS][LCD_COLS]; // 0 = unknown
+   uint8_t           cursorCol = LEVEL_UNKNOWN;
+   uint8_t           cursorRow = LEVEL_UNKNOWN;
+
+   // Counting is logically const: reads are counted too
+   void count(Call call, bool same) const
+   {
+      Profile& p = profile[tickState];
+      p.calls[call]++;
+      if (same)
+         p.unchanged[call]++;
+      if (thisTick[call] != 0xFFFF)
+         thisTick[call]++;
+   }
+
+   // True if pin already had level; records it either way
+   bool pinLevel(uint8_t pin, uint8_t level)
+   {
+      if (pin >= PINS)
+         return false;
+      const bool same = levels[pin] == level;
+      levels[pin]     = level;
+      return same;
+   }
+
+   void lcdText(Call call, const char* text);
+};
+
+#endif // TRAFFIC_COUNTER_H
@@ -1,8 +1,410 @@
 #include <Arduino.h>
-#include <Bounce2.h>
 #include <LiquidCrystal.h>
 #include "RocketController.h"
 #include "ArduinoInterface.h"
+#include "AdaptiveDebouncer.h"
+#include "EepromQueue.h"
+#include "FastLcd.h"
+#include "RelayDrive.h"
+#if ROCKET_HAL_CONFORMANCE
+#include "HalConformance.h"
+#endif
+
+// Range mode: clean fires return to READY after a disarm instead of latching FAULT
+#ifndef ROCKET_RANGE_MODE
+#define ROCKET_RANGE_MODE 0
+#endif
+
+// Telemetry: 'T' frames on the serial port for a host-side twin (tools/rocket_twin)
+#ifndef ROCKET_TELEMETRY
+#define ROCKET_TELEMETRY 0
+#endif
+
+// Relay pulse: long enough to fire the igniter/battery pair in use (tools/igniter_sweep)
+#ifndef ROCKET_RELAY_MS
+#define ROCKET_RELAY_MS 5000
+#endif
+
+// Relay hold: after ROCKET_RELAY_PULLIN_MS at full voltage the coil is held at this duty
+// (percent) by the fast tick; 100 drives the relay pin plainly. Needs a flyback diode.
+#ifndef ROCKET_RELAY_HOLD_PCT
+#define ROCKET_RELAY_HOLD_PCT 100
+#endif
+
+#ifndef ROCKET_RELAY_PULLIN_MS
+#define ROCKET_RELAY_PULLIN_MS 30
+#endif
+
+// Raw input forensics: 'R' frames with the undebounced inputs around every edge and fault
+#ifndef ROCKET_RAW_CAPTURE
+#define ROCKET_RAW_CAPTURE 0
+#endif
+
+// HAL conformance: check and time every ArduinoInterface call at boot and print the table
+// on the serial port (see tools/hal_conformance); the relay is left alone
+#ifndef ROCKET_HAL_CONFORMANCE
+#define ROCKET_HAL_CONFORMANCE 0
+#endif
+
+// Call traffic (UNO R4 only): count the controller's hardware calls per state and print the
+// profile after every launch cycle (see TrafficCounter.h)
+#ifndef ROCKET_TRAFFIC
+#define ROCKET_TRAFFIC 0
+#endif
+
+// Preemptive build (UNO R4 only): safety task plus lower-priority audio and display tasks
+#ifndef ROCKET_RTOS
+#define ROCKET_RTOS 0
+#endif
+
+// With ROCKET_RTOS, redraw the whole LCD on every display pass to measure the safety task
+// under display load
+#ifndef ROCKET_RTOS_LCD_STRESS
+#define ROCKET_RTOS_LCD_STRESS 0
+#endif
+
+#ifdef ARDUINO_ARCH_RENESAS
+#include <FspTimer.h>
+#endif
+
+#if ROCKET_RTOS
+#if !defined(ARDUINO_ARCH_RENESAS)
+#error "ROCKET_RTOS needs the UNO R4 (FreeRTOS ships with the Renesas core)"
+#endif
+#include <Arduino_FreeRTOS.h>
+#include "QueuedUiInterface.h"
+#endif
+
+#if ROCKET_TRAFFIC
+#if !defined(ARDUINO_ARCH_RENESAS) || ROCKET_RTOS
+#error "ROCKET_TRAFFIC needs the UNO R4 (1.8 KB of counters) and the single-loop build"
+#endif
+#include "TrafficCounter.h"
+#endif
+
+#if defined(__AVR_ATmega328P__)
+#include <avr/eeprom.h>
+#endif
+
+// LCD driven through port registers from the fast tick; other boards keep LiquidCrystal
+#if defined(__AVR_ATmega328P__) || defined(ARDUINO_ARCH_RENESAS)
+#define ROCKET_FAST_LCD 1
+#else
+#define ROCKET_FAST_LCD 0
+#endif
+
+// D8 has no PWM channel on either UNO, so the hold duty is switched by the fast tick
+#if ROCKET_RELAY_HOLD_PCT < 100 && (defined(__AVR_ATmega328P__) || defined(ARDUINO_ARCH_RENESAS))
+#define ROCKET_RELAY_HOLD_DRIVE 1
+#else
+#define ROCKET_RELAY_HOLD_DRIVE 0
+#endif
+
+// 10 kHz fast tick shared by the aux channels, raw input capture and load-cell acquisition
+static constexpr uint16_t        FAST_TICK_HZ       = 10000;
+static AuxScheduler* volatile    auxTimerTarget     = nullptr;
+static LoadCellCapture* volatile loadCellTarget     = nullptr;
+static RawCapture* volatile      rawTarget          = nullptr;
+static RelayDrive* volatile      relayTarget        = nullptr;
+static bool                      fastTickRunning    = false;
+
+// HX711 load-cell amplifier with RATE tied high (80 samples/s); A0-A5 are taken by the LCD
+static constexpr uint8_t         PIN_HX711_DOUT     = 12; // PB4
+static constexpr uint8_t         PIN_HX711_SCK      = 13; // PB5
+static constexpr uint16_t        HX711_RATE_HZ      = 80;
+static constexpr uint16_t        HX711_PERIOD_TICKS = FAST_TICK_HZ / HX711_RATE_HZ;
+static constexpr uint16_t        HX711_LATE_TICKS   = HX711_PERIOD_TICKS * 3 / 2;
+static uint16_t                  hx711IdleTicks     = 0;
+
+// LCD bytes queued by the loop, clocked out one per fast tick
+static FastLcd* volatile         lcdTarget          = nullptr;
+
+// Clock one conversion out of the HX711 once DOUT signals it is ready
+static void hx711Tick()
+{
+   LoadCellCapture* capture = loadCellTarget;
+   if (!capture)
+      return;
+
+   // A conversion slot went by without data: count it as dropped and keep waiting
+   if (++hx711IdleTicks > HX711_LATE_TICKS)
+   {
+      capture->missed();
+      hx711IdleTicks -= HX711_PERIOD_TICKS;
+   }
+
+   uint32_t value = 0;
+#if defined(__AVR_ATmega328P__)
+   if (PINB & _BV(PINB4))
+      return;
+   for (uint8_t i = 0; i < 24; i++)
+   {
+      PORTB |= _BV(PORTB5);
+      __asm__ __volatile__("nop\n\tnop"); // DOUT valid 0.1 us after SCK rises
+      value = (value << 1) | ((PINB >> PINB4) & 1);
+      PORTB &= ~_BV(PORTB5);
+   }
+   PORTB |= _BV(PORTB5); // 25th clock: channel A, gain 128 for the next conversion
+   __asm__ __volatile__("nop\n\tnop");
+   PORTB &= ~_BV(PORTB5);
+#else
+   if (digitalRead(PIN_HX711_DOUT) == HIGH)
+      return;
+   for (uint8_t i = 0; i < 25; i++)
+   {
+      digitalWrite(PIN_HX711_SCK, HIGH);
+      if (i < 24)
+         value = (value << 1) | (digitalRead(PIN_HX711_DOUT) == HIGH ? 1 : 0);
+      digitalWrite(PIN_HX711_SCK, LOW);
+   }
+#endif
+   hx711IdleTicks = 0;
+   capture->push((int32_t)(value ^ 0x800000u) - 0x800000);
+}
+
+#if defined(ARDUINO_ARCH_RENESAS)
+// One pin of an RA4M1 port, written through PCNTR3 (set in the low half, reset in the
+// high half) and read through PCNTR2 (input levels in the low half)
+struct PortLine
+{
+   R_PORT0_Type* port;
+   uint16_t      mask;
+};
+
+static PortLine portLineOf(uint8_t pin)
+{
+   const uintptr_t         stride = (uintptr_t)R_PORT1 - (uintptr_t)R_PORT0;
+   const bsp_io_port_pin_t bsp    = g_pin_cfg[pin].pin;
+   return {(R_PORT0_Type*)((uintptr_t)R_PORT0 + (bsp >> 8) * stride),
+           (uint16_t)(1u << (bsp & 0xFF))};
+}
+
+static void portLineWrite(const PortLine& line, bool high)
+{
+   line.port->PCNTR3 = high ? line.mask : (uint32_t)line.mask << 16;
+}
+
+static PortLine rawLines[3]; // ARM, RESET, LAUNCH
+#endif
+
+#if ROCKET_RELAY_HOLD_DRIVE
+#if defined(ARDUINO_ARCH_RENESAS)
+static PortLine relayLine;
+#endif
+
+// Relay on D8: PB0 on the UNO R3, one store to its port on the R4
+static void relayPinWrite(bool high)
+{
+#if defined(__AVR_ATmega328P__)
+   if (high)
+      PORTB |= _BV(PORTB0);
+   else
+      PORTB &= ~_BV(PORTB0);
+#else
+   portLineWrite(relayLine, high);
+#endif
+}
+
+static constexpr uint8_t RELAY_PWM_PERIOD_TICKS = 20; // 500 Hz, 5 % steps
+static_assert(ROCKET_RELAY_HOLD_PCT >= 10, "a hold duty that low will not keep any relay closed");
+#endif
+
+// ARM, RESET and LAUNCH as INPUT_BIT_* (1 = pressed, they pull the pin low), straight off
+// the port: on the UNO they are PD2-PD4, one register read
+static inline uint8_t rawInputLevels()
+{
+#if defined(__AVR_ATmega328P__)
+   return (uint8_t)((~PIND >> PIND2) & 0x07);
+#elif defined(ARDUINO_ARCH_RENESAS)
+   uint8_t levels = 0;
+   for (uint8_t i = 0; i < 3; i++)
+   {
+      if (!(rawLines[i].port->PCNTR2 & rawLines[i].mask))
+         levels |= (uint8_t)(1u << i);
+   }
+   return levels;
+#else
+   return 0;
+#endif
+}
+
+// Aux pins from the fast tick: the core's write, never a decorator around the interface
+static void auxPinWrite(uint8_t pin, bool high)
+{
+   ::digitalWrite(pin, high ? HIGH : LOW);
+}
+
+static void fastTick()
+{
+   if (relayTarget)
+      relayTarget->service();
+   if (rawTarget)
+      rawTarget->sample(rawInputLevels());
+   if (auxTimerTarget)
+      auxTimerTarget->service(millis());
+   hx711Tick();
+   if (lcdTarget)
+      lcdTarget->service();
+}
+
+#if defined(__AVR_ATmega328P__)
+ISR(TIMER2_COMPA_vect)
+{
+   fastTick();
+}
+#elif defined(ARDUINO_ARCH_RENESAS)
+static FspTimer fastTickTimer;
+
+static void     fastTickCallback(timer_callback_args_t*)
+{
+   fastTick();
+}
+#endif
+
+#if defined(__AVR_ATmega328P__)
+// EEPROM writes queued by the loop, programmed one byte per EE_READY interrupt
+static EepromQueue eepromQueue;
+
+// Fires whenever EEPE is clear and EERIE set: retire the byte just programmed,
+// start the next one that differs, and switch itself off once the queue is empty
+ISR(EE_READY_vect)
+{
+   if (eepromQueue.isProgramming())
+      eepromQueue.programmed();
+
+   uint16_t addr;
+   uint8_t  value;
+   while (eepromQueue.pop(addr, value))
+   {
+      EEAR  = addr;
+      EECR |= _BV(EERE);
+      if (EEDR == value)
+      {
+         eepromQueue.skipped(); // unchanged: no 3.4 ms cycle, no wear
+         continue;
+      }
+      EEDR  = value;
+      EECR |= _BV(EEMPE); // EEPE must follow within four cycles
+      EECR |= _BV(EEPE);
+      eepromQueue.started();
+      return;
+   }
+   EECR &= ~_BV(EERIE);
+}
+#endif
+
+#if defined(__AVR_ATmega328P__)
+// The buzzer on OC1A (D9) runs on Timer1 only. The core's tone() would claim Timer2,
+// which carries the fast tick, so it is never called on this board.
+static volatile uint32_t buzzerToggles = 0; // left in a timed note; 0 = until stopped
+
+static void buzzerStop()
+{
+   // Stop Timer1 and disconnect OC1A, leaving the buzzer pin low
+   TCCR1B  = 0;
+   TCCR1A  = 0;
+   TIMSK1 &= ~_BV(OCIE1A);
+   PORTB  &= ~_BV(PORTB1);
+}
+
+static void buzzerStart(ToneTimer timer, uint32_t toggles)
+{
+   TCCR1B        = 0; // stop the clock while reprogramming
+   buzzerToggles = toggles;
+   TCCR1A        = _BV(COM1A0);
+   TCNT1         = 0;
+   OCR1A         = timer.top;
+   TIFR1         = _BV(OCF1A);
+   if (toggles)
+      TIMSK1 |= _BV(OCIE1A);
+   else
+      TIMSK1 &= ~_BV(OCIE1A);
+   TCCR1B = _BV(WGM12) | timer.clockSelect;
+}
+
+// Counts the pin toggles of a timed note and silences the buzzer after the last one
+ISR(TIMER1_COMPA_vect)
+{
+   if (--buzzerToggles == 0)
+      buzzerStop();
+}
+#endif
+
+#if defined(__AVR_ATmega328P__)
+// RS on PC0, E on PC1, D4-D7 on PC2-PC5 (A0-A5): a nibble and RS in one port write,
+// then E timed in cycles. Only the fast tick writes PORTC once the LCD is attached.
+static void lcdWriteNibble(uint8_t nibble, bool rs)
+{
+   PORTC = (uint8_t)((PORTC & ~0x3D) | (nibble << 2) | (rs ? _BV(PORTC0) : 0));
+   __builtin_avr_delay_cycles(1); // 40 ns address setup before E rises
+   PORTC |= _BV(PORTC1);
+   __builtin_avr_delay_cycles(6); // E high >= 450 ns with the sbi
+   PORTC &= ~_BV(PORTC1);
+   __builtin_avr_delay_cycles(8); // E cycle >= 1 us before the next nibble
+}
+
+static void lcdPortsBegin(const uint8_t*)
+{
+   DDRC |= 0x3F;
+}
+#elif defined(ARDUINO_ARCH_RENESAS)
+// A0-A5 are spread over ports 0 and 1 on the RA4M1, so each line is one store to its
+// port's set/reset register
+static PortLine lcdLines[6]; // RS, E, D4-D7
+
+// N core cycles (one NOP each on the Cortex-M4; flash wait states only stretch them),
+// so the fast-tick interrupt spends 1 us per nibble instead of two delayMicroseconds() calls
+#define LCD_NOPS(n) __asm__ __volatile__(".rept " #n "\n\tnop\n\t.endr")
+
+static void lcdWriteNibble(uint8_t nibble, bool rs)
+{
+   portLineWrite(lcdLines[0], rs);
+   for (uint8_t i = 0; i < 4; i++)
+      portLineWrite(lcdLines[2 + i], nibble & (1u << i));
+   portLineWrite(lcdLines[1], true);
+   LCD_NOPS(24); // E high >= 450 ns at 48 MHz
+   portLineWrite(lcdLines[1], false);
+   LCD_NOPS(24); // E cycle >= 1 us before the next nibble
+}
+
+static void lcdPortsBegin(const uint8_t* pins)
+{
+   for (uint8_t i = 0; i < 6; i++)
+   {
+      ::pinMode(pins[i], OUTPUT);
+      lcdLines[i] = portLineOf(pins[i]);
+   }
+}
+#endif
+
+// Start the fast tick once; false if the board has no timer for it
+static bool startFastTick()
+{
+   if (fastTickRunning)
+      return true;
+#if defined(__AVR_ATmega328P__)
+   // Timer2 CTC: 16 MHz / 8 / (199 + 1) = 10 kHz; OC2A/OC2B stay disconnected
+   TCCR2A  = _BV(WGM21);
+   TCCR2B  = _BV(CS21);
+   OCR2A   = F_CPU / 8 / FAST_TICK_HZ - 1;
+   TCNT2   = 0;
+   TIMSK2 |= _BV(OCIE2A);
+#elif defined(ARDUINO_ARCH_RENESAS)
+   uint8_t type;
+   int8_t  channel = FspTimer::get_available_timer(type);
+   if (channel < 0)
+      return false; // no free GPT/AGT
+   fastTickTimer.begin(TIMER_MODE_PERIODIC, type, channel, (float)FAST_TICK_HZ, 0.0f,
+                       fastTickCallback);
+   fastTickTimer.setup_overflow_irq();
+   fastTickTimer.open();
+   fastTickTimer.start();
+#else
+   return false;
+#endif
+   fastTickRunning = true;
+   return true;
+}
 
 // Real Arduino interface implementation
 class RealArduinoInterface : public ArduinoInterface
@@ -17,6 +419,8 @@ class RealArduinoInterface : public ArduinoInterface
    static constexpr uint8_t PIN_LAUNCH_LIGHT = 7;
    static constexpr uint8_t PIN_RELAY        = 8;
    static constexpr uint8_t PIN_BUZZER       = 9;
+   static constexpr uint8_t PIN_AUX_CAMERA   = 10;
+   static constexpr uint8_t PIN_AUX_STROBE   = 11;
 
    // LCD pins (analog pins used as digital)
    static constexpr uint8_t LCD_RS           = A0;
@@ -31,20 +435,24 @@ class RealArduinoInterface : public ArduinoInterface
    static constexpr bool    RELAY_INACTIVE   = LOW;
 
    // Hardware objects
-   LiquidCrystal*           lcd;
-   Bounce*                  dbArm;
-   Bounce*                  dbReset;
-   Bounce*                  dbLaunch;
+   LiquidCrystal*           lcd = nullptr; // only where there is no fast LCD path
+#if ROCKET_FAST_LCD
+   FastLcd                  fastLcd{lcdWriteNibble};
+   bool                     relayClosed = false; // last commanded, for healing the LCD
+#endif
+#if ROCKET_RELAY_HOLD_DRIVE
+   RelayDrive               relayDrive{relayPinWrite};
+#endif
+#if defined(__AVR_ATmega328P__)
+   uint8_t                  savedSreg = 0;
+#endif
+   AdaptiveDebouncer        dbArm;
+   AdaptiveDebouncer        dbReset;
+   AdaptiveDebouncer        dbLaunch;
 
  public:
    RealArduinoInterface()
    {
-      // Initialize hardware objects
-      lcd      = new LiquidCrystal(LCD_RS, LCD_E, LCD_D4, LCD_D5, LCD_D6, LCD_D7);
-      dbArm    = new Bounce();
-      dbReset  = new Bounce();
-      dbLaunch = new Bounce();
-
       // Setup pin modes
       pinMode(PIN_ARM, INPUT_PULLUP);
       pinMode(PIN_RESET, INPUT_PULLUP);
@@ -54,32 +462,77 @@ class RealArduinoInterface : public ArduinoInterface
       pinMode(PIN_LAUNCH_LIGHT, OUTPUT);
       pinMode(PIN_RELAY, OUTPUT);
       pinMode(PIN_BUZZER, OUTPUT);
+      pinMode(PIN_AUX_CAMERA, OUTPUT);
+      pinMode(PIN_AUX_STROBE, OUTPUT);
+      pinMode(PIN_HX711_DOUT, INPUT);
+      pinMode(PIN_HX711_SCK, OUTPUT);
 
       // Safe boot: force relay inactive
       digitalWrite(PIN_RELAY, RELAY_INACTIVE);
+      digitalWrite(PIN_AUX_CAMERA, LOW);
+      digitalWrite(PIN_AUX_STROBE, LOW);
+      digitalWrite(PIN_HX711_SCK, LOW); // SCK high for >60 us powers the HX711 down
 
-      // Setup debouncers
-      dbArm->attach(PIN_ARM);
-      dbArm->interval(10);
-      dbReset->attach(PIN_RESET);
-      dbReset->interval(10);
-      dbLaunch->attach(PIN_LAUNCH);
-      dbLaunch->interval(10);
+#if ROCKET_RELAY_HOLD_DRIVE
+      // Relay hold drive; without the fast tick the pin is driven plainly
+      relayDrive.configure(ROCKET_RELAY_PULLIN_MS * (FAST_TICK_HZ / 1000),
+                           ROCKET_RELAY_HOLD_PCT * RELAY_PWM_PERIOD_TICKS / 100,
+                           RELAY_PWM_PERIOD_TICKS);
+      if (startFastTick())
+      {
+#if defined(ARDUINO_ARCH_RENESAS)
+         relayLine = portLineOf(PIN_RELAY);
+#endif
+         beginAtomic();
+         relayTarget = &relayDrive;
+         endAtomic();
+      }
+#endif
 
-      // Initialize LCD
+      // Setup debouncers (settle windows adapt per switch from here on)
+      const uint32_t now = ::millis();
+      // ARM and LAUNCH form the interlock, so a level they accept is held against late bounce
+      dbArm.begin(::digitalRead(PIN_ARM) == HIGH, now, AdaptiveDebouncer::INTERLOCK_HOLD_MS);
+      dbReset.begin(::digitalRead(PIN_RESET) == HIGH, now);
+      dbLaunch.begin(::digitalRead(PIN_LAUNCH) == HIGH, now, AdaptiveDebouncer::INTERLOCK_HOLD_MS);
+
+      // Initialize LCD: queued and clocked out by the fast tick where the board has one
+#if ROCKET_FAST_LCD
+      if (startFastTick())
+      {
+         const uint8_t pins[6] = {LCD_RS, LCD_E, LCD_D4, LCD_D5, LCD_D6, LCD_D7};
+         lcdPortsBegin(pins);
+         fastLcd.begin(16, 2);
+         beginAtomic();
+         lcdTarget = &fastLcd;
+         endAtomic();
+         return;
+      }
+#endif
+      lcd = new LiquidCrystal(LCD_RS, LCD_E, LCD_D4, LCD_D5, LCD_D6, LCD_D7);
       lcd->begin(16, 2);
    }
 
    ~RealArduinoInterface()
    {
+#if ROCKET_FAST_LCD
+      beginAtomic();
+      if (lcdTarget == &fastLcd)
+         lcdTarget = nullptr;
+      endAtomic();
+#endif
+#if ROCKET_RELAY_HOLD_DRIVE
+      beginAtomic();
+      relayDrive.set(false);
+      relayTarget = nullptr;
+      endAtomic();
+#endif
+
       // Suppress warning about non-virtual destructors
       // We're deleting concrete objects, not through base pointers
       #pragma GCC diagnostic push
       #pragma GCC diagnostic ignored "-Wdelete-non-virtual-dtor"
       delete lcd;
-      delete dbArm;
-      delete dbReset;
-      delete dbLaunch;
       #pragma GCC diagnostic pop
    }
 
@@ -97,9 +550,35 @@ class RealArduinoInterface : public ArduinoInterface
 
    uint8_t digitalRead(uint8_t pin) const override
    {
+#if ROCKET_RELAY_HOLD_DRIVE
+      // The pin itself spends part of every hold period low
+      if (pin == PIN_RELAY && relayTarget)
+         return relayDrive.isOn() ? RELAY_ACTIVE : RELAY_INACTIVE;
+#endif
       return ::digitalRead(pin);
    }
 
+   void relayWrite(uint8_t pin, bool on) override
+   {
+#if ROCKET_FAST_LCD
+      // Contact and coil noise can garble the LCD: redraw it once the relay has settled
+      if (pin == PIN_RELAY && on != relayClosed && !lcd)
+         fastLcd.heal();
+      if (pin == PIN_RELAY)
+         relayClosed = on;
+#endif
+#if ROCKET_RELAY_HOLD_DRIVE
+      if (pin == PIN_RELAY && relayTarget)
+      {
+         beginAtomic();
+         relayDrive.set(on);
+         endAtomic();
+         return;
+      }
+#endif
+      digitalWrite(pin, on ? RELAY_ACTIVE : RELAY_INACTIVE);
+   }
+
    void pinMode(uint8_t pin, uint8_t mode) override
    {
 #ifdef ARDUINO_ARCH_RENESAS
@@ -122,88 +601,483 @@ class RealArduinoInterface : public ArduinoInterface
       ::delay(ms);
    }
 
-   // Audio functions
+   // Audio functions. On the UNO only the buzzer pin can sound (see buzzerStart).
    void tone(uint8_t pin, uint16_t freq) override
    {
+#if defined(__AVR_ATmega328P__)
+      toneTimer(pin, freq, toneTimerFor(freq));
+#else
       ::tone(pin, freq);
+#endif
    }
 
    void tone(uint8_t pin, uint16_t freq, uint32_t duration) override
    {
+#if defined(__AVR_ATmega328P__)
+      // Two toggles per period; split so a long note cannot overflow
+      const uint32_t toggles = duration / 1000 * 2 * freq + duration % 1000 * 2 * freq / 1000;
+      const ToneTimer timer  = toneTimerFor(freq);
+      if (pin != PIN_BUZZER || timer.clockSelect == 0 || toggles == 0)
+      {
+         noTone(pin);
+         return;
+      }
+      buzzerStart(timer, toggles);
+#else
       ::tone(pin, freq, duration);
+#endif
    }
 
    void noTone(uint8_t pin) override
    {
+#if defined(__AVR_ATmega328P__)
+      if (pin == PIN_BUZZER)
+         buzzerStop();
+#else
       ::noTone(pin);
+#endif
+   }
+
+   void toneTimer(uint8_t pin, uint16_t freq, ToneTimer timer) override
+   {
+#if defined(__AVR_ATmega328P__)
+      // Pin 9 is OC1A: Timer1 toggles it in hardware (CTC mode), so a note change
+      // is a handful of register writes instead of tone()'s runtime division and ISR
+      (void)freq;
+      if (pin != PIN_BUZZER)
+         return;
+      if (timer.clockSelect == 0)
+         buzzerStop();
+      else
+         buzzerStart(timer, 0);
+#else
+      (void)timer;
+      ::tone(pin, freq);
+#endif
    }
 
    // LCD functions
    void lcdClear() override
    {
+#if ROCKET_FAST_LCD
+      if (!lcd)
+      {
+         fastLcd.clear();
+         return;
+      }
+#endif
       lcd->clear();
    }
 
    void lcdSetCursor(uint8_t col, uint8_t row) override
    {
+#if ROCKET_FAST_LCD
+      if (!lcd)
+      {
+         fastLcd.setCursor(col, row);
+         return;
+      }
+#endif
       lcd->setCursor(col, row);
    }
 
    void lcdPrint(const char* text) override
    {
+#if ROCKET_FAST_LCD
+      if (!lcd)
+      {
+         fastLcd.print(text);
+         return;
+      }
+#endif
       lcd->print(text);
    }
 
    void lcdPrint(int number) override
    {
+#if ROCKET_FAST_LCD
+      if (!lcd)
+      {
+         fastLcd.print(number);
+         return;
+      }
+#endif
       lcd->print(number);
    }
 
    // Button debouncing
    void updateDebouncers() override
    {
-      dbArm->update();
-      dbReset->update();
-      dbLaunch->update();
+      const uint32_t now = ::millis();
+      dbArm.update(::digitalRead(PIN_ARM) == HIGH, now);
+      dbReset.update(::digitalRead(PIN_RESET) == HIGH, now);
+      dbLaunch.update(::digitalRead(PIN_LAUNCH) == HIGH, now);
    }
 
    bool isArmPressed() const override
    {
-      return dbArm->read() == LOW;
+      return dbArm.read() == LOW;
    }
 
    bool isResetPressed() const override
    {
-      return dbReset->read() == LOW;
+      return dbReset.read() == LOW;
    }
 
    bool isLaunchPressed() const override
    {
-      return dbLaunch->read() == LOW;
+      return dbLaunch.read() == LOW;
+   }
+
+   uint8_t wornInputMask() const override
+   {
+      return (dbArm.isWorn() ? INPUT_BIT_ARM : 0) | (dbReset.isWorn() ? INPUT_BIT_RESET : 0) |
+             (dbLaunch.isWorn() ? INPUT_BIT_LAUNCH : 0);
+   }
+
+   // Aux channels: 10 kHz compare tick, so pulses land within 0.1 ms of their millis() time
+   bool attachAuxTimer(AuxScheduler* aux) override
+   {
+      if (!startFastTick())
+         return false; // the controller polls instead
+      aux->setPinWrite(auxPinWrite);
+      beginAtomic();
+      auxTimerTarget = aux;
+      endAtomic();
+      return true;
+   }
+
+   // Static-fire thrust: HX711 polled from the fast tick
+   uint16_t startLoadCell(LoadCellCapture* capture) override
+   {
+      if (!startFastTick())
+         return 0;
+      beginAtomic();
+      hx711IdleTicks = 0;
+      loadCellTarget = capture;
+      endAtomic();
+      return HX711_RATE_HZ;
+   }
+
+   void stopLoadCell() override
+   {
+      beginAtomic();
+      loadCellTarget = nullptr;
+      endAtomic();
+   }
+
+   // Raw inputs: read off the port by the fast tick, ahead of the debouncers
+   uint16_t startRawCapture(RawCapture* capture) override
+   {
+      if (!startFastTick())
+         return 0;
+#if defined(ARDUINO_ARCH_RENESAS)
+      rawLines[0] = portLineOf(PIN_ARM);
+      rawLines[1] = portLineOf(PIN_RESET);
+      rawLines[2] = portLineOf(PIN_LAUNCH);
+#endif
+      beginAtomic();
+      rawTarget = capture;
+      endAtomic();
+      return FAST_TICK_HZ;
+   }
+
+   void stopRawCapture() override
+   {
+      beginAtomic();
+      rawTarget = nullptr;
+      endAtomic();
+   }
+
+   // Capture dumps share the port with the text reports
+   uint16_t serialWritable() const override
+   {
+      const int n = Serial.availableForWrite();
+      return n > 0 ? (uint16_t)n : 0;
+   }
+
+   void serialWrite(const uint8_t* data, uint16_t len) override
+   {
+      Serial.write(data, len);
+   }
+
+   // Persistence: queue and return; EE_READY does the programming in the background.
+   // The R4 has no background path yet (its EEPROM library blocks on data flash), so
+   // it keeps the interface default of no storage.
+#if defined(__AVR_ATmega328P__)
+   bool persist(uint16_t addr, const uint8_t* data, uint8_t len) override
+   {
+      if ((uint32_t)addr + len > E2END + 1)
+         return false;
+      beginAtomic();
+      const bool queued = eepromQueue.write(addr, data, len);
+      endAtomic();
+      if (queued)
+         EECR |= _BV(EERIE);
+      return queued;
+   }
+
+   bool recall(uint16_t addr, uint8_t* data, uint8_t len) const override
+   {
+      if ((uint32_t)addr + len > E2END + 1)
+         return false;
+      eeprom_read_block(data, (const void*)(uintptr_t)addr, len);
+      return true;
+   }
+
+   bool persistIdle() const override
+   {
+      uint8_t sreg = SREG;
+      cli();
+      const bool idle = eepromQueue.isIdle();
+      SREG = sreg;
+      return idle;
+   }
+
+   void persistFlush() override
+   {
+      while (!persistIdle())
+      {
+      }
+   }
+#endif
+
+   void beginAtomic() override
+   {
+#if defined(__AVR_ATmega328P__)
+      savedSreg = SREG;
+      cli();
+#else
+      noInterrupts();
+#endif
+   }
+
+   void endAtomic() override
+   {
+#if defined(__AVR_ATmega328P__)
+      SREG = savedSreg;
+#else
+      interrupts();
+#endif
    }
 };
 
 // Global objects
 RealArduinoInterface* arduinoInterface;
 RocketController*     rocketController;
+uint16_t              reportedLaunches = 0;
+#if ROCKET_TRAFFIC
+TrafficCounter*       trafficInterface;
+
+static void           trafficLine(const char* line)
+{
+   Serial.println(line);
+}
+#endif
+
+// Report each completed launch cycle (arm to ready again)
+static void           reportCycles()
+{
+   if (rocketController->getLaunchCount() != reportedLaunches)
+   {
+      reportedLaunches = rocketController->getLaunchCount();
+      Serial.print(F("cycle "));
+      Serial.print(reportedLaunches);
+      Serial.print(F(" ms="));
+      Serial.print(rocketController->getLastCycleMs());
+      Serial.print(F(" avg="));
+      Serial.println(rocketController->getTotalCycleMs() / reportedLaunches);
+#if ROCKET_TRAFFIC
+      trafficInterface->report(trafficLine, nullptr);
+#endif
+   }
+}
+
+#if ROCKET_HAL_CONFORMANCE
+static uint32_t halNanos()
+{
+   return micros() * 1000UL;
+}
+
+static void halLine(const char* line)
+{
+   Serial.println(line);
+}
+
+// Nothing on the board can be observed from inside, so only the pins and the clock are
+// checked; every call is timed over 100 calls (a few hundred ms for the LCD)
+static void runHalConformance()
+{
+   HalProbe               probe;
+   HalConformance         suite(arduinoInterface, &probe, halNanos);
+   HalConformance::Config config;
+   config.iterations = 100;
+   suite.run(config);
+#if defined(ARDUINO_ARCH_RENESAS)
+   suite.report("uno_r4", halLine);
+#else
+   suite.report("uno", halLine);
+#endif
+}
+#endif
+
+#if ROCKET_RTOS
+// The controller runs in the safety task every SAFETY_PERIOD_MS at the top priority.
+// Its LCD, buzzer and serial calls go through QueuedUiInterface and are carried out by
+// the audio and display tasks below it, so a slow redraw can delay only the display.
+// The display task is the only one that touches Serial: it sends the controller's
+// frames first and prints its own text only once they are all out, so text never
+// lands inside a frame.
+static constexpr uint32_t  SAFETY_PERIOD_MS   = 1;
+static constexpr uint16_t  AUDIO_BATCH        = 4;
+static constexpr uint16_t  LCD_BATCH          = 8;
+static constexpr uint32_t  REPORT_PERIOD_MS   = 1000;
+static QueuedUiInterface*  uiInterface;
+
+// Safety-task response times, from the tick the task was due to the end of its update
+struct SafetyTiming
+{
+   volatile uint32_t worstUs     = 0; // worst-case response time
+   volatile uint32_t worstLateUs = 0; // worst start after release (preemption, ISRs)
+   volatile uint32_t runs        = 0;
+   volatile uint32_t overruns    = 0; // finished after the next release was due
+};
+static SafetyTiming safetyTiming;
+
+static void         safetyTask(void*)
+{
+   const uint32_t periodUs = SAFETY_PERIOD_MS * 1000;
+   TickType_t     wake     = xTaskGetTickCount();
+   uint32_t       due      = micros();
+   for (;;)
+   {
+      const uint32_t start = micros();
+      arduinoInterface->updateDebouncers();
+      rocketController->update(arduinoInterface->millis());
+      const uint32_t response = micros() - due;
+      const uint32_t late     = start - due;
+
+      if (response > safetyTiming.worstUs)
+         safetyTiming.worstUs = response;
+      if (late > safetyTiming.worstLateUs)
+         safetyTiming.worstLateUs = late;
+      if (response > periodUs)
+         safetyTiming.overruns = safetyTiming.overruns + 1;
+      safetyTiming.runs = safetyTiming.runs + 1;
+
+      vTaskDelayUntil(&wake, pdMS_TO_TICKS(SAFETY_PERIOD_MS));
+      // Re-anchor after an overrun so one slip is not charged to every later period
+      due = response > periodUs ? micros() : due + periodUs;
+   }
+}
+
+static void audioTask(void*)
+{
+   for (;;)
+   {
+      uiInterface->drainAudio(AUDIO_BATCH);
+      vTaskDelay(1);
+   }
+}
+
+static void displayTask(void*)
+{
+   uint32_t reportAt = 0;
+   for (;;)
+   {
+      uiInterface->drainLcd(LCD_BATCH);
+      const bool framesOut = uiInterface->drainSerial();
+#if ROCKET_RTOS_LCD_STRESS
+      arduinoInterface->lcdClear();
+      arduinoInterface->lcdSetCursor(0, 0);
+      arduinoInterface->lcdPrint("STRESS 0123456789");
+      arduinoInterface->lcdSetCursor(0, 1);
+      arduinoInterface->lcdPrint((int)safetyTiming.runs);
+#endif
 
-void                  setup()
+      // Text reports go between the controller's frames; with telemetry streaming
+      // there is no gap to put them in
+      const uint32_t now = millis();
+#if !ROCKET_TELEMETRY
+      if (framesOut)
+         reportCycles();
+      if (framesOut && now - reportAt >= REPORT_PERIOD_MS)
+      {
+         reportAt = now;
+         Serial.print(F("safety wcrt_us="));
+         Serial.print(safetyTiming.worstUs);
+         Serial.print(F(" late_us="));
+         Serial.print(safetyTiming.worstLateUs);
+         Serial.print(F(" overruns="));
+         Serial.print(safetyTiming.overruns);
+         Serial.print(F(" runs="));
+         Serial.print(safetyTiming.runs);
+         Serial.print(F(" ui_dropped="));
+         Serial.println(uiInterface->getDropped());
+      }
+#else
+      (void)now;
+      (void)reportAt;
+      (void)framesOut;
+#endif
+      vTaskDelay(pdMS_TO_TICKS(5));
+   }
+}
+#endif
+
+void setup()
 {
    // Create hardware interface
    arduinoInterface = new RealArduinoInterface();
 
    // Create rocket controller
+#if ROCKET_RTOS
+   uiInterface      = new QueuedUiInterface(arduinoInterface);
+   rocketController = new RocketController(uiInterface);
+#elif ROCKET_TRAFFIC
+   trafficInterface = new TrafficCounter(arduinoInterface);
+   rocketController = new RocketController(trafficInterface);
+#else
    rocketController = new RocketController(arduinoInterface);
+#endif
+   rocketController->setRangeMode(ROCKET_RANGE_MODE);
+   rocketController->setRelayPulseMs(ROCKET_RELAY_MS);
+
+   // Camera shutter half a second before ignition, strobe with the relay
+   rocketController->addAuxChannel(10, -500, 200); // PIN_AUX_CAMERA
+   rocketController->addAuxChannel(11, 0, 100);    // PIN_AUX_STROBE
+
+   // Cycle-time reports and telemetry
+   Serial.begin(115200);
+#if ROCKET_HAL_CONFORMANCE
+   runHalConformance();
+#endif
+   rocketController->setTelemetry(ROCKET_TELEMETRY);
+   rocketController->setRawCapture(ROCKET_RAW_CAPTURE);
 
    // Start in SPLASH state
    rocketController->enter(State::SPLASH);
+
+#if ROCKET_RTOS
+   xTaskCreate(safetyTask, "safety", 1024, nullptr, configMAX_PRIORITIES - 1, nullptr);
+   xTaskCreate(audioTask, "audio", 256, nullptr, 2, nullptr);
+   xTaskCreate(displayTask, "display", 512, nullptr, 1, nullptr);
+   vTaskStartScheduler(); // does not return
+#endif
 }
 
 void loop()
 {
+#if !ROCKET_RTOS
    // Update hardware interface
    arduinoInterface->updateDebouncers();
 
    // Update rocket controller
+#if ROCKET_TRAFFIC
+   trafficInterface->beginTick(rocketController->getState());
+#endif
    rocketController->update(arduinoInterface->millis());
-}
\ No newline at end of file
+
+   reportCycles();
+#endif
+}
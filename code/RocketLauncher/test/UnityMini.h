@@ -0,0 +1,100 @@
+#ifndef UNITY_MINI_H
+#define UNITY_MINI_H
+
+#include <cmath>
+#include <iostream>
+
+// Minimal Unity test framework implementation for CMake builds
+// This avoids dependency on external Unity files; shared by every test executable
+namespace Unity {
+    inline int unity_current_test_failed = 0;
+    inline int unity_number_of_tests = 0;
+    inline int unity_number_of_failures = 0;
+    
+    void unity_begin(const char* filename);
+    void unity_end(void);
+    void unity_run_test(void (*test_func)(void), const char* test_name);
+}
+
+// Forward declarations for test setup/teardown
+void setUp(void);
+void tearDown(void);
+
+// Unity test framework - minimal implementation for CMake integration
+inline void Unity::unity_begin(const char* filename) {
+    std::cout << "Unity Test Framework" << std::endl;
+    std::cout << "===================" << std::endl;
+    std::cout << "Running tests from: " << filename << std::endl << std::endl;
+    
+    unity_current_test_failed = 0;
+    unity_number_of_tests = 0;
+    unity_number_of_failures = 0;
+}
+
+inline void Unity::unity_end(void) {
+    std::cout << std::endl << "===================" << std::endl;
+    std::cout << "Test Results:" << std::endl;
+    std::cout << "Tests Run: " << unity_number_of_tests << std::endl;
+    std::cout << "Failures: " << unity_number_of_failures << std::endl;
+    
+    if (unity_number_of_failures == 0) {
+        std::cout << "All tests passed!" << std::endl;
+    } else {
+        std::cout << "Some tests failed!" << std::endl;
+    }
+}
+
+inline void Unity::unity_run_test(void (*test_func)(void), const char* test_name) {
+    std::cout << "Running test: " << test_name << std::endl;
+    
+    unity_current_test_failed = 0;
+    
+    // Call setUp and tearDown if they exist
+    setUp();
+    test_func();
+    tearDown();
+    
+    if (unity_current_test_failed) {
+        std::cout << "  ❌ FAILED" << std::endl;
+    } else {
+        std::cout << "  ✅ PASSED" << std::endl;
+    }
+}
+
+// Unity test macros
+#define TEST_ASSERT(condition) \
+    do { \
+        if (!(condition)) { \
+            Unity::unity_current_test_failed = 1; \
+            Unity::unity_number_of_failures++; \
+        } \
+        Unity::unity_number_of_tests++; \
+    } while(0)
+
+#define TEST_ASSERT_EQUAL(expected, actual) \
+    TEST_ASSERT((expected) == (actual))
+
+#define TEST_ASSERT_TRUE(condition) \
+    TEST_ASSERT(condition)
+
+#define TEST_ASSERT_FALSE(condition) \
+    TEST_ASSERT(!(condition))
+
+#define TEST_ASSERT_NULL(pointer) \
+    TEST_ASSERT((pointer) == nullptr)
+
+#define TEST_ASSERT_NOT_NULL(pointer) \
+    TEST_ASSERT((pointer) != nullptr)
+
+#define TEST_ASSERT_LESS_OR_EQUAL(expected, actual) \
+    TEST_ASSERT((actual) <= (expected))
+
+#define TEST_ASSERT_FLOAT_WITHIN(delta, expected, actual) \
+    TEST_ASSERT(std::fabs((double)(actual) - (double)(expected)) <= (double)(delta))
+
+// Unity test runner macros
+#define UNITY_BEGIN() Unity::unity_begin(__FILE__)
+#define UNITY_END() Unity::unity_end()
+#define RUN_TEST(test_func) Unity::unity_run_test(test_func, #test_func)
+
+#endif // UNITY_MINI_H
@@ -3,100 +3,17 @@
 #include <iostream>
 #include "../src/RocketController.h"
 #include "../src/ArduinoInterface.h"
-
-// Minimal Unity test framework implementation for CMake builds
-// This avoids dependency on external Unity files
-namespace Unity {
-    extern int unity_current_test_failed;
-    extern int unity_number_of_tests;
-    extern int unity_number_of_failures;
-    
-    void unity_begin(const char* filename);
-    void unity_end(void);
-    void unity_run_test(void (*test_func)(void), const char* test_name);
-}
-
-// Forward declarations for test setup/teardown
-void setUp(void);
-void tearDown(void);
-
-// Unity test framework - minimal implementation for CMake integration
-int Unity::unity_current_test_failed = 0;
-int Unity::unity_number_of_tests = 0;
-int Unity::unity_number_of_failures = 0;
-
-void Unity::unity_begin(const char* filename) {
-    std::cout << "Unity Test Framework" << std::endl;
-    std::cout << "===================" << std::endl;
-    std::cout << "Running tests from: " << filename << std::endl << std::endl;
-    
-    unity_current_test_failed = 0;
-    unity_number_of_tests = 0;
-    unity_number_of_failures = 0;
-}
-
-void Unity::unity_end(void) {
-    std::cout << std::endl << "===================" << std::endl;
-    std::cout << "Test Results:" << std::endl;
-    std::cout << "Tests Run: " << unity_number_of_tests << std::endl;
-    std::cout << "Failures: " << unity_number_of_failures << std::endl;
-    
-    if (unity_number_of_failures == 0) {
-        std::cout << "All tests passed!" << std::endl;
-    } else {
-        std::cout << "Some tests failed!" << std::endl;
-    }
-}
-
-void Unity::unity_run_test(void (*test_func)(void), const char* test_name) {
-    std::cout << "Running test: " << test_name << std::endl;
-    
-    unity_current_test_failed = 0;
-    
-    // Call setUp and tearDown if they exist
-    setUp();
-    test_func();
-    tearDown();
-    
-    if (unity_current_test_failed) {
-        std::cout << "  ❌ FAILED" << std::endl;
-    } else {
-        std::cout << "  ✅ PASSED" << std::endl;
-    }
-}
-
-// Unity test macros
-#define TEST_ASSERT(condition) \
-    do { \
-        if (!(condition)) { \
-            Unity::unity_current_test_failed = 1; \
-            Unity::unity_number_of_failures++; \
-        } \
-        Unity::unity_number_of_tests++; \
-    } while(0)
-
-#define TEST_ASSERT_EQUAL(expected, actual) \
-    TEST_ASSERT((expected) == (actual))
-
-#define TEST_ASSERT_TRUE(condition) \
-    TEST_ASSERT(condition)
-
-#define TEST_ASSERT_FALSE(condition) \
-    TEST_ASSERT(!(condition))
-
-#define TEST_ASSERT_NULL(pointer) \
-    TEST_ASSERT((pointer) == nullptr)
-
-#define TEST_ASSERT_NOT_NULL(pointer) \
-    TEST_ASSERT((pointer) != nullptr)
-
-#define TEST_ASSERT_LESS_OR_EQUAL(expected, actual) \
-    TEST_ASSERT((actual) <= (expected))
-
-// Unity test runner macros
-#define UNITY_BEGIN() Unity::unity_begin(__FILE__)
-#define UNITY_END() Unity::unity_end()
-#define RUN_TEST(test_func) Unity::unity_run_test(test_func, #test_func)
+#include "../src/AdaptiveDebouncer.h"
+#include "../src/RamIntegrity.h"
+#include "../src/SerialFrame.h"
+#include "../src/EepromQueue.h"
+#include "../src/FastLcd.h"
+#include "../src/QueuedUiInterface.h"
+#include "../src/RelayDrive.h"
+#include "../src/HalConformance.h"
+#include "../src/TrafficCounter.h"
+#include "../src/LaunchInterlock.h"
+#include "UnityMini.h"
 
 // Simple mock Arduino interface for testing
 class MockArduinoInterface : public ArduinoInterface
@@ -109,6 +26,8 @@ class MockArduinoInterface : public ArduinoInterface
    uint16_t         mock_tone_freq = 0;
    char             mock_lcd_line1[32] = "";
    char             mock_lcd_line2[32] = "";
+   uint8_t          mock_lcd_col = 0;
+   uint8_t          mock_lcd_row = 0;
    
    // Mock button states
    bool             mock_arm_pressed = false;
@@ -173,37 +92,38 @@ class MockArduinoInterface : public ArduinoInterface
    {
       mock_lcd_line1[0] = '\0';
       mock_lcd_line2[0] = '\0';
+      mock_lcd_col = 0;
+      mock_lcd_row = 0;
    }
    
    void lcdSetCursor(uint8_t col, uint8_t row) override
    {
-      (void)col;  // Suppress unused parameter warning
-      (void)row;  // Suppress unused parameter warning
-      // Mock implementation
+      mock_lcd_col = col;
+      mock_lcd_row = row;
    }
    
    void lcdPrint(const char* text) override
    {
-      if (strlen(mock_lcd_line1) == 0)
-      {
-         strncpy(mock_lcd_line1, text, 31);
-      }
-      else
+      // Written at the cursor, which moves past the text, as on the real display
+      char*  line = mock_lcd_row == 0 ? mock_lcd_line1 : mock_lcd_line2;
+      size_t len  = strlen(line);
+      while (*text && mock_lcd_col < 31)
       {
-         strncpy(mock_lcd_line2, text, 31);
+         while (len < mock_lcd_col)
+            line[len++] = ' ';
+         line[mock_lcd_col] = *text++;
+         if (mock_lcd_col == len)
+            len++;
+         mock_lcd_col++;
       }
+      line[len] = '\0';
    }
    
    void lcdPrint(int number) override
    {
-      if (strlen(mock_lcd_line1) == 0)
-      {
-         snprintf(mock_lcd_line1, 32, "%d", number);
-      }
-      else
-      {
-         snprintf(mock_lcd_line2, 32, "%d", number);
-      }
+      char text[12];
+      snprintf(text, sizeof(text), "%d", number);
+      lcdPrint(text);
    }
    
    // Button debouncing
@@ -249,6 +169,8 @@ class MockArduinoInterface : public ArduinoInterface
       mock_tone_freq = 0;
       mock_lcd_line1[0] = '\0';
       mock_lcd_line2[0] = '\0';
+      mock_lcd_col = 0;
+      mock_lcd_row = 0;
       mock_arm_pressed = false;
       mock_reset_pressed = false;
       mock_launch_pressed = false;
@@ -260,6 +182,49 @@ class MockArduinoInterface : public ArduinoInterface
    }
 };
 
+// Mock with an EEPROM that programs every queued byte on the next update
+class PersistingMockInterface : public MockArduinoInterface
+{
+ public:
+   uint8_t     eeprom[64];
+   EepromQueue queue;
+   uint8_t     relayAtPersist = 0xFF; // relay level when the last record was queued
+
+   PersistingMockInterface()
+   {
+      memset(eeprom, 0xFF, sizeof(eeprom));
+   }
+
+   bool persist(uint16_t addr, const uint8_t* data, uint8_t len) override
+   {
+      relayAtPersist = getPinState(8);
+      return queue.write(addr, data, len);
+   }
+
+   bool recall(uint16_t addr, uint8_t* data, uint8_t len) const override
+   {
+      memcpy(data, eeprom + addr, len);
+      return true;
+   }
+
+   void persistFlush() override
+   {
+      uint16_t addr;
+      uint8_t  value;
+      while (queue.pop(addr, value))
+      {
+         if (eeprom[addr] == value)
+         {
+            queue.skipped();
+            continue;
+         }
+         queue.started();
+         eeprom[addr] = value;
+         queue.programmed();
+      }
+   }
+};
+
 // Test fixture
 MockArduinoInterface* mockInterface;
 RocketController*     controller;
@@ -374,6 +339,1104 @@ void test_manual_state_management(void)
    TEST_ASSERT_FALSE(controller->isLaunching());
 }
 
+// Test 5: Compile-time tone divisors
+void test_tone_timer_divisors(void)
+{
+   // 2 kHz on a 16 MHz clock: 4000 ticks per half period at clk/1
+   constexpr ToneTimer t2000 = toneTimerFor(2000, 16000000UL);
+   static_assert(t2000.clockSelect == 1 && t2000.top == 3999, "2 kHz divisor");
+
+   // Low notes need a prescaler to fit the 16-bit compare register
+   ToneTimer t100 = toneTimerFor(100, 16000000UL);
+   TEST_ASSERT_EQUAL(2, t100.clockSelect);
+   TEST_ASSERT_EQUAL(9999, t100.top);
+
+   // Silence disables the timer
+   TEST_ASSERT_EQUAL(0, toneTimerFor(0).clockSelect);
+
+   // Sequence notes carry their divisor
+   TEST_ASSERT_EQUAL(1, SND_LAUNCH[0].timer.clockSelect);
+   TEST_ASSERT_EQUAL(toneTimerFor(1800).top, SND_LAUNCH[0].timer.top);
+}
+
+// Test 6: Buzzer drives the interface with the precomputed note
+void test_buzzer_plays_sequence_notes(void)
+{
+   controller->playBuzzerSequence(SND_LAUNCH, 1, false);
+   controller->update(0);
+   TEST_ASSERT_TRUE(mockInterface->isToneActive());
+   TEST_ASSERT_EQUAL(1800, mockInterface->getToneFreq());
+
+   // Single note without gap finishes after its duration
+   controller->update(SND_LAUNCH[0].ms);
+   TEST_ASSERT_FALSE(mockInterface->isToneActive());
+}
+
+// Drive one press with the given bounce duration (edges every 1ms), then hold and release cleanly
+static uint32_t pressWithBounce(AdaptiveDebouncer& db, uint32_t t, uint8_t bounceMs)
+{
+   bool level = false;
+   for (uint8_t i = 0; i <= bounceMs; i++)
+   {
+      db.update(level, t++);
+      level = !level;
+   }
+   for (int i = 0; i < 50; i++)
+      db.update(false, t++);
+   for (int i = 0; i < 50; i++)
+      db.update(true, t++);
+   return t;
+}
+
+// Test 7: Clean switch earns a short settle window
+void test_debouncer_learns_clean_switch(void)
+{
+   AdaptiveDebouncer db;
+   db.begin(true, 0);
+   TEST_ASSERT_EQUAL(AdaptiveDebouncer::DEFAULT_WINDOW_MS, db.windowMs());
+
+   uint32_t t = 0;
+   for (int i = 0; i < 8; i++)
+      t = pressWithBounce(db, t, 0);
+
+   TEST_ASSERT_EQUAL(AdaptiveDebouncer::MIN_WINDOW_MS, db.windowMs());
+   TEST_ASSERT_FALSE(db.isWorn());
+
+   // A press is now accepted after the short window
+   uint32_t pressedAt = t;
+   while (!db.update(false, t))
+      t++;
+   TEST_ASSERT_LESS_OR_EQUAL(AdaptiveDebouncer::MIN_WINDOW_MS, t - pressedAt);
+   TEST_ASSERT_FALSE(db.read());
+}
+
+// Test 8: Worn switch gets a longer window and is flagged
+void test_debouncer_flags_worn_switch(void)
+{
+   AdaptiveDebouncer db;
+   db.begin(true, 0);
+
+   uint32_t t = 0;
+   for (int i = 0; i < 8; i++)
+      t = pressWithBounce(db, t, 12);
+
+   TEST_ASSERT_TRUE(db.isWorn());
+   TEST_ASSERT_EQUAL(12 + AdaptiveDebouncer::MARGIN_MS, db.windowMs());
+
+   // Bounce never leaks through as extra edges
+   int edges = 0;
+   bool level = false;
+   for (uint8_t i = 0; i <= 12; i++)
+   {
+      edges += db.update(level, t++) ? 1 : 0;
+      level = !level;
+   }
+   for (int i = 0; i < 50; i++)
+      edges += db.update(false, t++) ? 1 : 0;
+   TEST_ASSERT_EQUAL(1, edges);
+}
+
+// Step the controller in 10ms ticks for the given duration
+static uint32_t runFor(uint32_t t, uint32_t ms)
+{
+   for (uint32_t end = t + ms; t < end;)
+   {
+      t += 10;
+      mockInterface->setMockTime(t);
+      controller->update(t);
+   }
+   return t;
+}
+
+// Test 9: A normal launch never trips the safety monitor
+void test_monitor_allows_normal_launch(void)
+{
+   controller->enter(State::READY);
+   mockInterface->setArmPressed(true);
+   uint32_t t = runFor(0, 100);
+   TEST_ASSERT_EQUAL(State::ARMED, controller->getState());
+
+   mockInterface->setLaunchPressed(true);
+   t = runFor(t, 300);
+   TEST_ASSERT_EQUAL(State::LAUNCH_COUNTDOWN, controller->getState());
+
+   t = runFor(t, RocketController::HOLD_TO_LAUNCH_MS);
+   TEST_ASSERT_EQUAL(State::LAUNCHING, controller->getState());
+   TEST_ASSERT_EQUAL(HIGH, mockInterface->getPinState(8));
+
+   t = runFor(t, RocketController::RELAY_ON_MS);
+   TEST_ASSERT_EQUAL(State::COOLDOWN, controller->getState());
+   TEST_ASSERT_EQUAL(LOW, mockInterface->getPinState(8));
+   TEST_ASSERT_EQUAL(SafetyMonitor::Violation::NONE, controller->getLastViolation());
+}
+
+// Test 10: Relay energised outside LAUNCHING forces FAULT with outputs safe
+void test_monitor_trips_on_stray_relay(void)
+{
+   controller->enter(State::READY);
+   runFor(0, 50);
+
+   mockInterface->digitalWrite(8, HIGH);
+   mockInterface->digitalWrite(7, HIGH);
+   runFor(50, 10);
+
+   TEST_ASSERT_EQUAL(State::FAULT, controller->getState());
+   TEST_ASSERT_EQUAL(LOW, mockInterface->getPinState(8));
+   TEST_ASSERT_EQUAL(LOW, mockInterface->getPinState(7));
+   TEST_ASSERT_EQUAL(SafetyMonitor::Violation::RELAY_OUTSIDE_LAUNCHING,
+                     controller->getLastViolation());
+
+   // The FAULT screen carries the cause and is drawn once
+   TEST_ASSERT_EQUAL(0, strcmp(mockInterface->getLCDLine1(), "FAULT: MONITOR"));
+   TrafficCounter   traffic(mockInterface);
+   RocketController rc(&traffic);
+   rc.enter(State::READY);
+   mockInterface->digitalWrite(8, HIGH);
+   traffic.beginTick(State::READY);
+   rc.update(100);
+   TEST_ASSERT_EQUAL(State::FAULT, rc.getState());
+   TEST_ASSERT_EQUAL(1u, traffic.calls(State::READY, TrafficCounter::LCD_CLEAR));
+}
+
+// Test 11: LAUNCHING without the countdown hold is a violation
+void test_monitor_trips_on_launch_without_hold(void)
+{
+   controller->enter(State::ARMED);
+   runFor(0, 50);
+
+   controller->enter(State::LAUNCHING);
+   runFor(50, 10);
+
+   TEST_ASSERT_EQUAL(State::FAULT, controller->getState());
+   TEST_ASSERT_EQUAL(LOW, mockInterface->getPinState(8));
+   TEST_ASSERT_EQUAL(SafetyMonitor::Violation::LAUNCH_WITHOUT_HOLD, controller->getLastViolation());
+}
+
+// Test 12: Complemented storage detects a flipped bit
+void test_redundant_detects_bit_flip(void)
+{
+   Redundant<uint32_t> cell(12345);
+   TEST_ASSERT_TRUE(cell.intact());
+   TEST_ASSERT_EQUAL(12345u, cell.get());
+
+   uint8_t raw[sizeof(cell)];
+   memcpy(raw, &cell, sizeof(cell));
+   raw[1] ^= 0x10;
+   memcpy(&cell, raw, sizeof(cell));
+   TEST_ASSERT_FALSE(cell.intact());
+}
+
+// Test 13: Background CRC finds corruption within one pass
+void test_incremental_crc_detects_corruption(void)
+{
+   uint8_t region[40];
+   for (uint8_t i = 0; i < sizeof(region); i++)
+      region[i] = i * 7;
+
+   IncrementalCrc crc;
+   TEST_ASSERT_TRUE(crc.addRegion(region, sizeof(region)));
+   crc.seal();
+
+   // Clean passes match
+   for (int i = 0; i < 30; i++)
+      TEST_ASSERT_TRUE(crc.step(4));
+   TEST_ASSERT_EQUAL(3, crc.completedPasses());
+
+   // A flip is reported no later than the end of the following pass
+   region[33] ^= 0x01;
+   bool detected = false;
+   for (int i = 0; i < 20 && !detected; i++)
+      detected = !crc.step(4);
+   TEST_ASSERT_TRUE(detected);
+}
+
+// Test 14: Controller state reads back through the redundant encoding
+void test_controller_redundant_state(void)
+{
+   TEST_ASSERT_EQUAL(State::STARTUP, controller->getState());
+   controller->enter(State::COOLDOWN);
+   TEST_ASSERT_EQUAL(State::COOLDOWN, controller->getState());
+
+   // Long run of ticks never reports a false integrity fault
+   runFor(0, 2000);
+   TEST_ASSERT_EQUAL(0, controller->getIntegrityFaults());
+}
+
+// Test 15: Range mode turns a clean fire around with only a disarm
+void test_range_mode_clean_fire_returns_to_ready(void)
+{
+   controller->setRangeMode(true);
+   controller->enter(State::READY);
+   mockInterface->setArmPressed(true);
+   uint32_t t = runFor(0, 100);
+   mockInterface->setLaunchPressed(true);
+   t = runFor(t, 300 + RocketController::HOLD_TO_LAUNCH_MS + RocketController::RELAY_ON_MS);
+   TEST_ASSERT_EQUAL(State::COOLDOWN, controller->getState());
+
+   // Short cooldown, then held there until ARM opens
+   t = runFor(t, RocketController::RANGE_COOLDOWN_MS + 100);
+   TEST_ASSERT_EQUAL(State::COOLDOWN, controller->getState());
+
+   mockInterface->setArmPressed(false);
+   mockInterface->setLaunchPressed(false);
+   t = runFor(t, 20);
+   TEST_ASSERT_EQUAL(State::READY, controller->getState());
+   TEST_ASSERT_EQUAL(1, controller->getLaunchCount());
+   TEST_ASSERT_EQUAL(t - 20, controller->getLastCycleMs()); // armed at t=10, READY a tick ago
+   TEST_ASSERT_EQUAL(0, controller->getIntegrityFaults());
+}
+
+// Test 16: Aux channels fire relative to the real ignition and keep their width when late
+void test_aux_channels_follow_ignition(void)
+{
+   AuxScheduler aux(mockInterface);
+   TEST_ASSERT_TRUE(aux.addChannel(10, -500, 200));
+   TEST_ASSERT_TRUE(aux.addChannel(11, 0, 100));
+
+   aux.arm(5000);
+   aux.service(4499);
+   TEST_ASSERT_EQUAL(LOW, mockInterface->getPinState(10));
+   aux.service(4500);
+   TEST_ASSERT_EQUAL(HIGH, mockInterface->getPinState(10));
+   aux.service(4700);
+   TEST_ASSERT_EQUAL(LOW, mockInterface->getPinState(10));
+
+   // Relay closed 7ms after the predicted T0: the strobe follows the relay, not the prediction
+   aux.service(5003);
+   TEST_ASSERT_EQUAL(LOW, mockInterface->getPinState(11));
+   aux.ignite(5007);
+   TEST_ASSERT_EQUAL(HIGH, mockInterface->getPinState(11));
+   aux.service(5106);
+   TEST_ASSERT_EQUAL(HIGH, mockInterface->getPinState(11));
+   aux.service(5107);
+   TEST_ASSERT_EQUAL(LOW, mockInterface->getPinState(11));
+   TEST_ASSERT_FALSE(aux.isBusy());
+
+   // Cancel drops pending pulses
+   aux.arm(9000);
+   aux.service(8600);
+   aux.cancel();
+   TEST_ASSERT_EQUAL(LOW, mockInterface->getPinState(10));
+   aux.service(9000);
+   TEST_ASSERT_EQUAL(LOW, mockInterface->getPinState(11));
+}
+
+// Test 17: Capture ring keeps 24-bit samples in order and counts what it could not take
+void test_load_cell_capture_counts_drops(void)
+{
+   LoadCellCapture cap;
+   cap.push(5); // not capturing yet
+   cap.begin();
+   TEST_ASSERT_EQUAL(0, cap.available());
+
+   for (uint16_t i = 0; i < LoadCellCapture::CAPACITY + 3; i++)
+      cap.push(i == 0 ? -8388608 : (int32_t)i * 100);
+   cap.missed(2);
+   TEST_ASSERT_EQUAL(LoadCellCapture::CAPACITY, cap.available());
+   TEST_ASSERT_EQUAL(LoadCellCapture::CAPACITY, cap.captured());
+   TEST_ASSERT_EQUAL(5, cap.dropped());
+
+   int32_t out[4];
+   TEST_ASSERT_EQUAL(4, cap.read(out, 4));
+   TEST_ASSERT_EQUAL(-8388608, out[0]);
+   TEST_ASSERT_EQUAL(300, out[3]);
+
+   // Space freed by the reader is reused
+   cap.push(-42);
+   TEST_ASSERT_EQUAL(LoadCellCapture::CAPACITY - 3, cap.available());
+   cap.end();
+   cap.push(1);
+   TEST_ASSERT_EQUAL(5, cap.dropped());
+}
+
+// Test 18: Frames survive the round trip and corrupted ones are rejected
+void test_serial_frame_round_trip(void)
+{
+   uint8_t  payload[7];
+   uint8_t* p = framePutU32(payload, 0x12345678);
+   framePutU24(p, (uint32_t)-1234);
+
+   uint8_t       frame[FRAME_OVERHEAD + sizeof(payload) + 2] = {'x', 'y'};
+   const uint8_t len = encodeFrame(frame + 2, FRAME_CAPTURE_DATA, payload, sizeof(payload));
+   TEST_ASSERT_EQUAL(FRAME_OVERHEAD + sizeof(payload), len);
+
+   FrameDecoder dec;
+   int          frames = 0;
+   for (uint8_t i = 0; i < len + 2; i++)
+      frames += dec.feed(frame[i]) ? 1 : 0;
+   TEST_ASSERT_EQUAL(1, frames);
+   TEST_ASSERT_EQUAL(FRAME_CAPTURE_DATA, dec.type());
+   TEST_ASSERT_EQUAL(0x12345678u, frameGetU32(dec.payload()));
+   TEST_ASSERT_EQUAL(-1234, frameGetS24(dec.payload() + 4));
+
+   frame[6] ^= 0x01;
+   frames = 0;
+   for (uint8_t i = 0; i < len + 2; i++)
+      frames += dec.feed(frame[i]) ? 1 : 0;
+   TEST_ASSERT_EQUAL(0, frames);
+   TEST_ASSERT_EQUAL(1u, dec.errorCount());
+}
+
+// Test 19: Telemetry snapshot reports what the controller acted on and drove
+void test_telemetry_snapshot_round_trip(void)
+{
+   mockInterface->setMockTime(0);
+   controller->setTelemetry(true);
+   controller->enter(State::READY);
+   mockInterface->setArmPressed(true);
+   controller->update(1);
+
+   TelemetrySample s = controller->telemetrySnapshot(1);
+   TEST_ASSERT_EQUAL((uint8_t)State::ARMED, s.state);
+   TEST_ASSERT_EQUAL(INPUT_BIT_ARM, s.inputs);
+   TEST_ASSERT_EQUAL(TELEMETRY_OUT_ARMED, s.outputs);
+   TEST_ASSERT_EQUAL(0, s.flags);
+
+   s.seq  = 513;
+   s.lost = 2;
+   uint8_t payload[TELEMETRY_PAYLOAD];
+   TEST_ASSERT_EQUAL(TELEMETRY_PAYLOAD, encodeTelemetry(payload, s));
+   TelemetrySample back;
+   TEST_ASSERT_TRUE(decodeTelemetry(payload, sizeof(payload), back));
+   TEST_ASSERT_TRUE(sameTelemetry(s, back));
+   TEST_ASSERT_EQUAL(513, back.seq);
+   TEST_ASSERT_EQUAL(1u, back.ms);
+   TEST_ASSERT_EQUAL(2, back.lost);
+   TEST_ASSERT_FALSE(decodeTelemetry(payload, TELEMETRY_PAYLOAD - 1, back));
+}
+
+// Test 20: Relay pulse is clamped, honoured in LAUNCHING and accepted by the monitor
+void test_relay_pulse_configurable(void)
+{
+   controller->setRelayPulseMs(10);
+   TEST_ASSERT_EQUAL(RocketController::MIN_RELAY_PULSE_MS, controller->getRelayPulseMs());
+   controller->setRelayPulseMs(60000);
+   TEST_ASSERT_EQUAL(RocketController::RELAY_ON_MS, controller->getRelayPulseMs());
+   controller->setRelayPulseMs(400);
+   TEST_ASSERT_EQUAL(400, controller->getRelayPulseMs());
+
+   controller->enter(State::READY);
+   mockInterface->setArmPressed(true);
+   uint32_t t = runFor(0, 100);
+   mockInterface->setLaunchPressed(true);
+   while (controller->getState() != State::LAUNCHING && t < 10000)
+      t = runFor(t, 10);
+   TEST_ASSERT_EQUAL(HIGH, mockInterface->getPinState(8));
+
+   const uint32_t closedAt = t;
+   while (controller->getState() == State::LAUNCHING && t < 10000)
+      t = runFor(t, 10);
+   TEST_ASSERT_EQUAL(400u, t - closedAt);
+   TEST_ASSERT_EQUAL(State::COOLDOWN, controller->getState());
+   TEST_ASSERT_EQUAL(LOW, mockInterface->getPinState(8));
+   TEST_ASSERT_EQUAL(SafetyMonitor::Violation::NONE, controller->getLastViolation());
+}
+
+// Test 21: EEPROM queue merges rewrites, rejects records it cannot hold whole
+void test_eeprom_queue_merges_and_rejects(void)
+{
+   EepromQueue    q;
+   const uint8_t  a[4] = {1, 2, 3, 4};
+   const uint8_t  b[2] = {9, 8};
+   TEST_ASSERT_TRUE(q.write(10, a, 4));
+   TEST_ASSERT_TRUE(q.write(12, b, 2)); // both bytes already queued
+   TEST_ASSERT_EQUAL(4, q.pending());
+   TEST_ASSERT_EQUAL(2u, q.getMerges());
+
+   uint8_t big[EepromQueue::CAPACITY];
+   memset(big, 0x55, sizeof(big));
+   TEST_ASSERT_FALSE(q.write(100, big, sizeof(big)));
+   TEST_ASSERT_EQUAL(4, q.pending());
+
+   uint16_t addr;
+   uint8_t  value;
+   const uint8_t expect[4] = {1, 2, 9, 8};
+   for (uint8_t i = 0; i < 4; i++)
+   {
+      TEST_ASSERT_TRUE(q.pop(addr, value));
+      TEST_ASSERT_EQUAL(10 + i, addr);
+      TEST_ASSERT_EQUAL(expect[i], value);
+      q.started();
+      TEST_ASSERT_FALSE(q.isIdle());
+      q.programmed();
+   }
+   TEST_ASSERT_FALSE(q.pop(addr, value));
+   TEST_ASSERT_TRUE(q.isIdle());
+   TEST_ASSERT_EQUAL(4u, q.getWrites());
+}
+
+// Test 22: Lifetime log is queued after the relay is driven and survives a restart
+void test_launch_log_persists(void)
+{
+   PersistingMockInterface hal;
+   RocketController*       rc = new RocketController(&hal);
+   TEST_ASSERT_EQUAL(0u, rc->getLaunchLog().fires);
+
+   rc->enter(State::READY);
+   hal.setArmPressed(true);
+   uint32_t t = 0;
+   for (; t < 100; t += 10)
+   {
+      hal.setMockTime(t);
+      rc->update(t);
+   }
+   hal.setLaunchPressed(true);
+   while (rc->getState() != State::LAUNCHING && t < 10000)
+   {
+      t += 10;
+      hal.setMockTime(t);
+      rc->update(t);
+   }
+   TEST_ASSERT_EQUAL(1u, rc->getLaunchLog().fires);
+   TEST_ASSERT_EQUAL(HIGH, hal.relayAtPersist);
+   TEST_ASSERT_EQUAL(LAUNCH_LOG_BYTES, hal.queue.pending());
+
+   hal.persistFlush();
+   TEST_ASSERT_TRUE(hal.persistIdle());
+   const uint32_t written = hal.queue.getWrites();
+   delete rc;
+
+   // Same record again: nothing new to program
+   rc = new RocketController(&hal);
+   TEST_ASSERT_EQUAL(1u, rc->getLaunchLog().fires);
+   TEST_ASSERT_EQUAL(0, rc->getLaunchLog().faults);
+   uint8_t raw[LAUNCH_LOG_BYTES];
+   encodeLaunchLog(raw, rc->getLaunchLog());
+   TEST_ASSERT_TRUE(hal.persist(LAUNCH_LOG_ADDR, raw, sizeof(raw)));
+   hal.persistFlush();
+   TEST_ASSERT_EQUAL(written, hal.queue.getWrites());
+   TEST_ASSERT_EQUAL(LAUNCH_LOG_BYTES, hal.queue.getSkips());
+   delete rc;
+}
+
+// Nibbles a FastLcd put on the bus, as (rs << 4) | nibble
+static uint8_t  lcdBus[256];
+static uint16_t lcdBusLen = 0;
+
+static void recordNibble(uint8_t nibble, bool rs)
+{
+   if (lcdBusLen < sizeof(lcdBus))
+      lcdBus[lcdBusLen++] = (uint8_t)((rs ? 0x10 : 0) | nibble);
+}
+
+// Test 23: Fast LCD queues without writing and clocks out one byte per tick
+void test_fast_lcd_queues_and_paces(void)
+{
+   FastLcd lcd(recordNibble);
+   lcdBusLen = 0;
+   lcd.begin(16, 2);
+   TEST_ASSERT_EQUAL(0, lcdBusLen); // nothing on the bus from the caller
+   while (!lcd.idle())
+      lcd.service();
+   // 4 init nibbles, then function set, display on, clear, entry mode as pairs
+   TEST_ASSERT_EQUAL(12, lcdBusLen);
+   TEST_ASSERT_EQUAL(0x03, lcdBus[0]);
+   TEST_ASSERT_EQUAL(0x02, lcdBus[3]);
+   TEST_ASSERT_EQUAL(0x02, lcdBus[4]);
+   TEST_ASSERT_EQUAL(0x08, lcdBus[5]);
+
+   // Clear holds the bus for 1.5 ms; the cursor move and text follow a byte per tick
+   lcdBusLen = 0;
+   lcd.clear();
+   lcd.setCursor(3, 1);
+   lcd.print(-7);
+   uint16_t ticks = 0;
+   while (!lcd.idle())
+   {
+      lcd.service();
+      ticks++;
+   }
+   TEST_ASSERT_EQUAL(8, lcdBusLen);
+   TEST_ASSERT_EQUAL(0x0C, lcdBus[2]); // DDRAM 0x43
+   TEST_ASSERT_EQUAL(0x03, lcdBus[3]);
+   TEST_ASSERT_EQUAL(0x12, lcdBus[4]); // '-' with RS
+   TEST_ASSERT_EQUAL(0x1D, lcdBus[5]);
+   TEST_ASSERT_EQUAL(0x17, lcdBus[7]); // '7'
+   TEST_ASSERT_EQUAL(1 + 15 + 1 + 1 + 1, ticks);
+}
+
+// Test 24: Through the queued UI, the relay acts at once and the LCD only when drained
+void test_queued_ui_defers_display(void)
+{
+   QueuedUiInterface ui(mockInterface);
+   RocketController  rc(&ui);
+   rc.enter(State::READY);
+   mockInterface->setArmPressed(true);
+   rc.update(10);
+   TEST_ASSERT_EQUAL(State::ARMED, rc.getState());
+   TEST_ASSERT_EQUAL(HIGH, mockInterface->getPinState(6)); // armed LED straight through
+   TEST_ASSERT_EQUAL(0u, strlen(mockInterface->getLCDLine1()));
+
+   TEST_ASSERT_TRUE(ui.drainLcd(100) > 0);
+   TEST_ASSERT_EQUAL(0, strcmp(mockInterface->getLCDLine1(), "ARMED"));
+   TEST_ASSERT_EQUAL(0, ui.drainLcd(100));
+
+   // Redraws faster than the display drains merge into the latest screen: nothing is
+   // dropped, and one drain costs a cursor move and a print per changed row
+   for (int i = 0; i < 100; i++)
+   {
+      ui.lcdClear();
+      ui.lcdSetCursor(0, 0);
+      ui.lcdPrint("FAULT");
+      ui.lcdSetCursor(0, 1);
+      ui.lcdPrint(i);
+   }
+   TEST_ASSERT_EQUAL(0u, ui.getDropped());
+   TEST_ASSERT_EQUAL(4, ui.drainLcd(100));
+   TEST_ASSERT_EQUAL(0, strcmp(mockInterface->getLCDLine1(), "FAULT"));
+   TEST_ASSERT_EQUAL(0, strncmp(mockInterface->getLCDLine2(), "99", 2));
+   ui.lcdSetCursor(0, 1);
+   ui.lcdPrint("99"); // already shown
+   TEST_ASSERT_EQUAL(0, ui.drainLcd(100));
+}
+
+// Test 25: A raw window keeps PRE samples before the trigger and POST after, then holds
+void test_raw_capture_freezes_window(void)
+{
+   RawCapture raw;
+   raw.begin();
+   TEST_ASSERT_FALSE(raw.isFrozen());
+
+   // A 1-sample glitch long before the trigger falls out of the ring
+   raw.sample(INPUT_BIT_LAUNCH);
+   for (uint16_t i = 0; i < RawCapture::SAMPLES; i++)
+      raw.sample(i % 3 == 0 ? INPUT_BIT_ARM : 0);
+   TEST_ASSERT_TRUE(raw.trigger(RawCapture::EDGE, 1234, 5));
+   for (uint16_t i = 0; i < RawCapture::POST - 1; i++)
+      raw.sample(INPUT_BIT_RESET);
+   TEST_ASSERT_FALSE(raw.isFrozen());
+   TEST_ASSERT_FALSE(raw.trigger(RawCapture::FAULT, 1240, 8)); // one window at a time
+   raw.sample(INPUT_BIT_RESET | INPUT_BIT_ARM);
+   TEST_ASSERT_TRUE(raw.isFrozen());
+
+   TEST_ASSERT_EQUAL(RawCapture::PRE, raw.preSamples());
+   TEST_ASSERT_EQUAL(RawCapture::SAMPLES, raw.samples());
+   TEST_ASSERT_EQUAL(RawCapture::EDGE, raw.reason());
+   TEST_ASSERT_EQUAL(1234u, raw.triggerMs());
+   TEST_ASSERT_EQUAL(1u, raw.missed());
+   for (uint16_t i = 0; i < RawCapture::PRE; i++)
+   {
+      const uint16_t n = (uint16_t)(RawCapture::SAMPLES - RawCapture::PRE + i);
+      TEST_ASSERT_EQUAL(n % 3 == 0 ? INPUT_BIT_ARM : 0, raw.level(i));
+   }
+   TEST_ASSERT_EQUAL(INPUT_BIT_RESET, raw.level(RawCapture::PRE));
+   TEST_ASSERT_EQUAL(INPUT_BIT_RESET | INPUT_BIT_ARM, raw.level(RawCapture::SAMPLES - 1));
+
+   // Frozen: the tick no longer writes; after rearm a window only has what came since
+   raw.sample(INPUT_BIT_LAUNCH);
+   TEST_ASSERT_EQUAL(INPUT_BIT_RESET | INPUT_BIT_ARM, raw.level(RawCapture::SAMPLES - 1));
+   raw.rearm();
+   for (uint8_t i = 0; i < 10; i++)
+      raw.sample(INPUT_BIT_LAUNCH);
+   TEST_ASSERT_TRUE(raw.trigger(RawCapture::ABORT, 2000, 7));
+   TEST_ASSERT_EQUAL(10, raw.preSamples());
+}
+
+// Test 26: The relay pin is high through the pull-in, then follows the hold duty
+static uint8_t relayPinLevel  = 0;
+static uint8_t relayPinWrites = 0;
+
+static void recordRelayPin(bool high)
+{
+   relayPinLevel = high ? 1 : 0;
+   relayPinWrites++;
+}
+
+void test_relay_drive_pulls_in_then_holds(void)
+{
+   RelayDrive drive(recordRelayPin);
+   drive.configure(3, 2, 5);
+   relayPinWrites = 0;
+
+   drive.set(true);
+   TEST_ASSERT_EQUAL(1, relayPinLevel);
+   TEST_ASSERT_TRUE(drive.isOn());
+   for (uint8_t i = 0; i < 3; i++)
+      drive.service();
+   TEST_ASSERT_EQUAL(1, relayPinWrites); // nothing written during the pull-in
+
+   const uint8_t expected[] = {1, 1, 0, 0, 0, 1, 1, 0, 0, 0};
+   for (uint8_t i = 0; i < sizeof(expected); i++)
+   {
+      drive.service();
+      TEST_ASSERT_EQUAL(expected[i], relayPinLevel);
+   }
+
+   // Opening is immediate, even in the middle of a hold period, and the tick leaves it be
+   drive.service();
+   drive.set(false);
+   TEST_ASSERT_EQUAL(0, relayPinLevel);
+   const uint8_t writes = relayPinWrites;
+   drive.service();
+   TEST_ASSERT_EQUAL(writes, relayPinWrites);
+   TEST_ASSERT_FALSE(drive.isOn());
+}
+
+// Test 27: The mock passes the HAL conformance suite; a pin that never reads back fails it
+class MockProbe : public HalProbe
+{
+ public:
+   explicit MockProbe(MockArduinoInterface* mock) : mock(mock)
+   {
+   }
+
+   bool toneFrequency(uint16_t& freq) override
+   {
+      freq = mock->isToneActive() ? mock->getToneFreq() : 0;
+      return true;
+   }
+
+   bool lcdRow(uint8_t row, char* text, uint8_t size) override
+   {
+      snprintf(text, size, "%s", row == 0 ? mock->getLCDLine1() : mock->getLCDLine2());
+      size_t len = strlen(text);
+      while (len > 0 && text[len - 1] == ' ')
+         text[--len] = '\0';
+      return true;
+   }
+
+   bool driveInputs(uint8_t mask) override
+   {
+      mock->setArmPressed(mask & INPUT_BIT_ARM);
+      mock->setResetPressed(mask & INPUT_BIT_RESET);
+      mock->setLaunchPressed(mask & INPUT_BIT_LAUNCH);
+      return true;
+   }
+
+ private:
+   MockArduinoInterface* mock;
+};
+
+class StuckPinMock : public MockArduinoInterface
+{
+ public:
+   uint8_t digitalRead(uint8_t pin) const override
+   {
+      (void)pin;
+      return LOW;
+   }
+};
+
+static uint32_t fakeNanos = 0;
+static uint8_t  reportLines = 0;
+
+static uint32_t stepNanos()
+{
+   return fakeNanos += 1000; // every batch takes 1 us
+}
+
+static void countReportLine(const char* line)
+{
+   (void)line;
+   reportLines++;
+}
+
+void test_hal_conformance_on_mock(void)
+{
+   MockProbe              probe(mockInterface);
+   HalConformance         suite(mockInterface, &probe, stepNanos);
+   HalConformance::Config config;
+   config.relayPin   = 8;
+   config.iterations = 10;
+   suite.run(config);
+
+   TEST_ASSERT_EQUAL(0, suite.count(HalConformance::FAIL));
+   TEST_ASSERT_EQUAL(0, suite.count(HalConformance::UNOBSERVABLE));
+   TEST_ASSERT_EQUAL(HalConformance::PASS, suite.result(HalConformance::LCD_SET_CURSOR));
+   TEST_ASSERT_EQUAL(HalConformance::NOT_CHECKED, suite.result(HalConformance::ATOMIC));
+   TEST_ASSERT_EQUAL(100u, suite.nanosPerCall(HalConformance::LCD_PRINT_TEXT));
+   TEST_ASSERT_EQUAL(HalConformance::NOT_TIMED, suite.nanosPerCall(HalConformance::DELAY));
+   TEST_ASSERT_EQUAL(LOW, mockInterface->getPinState(8));
+   TEST_ASSERT_FALSE(mockInterface->isToneActive());
+
+   reportLines = 0;
+   suite.report("mock", countReportLine);
+   TEST_ASSERT_EQUAL(2 + HalConformance::METHOD_COUNT, reportLines);
+
+   // Nothing to observe and no relay: those checks are n/a, the pins still fail
+   StuckPinMock   stuck;
+   HalProbe       blind;
+   HalConformance broken(&stuck, &blind, stepNanos);
+   broken.run(HalConformance::Config());
+   TEST_ASSERT_EQUAL(HalConformance::FAIL, broken.result(HalConformance::DIGITAL_WRITE));
+   TEST_ASSERT_EQUAL(HalConformance::NOT_CHECKED, broken.result(HalConformance::RELAY_WRITE));
+   TEST_ASSERT_EQUAL(HalConformance::UNOBSERVABLE, broken.result(HalConformance::TONE));
+   TEST_ASSERT_EQUAL(HalConformance::UNOBSERVABLE, broken.result(HalConformance::IS_PRESSED));
+   TEST_ASSERT_EQUAL(HalConformance::PASS, broken.result(HalConformance::DELAY));
+   TEST_ASSERT_EQUAL(HalConformance::NOT_TIMED, broken.nanosPerCall(HalConformance::RELAY_WRITE));
+}
+
+// Test 28: Traffic is counted per state and per tick, with the calls that changed nothing
+void test_traffic_counter_profiles_states(void)
+{
+   TrafficCounter traffic(mockInterface);
+   traffic.beginTick(State::READY);
+   traffic.digitalWrite(5, HIGH);
+   traffic.digitalWrite(5, HIGH);
+   traffic.noTone(9);
+   traffic.noTone(9);
+   traffic.lcdClear();
+   traffic.lcdSetCursor(0, 0); // clear already homed it
+   traffic.lcdPrint("AB");
+   traffic.lcdSetCursor(0, 0);
+   traffic.lcdPrint("AB");
+   TEST_ASSERT_EQUAL(HIGH, mockInterface->getPinState(5)); // passed straight through
+   TEST_ASSERT_EQUAL(0, strcmp(mockInterface->getLCDLine1(), "AB"));
+
+   TEST_ASSERT_EQUAL(2u, traffic.calls(State::READY, TrafficCounter::DIGITAL_WRITE));
+   TEST_ASSERT_EQUAL(1u, traffic.unchanged(State::READY, TrafficCounter::DIGITAL_WRITE));
+   TEST_ASSERT_EQUAL(1u, traffic.unchanged(State::READY, TrafficCounter::NO_TONE));
+   TEST_ASSERT_EQUAL(1u, traffic.unchanged(State::READY, TrafficCounter::LCD_SET_CURSOR));
+   TEST_ASSERT_EQUAL(1u, traffic.unchanged(State::READY, TrafficCounter::LCD_PRINT_TEXT));
+   TEST_ASSERT_EQUAL(1u + 2 + 4, traffic.lcdBytes(State::READY));
+   TEST_ASSERT_EQUAL(2u, traffic.lcdUnchangedBytes(State::READY));
+
+   // Two quiet ticks in ARMED: the READY tick stays the peak for its state
+   traffic.beginTick(State::ARMED);
+   traffic.digitalWrite(5, LOW);
+   traffic.beginTick(State::ARMED);
+   TEST_ASSERT_EQUAL(1u, traffic.ticks(State::READY));
+   TEST_ASSERT_EQUAL(2u, traffic.ticks(State::ARMED));
+   TEST_ASSERT_EQUAL(2, traffic.peak(State::READY, TrafficCounter::DIGITAL_WRITE));
+   TEST_ASSERT_EQUAL(1, traffic.peak(State::ARMED, TrafficCounter::DIGITAL_WRITE));
+   TEST_ASSERT_EQUAL(0u, traffic.unchanged(State::ARMED, TrafficCounter::DIGITAL_WRITE));
+
+   // The controller through the counter behaves as it does without it
+   RocketController rc(&traffic);
+   rc.enter(State::READY);
+   traffic.beginTick(rc.getState());
+   mockInterface->setArmPressed(true);
+   rc.update(10);
+   TEST_ASSERT_EQUAL(State::ARMED, rc.getState());
+   TEST_ASSERT_TRUE(traffic.calls(State::READY, TrafficCounter::READ_INPUT) > 0);
+}
+
+// Test 29: The controller fires when the compile-time replay says it does, to the millisecond
+void test_controller_matches_interlock_replay(void)
+{
+   static const LaunchInterlock::Press script[] = {
+       {10, INPUT_BIT_ARM}, {20, INPUT_BIT_ARM | INPUT_BIT_LAUNCH}};
+   const LaunchInterlock::Outcome expected = LaunchInterlock::replay(script, 6000);
+   TEST_ASSERT_EQUAL(State::LAUNCHING, expected.final);
+
+   controller->enter(State::READY);
+   uint32_t fired = 0;
+   for (uint32_t t = 1; t <= 6000 && fired == 0; t++)
+   {
+      mockInterface->setArmPressed(t >= 10);
+      mockInterface->setLaunchPressed(t >= 20);
+      mockInterface->setMockTime(t);
+      controller->update(t);
+      if (controller->getState() == State::LAUNCHING)
+         fired = t;
+   }
+   TEST_ASSERT_EQUAL(expected.firedAt, fired);
+   TEST_ASSERT_EQUAL(HIGH, mockInterface->getPinState(8));
+}
+
+// A 16x2 HD44780 on the fake bus: 8-bit after power-on, bytes in two nibbles once in 4-bit
+static char    hdRam[2][40];
+static uint8_t hdAddr    = 0;
+static bool    hd4Bit    = false;
+static bool    hdHalf    = false; // high nibble latched, low one awaited
+static uint8_t hdHigh    = 0;
+
+static void hdExecute(uint8_t value, bool rs)
+{
+   if (rs)
+   {
+      hdRam[(hdAddr & 0x40) ? 1 : 0][hdAddr & 0x3F] = (char)value;
+      hdAddr = hdAddr == 0x27 ? 0x40 : hdAddr == 0x67 ? 0x00 : (uint8_t)(hdAddr + 1);
+   }
+   else if (value & 0x80)
+      hdAddr = value & 0x7F;
+   else if ((value & 0xE0) == 0x20)
+   {
+      hd4Bit = (value & 0x10) == 0; // function set
+      hdHalf = false;
+   }
+   else if (value == 0x01)
+   {
+      memset(hdRam, ' ', sizeof(hdRam));
+      hdAddr = 0;
+   }
+}
+
+static void hdNibble(uint8_t nibble, bool rs)
+{
+   if (!hd4Bit)
+      hdExecute((uint8_t)(nibble << 4), rs);
+   else if (!hdHalf)
+   {
+      hdHigh = nibble;
+      hdHalf = true;
+   }
+   else
+   {
+      hdHalf = false;
+      hdExecute((uint8_t)((hdHigh << 4) | nibble), rs);
+   }
+}
+
+static bool hdRowIs(uint8_t row, const char* text)
+{
+   char shown[17];
+   memcpy(shown, hdRam[row], 16);
+   shown[16] = '\0';
+   const size_t len = strlen(text);
+   return strncmp(shown, text, len) == 0 && strspn(shown + len, " ") == 16 - len;
+}
+
+// Test 30: A display knocked out of nibble sync is resynced and redrawn in the background
+void test_fast_lcd_heals_garbled_display(void)
+{
+   FastLcd lcd(hdNibble);
+   hd4Bit = hdHalf = false;
+   memset(hdRam, '?', sizeof(hdRam));
+   lcd.begin(16, 2);
+   lcd.setCursor(0, 0);
+   lcd.print("ARMED");
+   while (!lcd.idle())
+      lcd.service();
+   TEST_ASSERT_TRUE(hdRowIs(0, "ARMED"));
+
+   // A stray nibble from the relay: everything after it lands as the wrong bytes
+   hdNibble(0x0, false);
+   lcd.setCursor(0, 1);
+   lcd.print("Hold LAUNCH");
+   while (!lcd.idle())
+      lcd.service();
+   TEST_ASSERT_FALSE(hdRowIs(1, "Hold LAUNCH"));
+
+   // Healed within a second, a few bytes at a time, with the cursor left for the caller
+   const uint16_t before = lcd.resyncs();
+   lcd.heal();
+   uint16_t longest = 0;
+   uint16_t run     = 0;
+   for (uint16_t tick = 0; tick < 10000; tick++)
+   {
+      lcd.service();
+      run = lcd.idle() ? 0 : (uint16_t)(run + 1);
+      if (run > longest)
+         longest = run;
+   }
+   TEST_ASSERT_TRUE(lcd.resyncs() > before);
+   TEST_ASSERT_TRUE(longest < 100); // no pass holds the bus for a full redraw
+   TEST_ASSERT_TRUE(hdRowIs(0, "ARMED"));
+   TEST_ASSERT_TRUE(hdRowIs(1, "Hold LAUNCH"));
+   lcd.print("!");
+   while (!lcd.idle())
+      lcd.service();
+   TEST_ASSERT_TRUE(hdRowIs(1, "Hold LAUNCH!"));
+}
+
+// Test 31: On an interlock input, a longer bounce after a learned clean profile stays one edge
+void test_debouncer_hold_guards_interlock(void)
+{
+   AdaptiveDebouncer db;
+   db.begin(true, 0, AdaptiveDebouncer::INTERLOCK_HOLD_MS);
+
+   uint32_t t = 0;
+   for (int i = 0; i < 8; i++)
+      t = pressWithBounce(db, t, 0);
+   TEST_ASSERT_EQUAL(AdaptiveDebouncer::MIN_WINDOW_MS, db.windowMs());
+
+   // Quiet gaps of 3 and 6 ms, each longer than the clean profile's 2 ms window
+   int edges = 0;
+   for (int i = 0; i < 3; i++)
+      edges += db.update(false, t++) ? 1 : 0;
+   for (int i = 0; i < 6; i++)
+      edges += db.update(true, t++) ? 1 : 0;
+   for (int i = 0; i < 50; i++)
+      edges += db.update(false, t++) ? 1 : 0;
+   TEST_ASSERT_EQUAL(1, edges);
+   TEST_ASSERT_FALSE(db.read());
+
+   // A clean press is seen after the learned window, not the hold
+   for (int i = 0; i < 50; i++)
+      db.update(true, t++);
+   const uint32_t pressAt = t;
+   while (!db.update(false, t))
+      t++;
+   TEST_ASSERT_EQUAL(AdaptiveDebouncer::MIN_WINDOW_MS, t - pressAt);
+
+   // A release 5 ms later reads as bounce: held past the hold, but still reported
+   const uint32_t acceptedAt = t;
+   for (t++; t < acceptedAt + 5; t++)
+      db.update(false, t);
+   edges = 0;
+   uint32_t releasedAt = 0;
+   for (; t < acceptedAt + 40; t++)
+   {
+      if (db.update(true, t))
+      {
+         edges++;
+         releasedAt = t;
+      }
+   }
+   TEST_ASSERT_EQUAL(1, edges);
+   TEST_ASSERT_TRUE(releasedAt >= acceptedAt + AdaptiveDebouncer::INTERLOCK_HOLD_MS);
+}
+
+// Welded relay contacts: pin 8 reads closed whatever is written to it
+class WeldedRelayMock : public PersistingMockInterface
+{
+ public:
+   uint8_t digitalRead(uint8_t pin) const override
+   {
+      return pin == 8 ? HIGH : PersistingMockInterface::digitalRead(pin);
+   }
+};
+
+// Test 32: A fault that persists for many passes is logged, and written to EEPROM, once
+void test_stuck_relay_logs_one_fault(void)
+{
+   WeldedRelayMock   hal;
+   RocketController* rc = new RocketController(&hal);
+   rc->enter(State::READY);
+   uint32_t t = 0;
+   for (; t < 100; t += 10)
+   {
+      hal.setMockTime(t);
+      rc->update(t);
+   }
+   TEST_ASSERT_EQUAL(State::FAULT, rc->getState());
+   hal.persistFlush();
+   const uint32_t written = hal.queue.getWrites();
+
+   for (; t < 5000; t += 10)
+   {
+      hal.setMockTime(t);
+      rc->update(t);
+   }
+   TEST_ASSERT_EQUAL(State::FAULT, rc->getState());
+   TEST_ASSERT_EQUAL(1, rc->getLaunchLog().faults);
+   TEST_ASSERT_EQUAL(0, hal.queue.pending());
+   hal.persistFlush();
+   TEST_ASSERT_EQUAL(written, hal.queue.getWrites());
+   delete rc;
+}
+
+// Serial port that takes a few bytes at a time
+class SlowSerialMock : public MockArduinoInterface
+{
+ public:
+   uint8_t  sent[256];
+   uint16_t sentLen = 0;
+   uint16_t room    = 0;
+
+   uint16_t serialWritable() const override
+   {
+      return room;
+   }
+
+   void serialWrite(const uint8_t* data, uint16_t len) override
+   {
+      memcpy(sent + sentLen, data, len);
+      sentLen = (uint16_t)(sentLen + len);
+      room    = (uint16_t)(room - len);
+   }
+};
+
+// Test 33: Queued serial writes leave whole, in order, and report when all are out
+void test_queued_ui_keeps_frames_whole(void)
+{
+   SlowSerialMock    hal;
+   QueuedUiInterface ui(&hal);
+   const uint8_t     a[] = {0xA5, 0x5A, 'T', 1, 2, 3};
+   const uint8_t     b[] = {0xA5, 0x5A, 'R', 4};
+   TEST_ASSERT_TRUE(ui.serialWritable() >= FRAME_OVERHEAD + FRAME_MAX_PAYLOAD);
+   ui.serialWrite(a, sizeof(a));
+   ui.serialWrite(b, sizeof(b));
+   TEST_ASSERT_EQUAL(0, hal.sentLen); // nothing from the caller's task
+
+   // A port with room for 4 bytes leaves the first frame half out: not a gap for text
+   hal.room = 4;
+   TEST_ASSERT_FALSE(ui.drainSerial());
+   TEST_ASSERT_EQUAL(4, hal.sentLen);
+   hal.room = 64;
+   TEST_ASSERT_TRUE(ui.drainSerial());
+   TEST_ASSERT_EQUAL(sizeof(a) + sizeof(b), hal.sentLen);
+   TEST_ASSERT_EQUAL(0, memcmp(hal.sent, a, sizeof(a)));
+   TEST_ASSERT_EQUAL(0, memcmp(hal.sent + sizeof(a), b, sizeof(b)));
+
+   // A full ring drops the write rather than block the safety task
+   for (size_t i = 0; i < QueuedUiInterface::SERIAL_QUEUE + 1; i++)
+      ui.serialWrite(a, sizeof(a));
+   TEST_ASSERT_EQUAL(0u, ui.serialWritable());
+   TEST_ASSERT_EQUAL(1u, ui.getDropped());
+}
+
+// Pin writer handed over by a board that services the aux channels from its timer
+static uint8_t auxWriterLevels[16];
+
+static void    recordAuxWrite(uint8_t pin, bool high)
+{
+   auxWriterLevels[pin] = high ? HIGH : LOW;
+}
+
+// Test 34: With a pin writer set, the aux channels never call into the interface
+void test_aux_pin_writer_bypasses_interface(void)
+{
+   AuxScheduler aux(mockInterface);
+   TEST_ASSERT_TRUE(aux.addChannel(10, -500, 200));
+   aux.setPinWrite(recordAuxWrite);
+   memset(auxWriterLevels, LOW, sizeof(auxWriterLevels));
+
+   aux.arm(5000);
+   aux.service(4500);
+   TEST_ASSERT_EQUAL(HIGH, auxWriterLevels[10]);
+   TEST_ASSERT_EQUAL(LOW, mockInterface->getPinState(10));
+   aux.service(4700);
+   TEST_ASSERT_EQUAL(LOW, auxWriterLevels[10]);
+
+   aux.arm(9000);
+   aux.service(8500);
+   TEST_ASSERT_EQUAL(HIGH, auxWriterLevels[10]);
+   aux.cancel();
+   TEST_ASSERT_EQUAL(LOW, auxWriterLevels[10]);
+   TEST_ASSERT_EQUAL(LOW, mockInterface->getPinState(10));
+}
+
+// Test 35: RAM damage that stays put is one fault, one log record and one FAULT screen
+void test_persistent_ram_fault_logs_once(void)
+{
+   PersistingMockInterface hal;
+   RocketController*       rc = new RocketController(&hal);
+   rc->enter(State::READY);
+   hal.persistFlush();
+   const uint32_t written = hal.queue.getWrites();
+
+   // A flipped bit in the (unused) last aux channel of the scrubbed config
+   AuxScheduler::Config& config = const_cast<AuxScheduler::Config&>(rc->getAux().getConfig());
+   config.channels[AuxScheduler::MAX_CHANNELS - 1].pulseMs ^= 0x0100;
+   uint32_t t = 0;
+   for (; t < 5000; t += 10)
+   {
+      hal.setMockTime(t);
+      rc->update(t);
+   }
+   TEST_ASSERT_EQUAL(State::FAULT, rc->getState());
+   TEST_ASSERT_EQUAL(1, rc->getIntegrityFaults());
+   TEST_ASSERT_EQUAL(1, rc->getLaunchLog().faults);
+   TEST_ASSERT_EQUAL(LAUNCH_LOG_FAULT_RAM, rc->getLaunchLog().lastViolation);
+   hal.persistFlush();
+   TEST_ASSERT_TRUE(hal.queue.getWrites() > written);
+   const uint32_t afterFault = hal.queue.getWrites();
+
+   for (; t < 10000; t += 10)
+   {
+      hal.setMockTime(t);
+      rc->update(t);
+   }
+   TEST_ASSERT_EQUAL(1, rc->getIntegrityFaults());
+   TEST_ASSERT_EQUAL(1, rc->getLaunchLog().faults);
+   TEST_ASSERT_EQUAL(0, hal.queue.pending());
+   hal.persistFlush();
+   TEST_ASSERT_EQUAL(afterFault, hal.queue.getWrites());
+   delete rc;
+}
+
 // Main test runner
 void RUN_UNITY_TESTS()
 {
@@ -384,6 +1447,37 @@ void RUN_UNITY_TESTS()
    RUN_TEST(test_startup_to_ready_transition);
    RUN_TEST(test_button_input_handling);
    RUN_TEST(test_manual_state_management);
+   RUN_TEST(test_tone_timer_divisors);
+   RUN_TEST(test_buzzer_plays_sequence_notes);
+   RUN_TEST(test_debouncer_learns_clean_switch);
+   RUN_TEST(test_debouncer_flags_worn_switch);
+   RUN_TEST(test_monitor_allows_normal_launch);
+   RUN_TEST(test_monitor_trips_on_stray_relay);
+   RUN_TEST(test_monitor_trips_on_launch_without_hold);
+   RUN_TEST(test_redundant_detects_bit_flip);
+   RUN_TEST(test_incremental_crc_detects_corruption);
+   RUN_TEST(test_controller_redundant_state);
+   RUN_TEST(test_range_mode_clean_fire_returns_to_ready);
+   RUN_TEST(test_aux_channels_follow_ignition);
+   RUN_TEST(test_load_cell_capture_counts_drops);
+   RUN_TEST(test_serial_frame_round_trip);
+   RUN_TEST(test_telemetry_snapshot_round_trip);
+   RUN_TEST(test_relay_pulse_configurable);
+   RUN_TEST(test_eeprom_queue_merges_and_rejects);
+   RUN_TEST(test_launch_log_persists);
+   RUN_TEST(test_fast_lcd_queues_and_paces);
+   RUN_TEST(test_queued_ui_defers_display);
+   RUN_TEST(test_raw_capture_freezes_window);
+   RUN_TEST(test_relay_drive_pulls_in_then_holds);
+   RUN_TEST(test_hal_conformance_on_mock);
+   RUN_TEST(test_traffic_counter_profiles_states);
+   RUN_TEST(test_controller_matches_interlock_replay);
+   RUN_TEST(test_fast_lcd_heals_garbled_display);
+   RUN_TEST(test_debouncer_hold_guards_interlock);
+   RUN_TEST(test_stuck_relay_logs_one_fault);
+   RUN_TEST(test_queued_ui_keeps_frames_whole);
+   RUN_TEST(test_aux_pin_writer_bypasses_interface);
+   RUN_TEST(test_persistent_ram_fault_logs_once);
    
    UNITY_END();
 }
@@ -393,5 +1487,5 @@ int main()
 {
    // Initialize Unity test framework
    RUN_UNITY_TESTS();
-   return 0;
+   return Unity::unity_number_of_failures == 0 ? 0 : 1;
 }
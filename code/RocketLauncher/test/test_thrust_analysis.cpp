@@ -0,0 +1,236 @@
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../src/SerialFrame.h"
+#include "../tools/ThrustAnalysis.h"
+#include "UnityMini.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// Reference curve helpers (1 kHz unless stated)
+static std::vector<float> flatBurn(float newtons, size_t leadIn, size_t burn, size_t tail)
+{
+   std::vector<float> v(leadIn + burn + tail, 0.0f);
+   for (size_t i = 0; i < burn; i++)
+      v[leadIn + i] = newtons;
+   return v;
+}
+
+static void appendFrame(std::vector<uint8_t>& out, uint8_t type, const uint8_t* payload,
+                        uint8_t len)
+{
+   uint8_t frame[FRAME_OVERHEAD + FRAME_MAX_PAYLOAD];
+   const uint8_t n = encodeFrame(frame, type, payload, len);
+   out.insert(out.end(), frame, frame + n);
+}
+
+// Capture as the firmware sends it: S, D frames of 16 samples, E
+static std::vector<uint8_t> captureStream(const std::vector<int32_t>& counts, uint32_t dropped,
+                                          size_t skipFrame)
+{
+   std::vector<uint8_t> out;
+   uint8_t              p[FRAME_MAX_PAYLOAD];
+
+   uint8_t* q = framePutU16(p, 1000);
+   *q++       = 3;
+   q          = framePutU32(q, 12345);
+   appendFrame(out, FRAME_CAPTURE_START, p, (uint8_t)(q - p));
+
+   const char* text = "Static fire: capture running\r\n"; // plain text shares the port
+   out.insert(out.end(), text, text + strlen(text));
+
+   for (size_t first = 0, frame = 0; first < counts.size(); first += 16, frame++)
+   {
+      q = framePutU32(p, (uint32_t)first);
+      for (size_t i = first; i < counts.size() && i < first + 16; i++)
+         q = framePutU24(q, (uint32_t)counts[i]);
+      if (frame != skipFrame)
+         appendFrame(out, FRAME_CAPTURE_DATA, p, (uint8_t)(q - p));
+   }
+
+   q = framePutU32(p, (uint32_t)counts.size());
+   q = framePutU32(q, dropped);
+   appendFrame(out, FRAME_CAPTURE_END, p, (uint8_t)(q - p));
+   return out;
+}
+
+// Test 1: Constant 8 N for one second is a C8
+void test_flat_burn_is_c8(void)
+{
+   const std::vector<float> v = flatBurn(8.0f, 100, 1001, 200);
+   const ThrustStats        s = analyseThrust(v.data(), v.size(), 1000.0);
+
+   TEST_ASSERT_FLOAT_WITHIN(1e-3, 8.0, s.totalImpulse);
+   TEST_ASSERT_FLOAT_WITHIN(1e-6, 8.0, s.peakThrust);
+   TEST_ASSERT_FLOAT_WITHIN(1e-6, 0.1, s.burnStart);
+   TEST_ASSERT_FLOAT_WITHIN(1e-6, 1.0, s.burnTime);
+   TEST_ASSERT_FLOAT_WITHIN(1e-3, 8.0, s.averageThrust);
+   TEST_ASSERT_TRUE(s.motorClass == "C");
+   TEST_ASSERT_TRUE(s.designation == "C8");
+}
+
+// Test 2: Triangle curve matches its analytic impulse and peak
+void test_triangle_curve_impulse(void)
+{
+   // 0 -> 100 N over 0.5 s and back, sampled at 1 kHz (odd length exercises the loop tails)
+   std::vector<float> v(1001);
+   for (size_t i = 0; i <= 500; i++)
+   {
+      v[i]        = (float)(i * 0.2);
+      v[1000 - i] = (float)(i * 0.2);
+   }
+
+   const ThrustStats whole = analyseThrust(v.data(), v.size(), 1000.0, 0.0);
+   TEST_ASSERT_FLOAT_WITHIN(1e-3, 50.0, whole.totalImpulse);
+   TEST_ASSERT_FLOAT_WITHIN(1e-4, 100.0, whole.peakThrust);
+   TEST_ASSERT_FLOAT_WITHIN(1e-6, 0.5, whole.peakTime);
+   TEST_ASSERT_TRUE(whole.motorClass == "F");
+
+   // The default 5 % threshold trims 25 ms of tail on each side: 2 x 0.5 x 0.025 s x 5 N
+   const ThrustStats trimmed = analyseThrust(v.data(), v.size(), 1000.0);
+   TEST_ASSERT_FLOAT_WITHIN(1e-3, 50.0 - 0.125, trimmed.totalImpulse);
+   TEST_ASSERT_FLOAT_WITHIN(1e-6, 0.95, trimmed.burnTime);
+
+   size_t      at   = 0;
+   const float peak = peakValue(v.data() + 3, 7, &at); // shorter than one vector block
+   TEST_ASSERT_FLOAT_WITHIN(1e-6, 1.8, peak);
+   TEST_ASSERT_EQUAL(6u, at);
+}
+
+// Test 3: Total-impulse classes at their boundaries
+void test_motor_class_boundaries(void)
+{
+   TEST_ASSERT_TRUE(std::string(motorClassFor(0.3)) == "");
+   TEST_ASSERT_TRUE(std::string(motorClassFor(0.625)) == "1/4A");
+   TEST_ASSERT_TRUE(std::string(motorClassFor(1.25)) == "1/2A");
+   TEST_ASSERT_TRUE(std::string(motorClassFor(1.26)) == "A");
+   TEST_ASSERT_TRUE(std::string(motorClassFor(5.0)) == "B");
+   TEST_ASSERT_TRUE(std::string(motorClassFor(10.01)) == "D");
+   TEST_ASSERT_TRUE(std::string(motorClassFor(320.0)) == "H");
+   TEST_ASSERT_TRUE(std::string(motorClassFor(40960.0)) == "O");
+   TEST_ASSERT_TRUE(std::string(motorClassFor(40960.1)) == "P+");
+}
+
+// Test 4: Binary capture read in arbitrary chunks, tared, with a lost frame filled in
+void test_capture_frames_in_chunks(void)
+{
+   // Load cell sits at -5000 counts unloaded; 10 counts per newton
+   std::vector<int32_t> counts(600, -5000);
+   for (size_t i = 200; i < 400; i++)
+      counts[i] = -5000 + 200; // 20 N for 0.2 s
+   const std::vector<uint8_t> stream = captureStream(counts, 3, 15);
+
+   ThrustCalibration cal;
+   cal.newtonsPerCount = 0.1;
+   cal.autoTare        = true;
+   CaptureFrameReader reader(cal);
+
+   uint32_t seed = 1;
+   for (size_t pos = 0; pos < stream.size();)
+   {
+      seed             = seed * 1103515245u + 12345u;
+      const size_t len = std::min<size_t>(stream.size() - pos, 1 + (seed >> 16) % 37);
+      reader.feed(stream.data() + pos, len);
+      pos += len;
+   }
+
+   ThrustLog log;
+   reader.finish(log);
+   TEST_ASSERT_EQUAL(600u, log.newtons.size());
+   TEST_ASSERT_FLOAT_WITHIN(1e-9, 1000.0, log.rateHz);
+   TEST_ASSERT_EQUAL(3u, log.dropped);
+   TEST_ASSERT_EQUAL(16u, log.gapSamples);
+   TEST_ASSERT_EQUAL(0u, log.frameErrors);
+   TEST_ASSERT_TRUE(log.complete);
+   TEST_ASSERT_FLOAT_WITHIN(1e-4, 0.0, log.newtons[0]);
+   TEST_ASSERT_FLOAT_WITHIN(1e-4, 20.0, log.newtons[300]);
+   TEST_ASSERT_FLOAT_WITHIN(1e-4, 20.0, log.newtons[15 * 16 + 5]); // held across the lost frame
+}
+
+// Test 5: CSV with a header, CRLF lines and chunks split mid-number
+void test_csv_reader_split_lines(void)
+{
+   std::string csv = "time_s,thrust_N\r\n";
+   for (int i = 0; i <= 1000; i++)
+   {
+      char line[48];
+      const double thrust = (i >= 100 && i <= 600) ? 4.0 : 0.0;
+      snprintf(line, sizeof(line), "%.3f,%.3f\r\n", i / 1000.0, thrust);
+      csv += line;
+   }
+
+   ThrustCalibration cal;
+   CsvThrustReader   reader(cal, 0.0);
+   for (size_t pos = 0; pos < csv.size(); pos += 7)
+      reader.feed(csv.data() + pos, std::min<size_t>(7, csv.size() - pos));
+
+   ThrustLog   log;
+   std::string error;
+   TEST_ASSERT_TRUE(reader.finish(log, error));
+   TEST_ASSERT_EQUAL(1001u, log.newtons.size());
+   TEST_ASSERT_FLOAT_WITHIN(1e-6, 1000.0, log.rateHz);
+
+   const ThrustStats s = analyseThrust(log.newtons.data(), log.newtons.size(), log.rateHz);
+   TEST_ASSERT_FLOAT_WITHIN(1e-3, 2.0, s.totalImpulse);
+   TEST_ASSERT_TRUE(s.designation == "A4");
+
+   // Single column needs the rate from the caller
+   CsvThrustReader untimed(cal, 0.0);
+   untimed.feed("1\n2\n3\n", 6);
+   TEST_ASSERT_FALSE(untimed.finish(log, error));
+}
+
+// Test 6: Smoothing keeps a constant and the impulse, and cuts sample noise
+void test_smoothing_preserves_impulse(void)
+{
+   const size_t       n = 2003;
+   std::vector<float> flat(n, 12.5f);
+   std::vector<float> out(n);
+   smoothThrust(flat.data(), out.data(), n, 8);
+   for (size_t i = 0; i < n; i++)
+      TEST_ASSERT_FLOAT_WITHIN(1e-4, 12.5, out[i]);
+
+   std::vector<float> noisy = flatBurn(30.0f, 200, 1500, 303);
+   for (size_t i = 0; i < noisy.size(); i++)
+      noisy[i] += (i & 1) ? 2.0f : -2.0f;
+   smoothThrust(noisy.data(), out.data(), n, 4);
+
+   double rawErr  = 0;
+   double smthErr = 0;
+   for (size_t i = 400; i < 1500; i++)
+   {
+      rawErr += std::fabs(noisy[i] - 30.0f);
+      smthErr += std::fabs(out[i] - 30.0f);
+   }
+   TEST_ASSERT_TRUE(smthErr < rawErr / 10);
+   TEST_ASSERT_FLOAT_WITHIN(0.05, trapezoidIntegral(noisy.data(), n, 1e-3),
+                            trapezoidIntegral(out.data(), n, 1e-3));
+}
+
+// Main test runner
+void RUN_UNITY_TESTS()
+{
+   UNITY_BEGIN();
+
+   RUN_TEST(test_flat_burn_is_c8);
+   RUN_TEST(test_triangle_curve_impulse);
+   RUN_TEST(test_motor_class_boundaries);
+   RUN_TEST(test_capture_frames_in_chunks);
+   RUN_TEST(test_csv_reader_split_lines);
+   RUN_TEST(test_smoothing_preserves_impulse);
+
+   UNITY_END();
+}
+
+int main()
+{
+   RUN_UNITY_TESTS();
+   return Unity::unity_number_of_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,192 @@
+#include "LiveBridge.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+   std::string segmentName(const std::string& name)
+   {
+      return "/rocket_live." + name;
+   }
+
+   // Map an open segment; nullptr (and errno) on failure
+   LiveShared* mapSegment(int fd)
+   {
+      void* p = mmap(nullptr, sizeof(LiveShared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      return p == MAP_FAILED ? nullptr : (LiveShared*)p;
+   }
+} // namespace
+
+LivePublisher::~LivePublisher()
+{
+   if (!shared)
+      return;
+   if (!keep)
+      shm_unlink(shmName.c_str());
+   munmap(shared, sizeof(LiveShared));
+}
+
+bool LivePublisher::open(const std::string& name, std::string& error)
+{
+   shmName = segmentName(name);
+   shm_unlink(shmName.c_str()); // a crashed or kept run of the same name
+   const int fd = shm_open(shmName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+   if (fd < 0)
+   {
+      error = shmName + ": " + strerror(errno);
+      return false;
+   }
+   // A fresh segment reads as zeros, which is every atomic's starting value
+   if (ftruncate(fd, sizeof(LiveShared)) != 0 || !(shared = mapSegment(fd)))
+   {
+      error = shmName + ": " + strerror(errno);
+      close(fd);
+      shm_unlink(shmName.c_str());
+      return false;
+   }
+   close(fd);
+   shared->slots       = LIVE_RING_SLOTS;
+   shared->frameBytes  = sizeof(LiveFrame);
+   shared->producerPid = (int32_t)getpid();
+   shared->magic.store(LIVE_MAGIC, std::memory_order_release);
+   return true;
+}
+
+void LivePublisher::publish(const LiveFrame& frame)
+{
+   LiveFrame f = frame;
+   f.frame     = next;
+   uint32_t words[LIVE_FRAME_WORDS];
+   memcpy(words, &f, sizeof(words));
+
+   LiveSlot&      slot = shared->ring[(next - 1) % LIVE_RING_SLOTS];
+   const uint32_t seq  = slot.seq.load(std::memory_order_relaxed);
+   slot.seq.store(seq + 1, std::memory_order_relaxed);
+   std::atomic_thread_fence(std::memory_order_release); // odd before any word changes
+   for (uint32_t i = 0; i < LIVE_FRAME_WORDS; i++)
+      slot.words[i].store(words[i], std::memory_order_relaxed);
+   slot.seq.store(seq + 2, std::memory_order_release);
+   shared->published.store(next, std::memory_order_release);
+   next++;
+}
+
+bool LivePublisher::takeInputs(uint8_t& mask)
+{
+   // Plain load first so an idle mailbox costs no read-modify-write per tick
+   if (shared->mailbox.load(std::memory_order_relaxed) == 0)
+      return false;
+   const uint32_t request = shared->mailbox.exchange(0, std::memory_order_acquire);
+   stopSeen |= (request & LIVE_STOP) != 0;
+   if (!(request & LIVE_INPUT_SET))
+      return false;
+   mask = (uint8_t)request;
+   return true;
+}
+
+bool LivePublisher::stopRequested() const
+{
+   return stopSeen || (shared->mailbox.load(std::memory_order_relaxed) & LIVE_STOP);
+}
+
+void LivePublisher::finish(bool keepSegment)
+{
+   keep = keepSegment;
+   shared->finished.store(1, std::memory_order_release);
+}
+
+LiveReader::~LiveReader()
+{
+   if (shared)
+      munmap(shared, sizeof(LiveShared));
+}
+
+bool LiveReader::open(const std::string& name, std::string& error)
+{
+   const std::string shmName = segmentName(name);
+   const int         fd      = shm_open(shmName.c_str(), O_RDWR, 0);
+   if (fd < 0)
+   {
+      error = shmName + ": " + strerror(errno);
+      return false;
+   }
+   struct stat st;
+   if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(LiveShared))
+   {
+      error = shmName + ": not a live simulation (wrong size)";
+      close(fd);
+      return false;
+   }
+   shared = mapSegment(fd);
+   close(fd);
+   if (!shared)
+   {
+      error = shmName + ": " + strerror(errno);
+      return false;
+   }
+   if (shared->magic.load(std::memory_order_acquire) != LIVE_MAGIC ||
+       shared->slots != LIVE_RING_SLOTS || shared->frameBytes != sizeof(LiveFrame))
+   {
+      error = shmName + ": not a live simulation, or from another version";
+      munmap(shared, sizeof(LiveShared));
+      shared = nullptr;
+      return false;
+   }
+   return true;
+}
+
+bool LiveReader::read(uint64_t n, LiveFrame& out) const
+{
+   if (n == 0 || n > published())
+      return false;
+   const LiveSlot& slot = shared->ring[(n - 1) % LIVE_RING_SLOTS];
+   uint32_t        words[LIVE_FRAME_WORDS];
+   for (uint8_t attempt = 0; attempt < 4; attempt++)
+   {
+      const uint32_t before = slot.seq.load(std::memory_order_acquire);
+      if (before & 1)
+         continue; // being written right now
+      for (uint32_t i = 0; i < LIVE_FRAME_WORDS; i++)
+         words[i] = slot.words[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire); // words before the second look
+      if (slot.seq.load(std::memory_order_relaxed) != before)
+         continue;
+      memcpy(&out, words, sizeof(words));
+      return out.frame == n; // otherwise the ring has lapped it
+   }
+   return false;
+}
+
+bool LiveReader::latest(LiveFrame& out) const
+{
+   for (uint8_t attempt = 0; attempt < 4; attempt++)
+   {
+      if (read(published(), out))
+         return true;
+   }
+   return false;
+}
+
+void LiveReader::sendInputs(uint8_t mask)
+{
+   // Keep a pending stop; replace any input request the simulator has not taken yet
+   uint32_t request = shared->mailbox.load(std::memory_order_relaxed);
+   while (!shared->mailbox.compare_exchange_weak(request,
+                                                 (request & LIVE_STOP) | LIVE_INPUT_SET | mask,
+                                                 std::memory_order_release))
+   {
+   }
+}
+
+void LiveReader::requestStop()
+{
+   shared->mailbox.fetch_or(LIVE_STOP, std::memory_order_release);
+}
+
+bool LiveReader::remove(const std::string& name)
+{
+   return shm_unlink(segmentName(name).c_str()) == 0;
+}
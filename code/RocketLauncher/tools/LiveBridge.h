@@ -0,0 +1,136 @@
+#ifndef LIVE_BRIDGE_H
+#define LIVE_BRIDGE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// A running simulation shared with dashboards through POSIX shared memory
+//
+// The simulator publishes one LiveFrame per tick into a ring of
+// LIVE_RING_SLOTS slots in /dev/shm/rocket_live.<name>. Each slot is a
+// sequence lock: the producer makes the slot's sequence odd, stores the
+// frame, then makes it even again; a reader copies the frame between two
+// loads of the sequence and keeps the copy only if both are the same even
+// value. The producer never waits on a reader, so a dashboard can attach,
+// stall or vanish without slowing the run; a reader that falls a whole ring
+// behind just sees a jump in the frame number. Dashboards hand inputs back
+// through one mailbox word the simulator picks up on its next tick.
+static constexpr uint32_t LIVE_RING_SLOTS = 1024;
+static constexpr uint32_t LIVE_MAGIC      = 0x31564C52; // "RLV1"
+static constexpr uint8_t  LIVE_LCD_COLS   = 16;
+
+// Mailbox bits: a request is the input mask with LIVE_INPUT_SET, or LIVE_STOP
+static constexpr uint32_t LIVE_INPUT_SET  = 0x100;
+static constexpr uint32_t LIVE_STOP       = 0x200;
+
+struct LiveFrame
+{
+   uint64_t frame;     // ticks published so far, from 1
+   uint32_t ms;        // simulated time
+   uint16_t toneFreq;  // 0 when silent
+   uint8_t  state;     // State
+   uint8_t  inputs;    // INPUT_BIT_*, as the controller saw them
+   uint8_t  outputs;   // TELEMETRY_OUT_*
+   uint8_t  flags;     // TELEMETRY_FLAG_*
+   uint8_t  violation; // SafetyMonitor::Violation
+   uint8_t  reserved;
+   char     lcd[2][LIVE_LCD_COLS]; // blank-padded, not NUL-terminated
+};
+
+static constexpr uint32_t LIVE_FRAME_WORDS = sizeof(LiveFrame) / 4;
+static_assert(sizeof(LiveFrame) % 4 == 0, "frames are copied a word at a time");
+
+// One ring slot; the frame is stored as relaxed atomic words so a torn read is
+// only ever a discarded copy, never a data race
+struct alignas(64) LiveSlot
+{
+   std::atomic<uint32_t> seq;
+   std::atomic<uint32_t> words[LIVE_FRAME_WORDS];
+};
+
+struct LiveShared
+{
+   std::atomic<uint32_t> magic; // stored last by the producer
+   uint32_t              slots;
+   uint32_t              frameBytes;
+   int32_t               producerPid;
+   alignas(64) std::atomic<uint64_t> published; // newest complete frame
+   std::atomic<uint32_t> finished;              // the run has ended
+   alignas(64) std::atomic<uint32_t> mailbox;   // written by dashboards
+   LiveSlot              ring[LIVE_RING_SLOTS];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                  std::atomic<uint32_t>::is_always_lock_free,
+              "shared atomics must not need a lock");
+
+// Simulator side: owns the segment and removes it when closed (unless kept)
+class LivePublisher
+{
+ public:
+   LivePublisher() = default;
+   ~LivePublisher();
+   LivePublisher(const LivePublisher&)            = delete;
+   LivePublisher& operator=(const LivePublisher&) = delete;
+
+   // Creates the segment, replacing a stale one of the same name
+   bool open(const std::string& name, std::string& error);
+   void publish(const LiveFrame& frame);
+
+   // Inputs a dashboard asked for since the last call
+   bool takeInputs(uint8_t& mask);
+   bool stopRequested() const;
+
+   // Mark the run over; with keep the segment outlives the process for late readers
+   void finish(bool keep);
+
+ private:
+   LiveShared* shared   = nullptr;
+   std::string shmName;
+   uint64_t    next     = 1;
+   bool        keep     = false;
+   bool        stopSeen = false;
+};
+
+// Dashboard side
+class LiveReader
+{
+ public:
+   LiveReader() = default;
+   ~LiveReader();
+   LiveReader(const LiveReader&)            = delete;
+   LiveReader& operator=(const LiveReader&) = delete;
+
+   bool        open(const std::string& name, std::string& error);
+
+   // Frame number n if it is still in the ring and was not being overwritten
+   bool        read(uint64_t n, LiveFrame& out) const;
+   bool        latest(LiveFrame& out) const;
+
+   uint64_t published() const
+   {
+      return shared->published.load(std::memory_order_acquire);
+   }
+
+   bool finished() const
+   {
+      return shared->finished.load(std::memory_order_acquire) != 0;
+   }
+
+   int32_t producerPid() const
+   {
+      return shared->producerPid;
+   }
+
+   void        sendInputs(uint8_t mask);
+   void        requestStop();
+
+   // Remove a segment left behind by a kept run
+   static bool remove(const std::string& name);
+
+ private:
+   LiveShared* shared = nullptr;
+};
+
+#endif // LIVE_BRIDGE_H
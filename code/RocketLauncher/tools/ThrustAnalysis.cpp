@@ -0,0 +1,406 @@
+#include "ThrustAnalysis.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+   // Samples averaged for the zero reading (at least one)
+   size_t tareLength(size_t available, double rateHz, double tareMs)
+   {
+      const size_t n = (size_t)(tareMs * rateHz / 1000.0);
+      return std::max<size_t>(1, std::min(available, n));
+   }
+} // namespace
+
+// Binary capture frames
+void CaptureFrameReader::feed(const uint8_t* data, size_t len)
+{
+   for (size_t i = 0; i < len; i++)
+   {
+      if (decoder.feed(data[i]))
+         onFrame();
+   }
+}
+
+void CaptureFrameReader::onFrame()
+{
+   const uint8_t* p = decoder.payload();
+   switch (decoder.type())
+   {
+      case FRAME_CAPTURE_START:
+         if (decoder.length() < 7)
+            return;
+         rateHz = frameGetU16(p);
+         counts.clear();
+         gapSamples = 0;
+         dropped    = 0;
+         complete   = false;
+         break;
+
+      case FRAME_CAPTURE_DATA:
+      {
+         if (decoder.length() < 4)
+            return;
+         const uint32_t index = frameGetU32(p);
+         const size_t   n     = (decoder.length() - 4) / 3;
+         if (index < counts.size())
+            return; // duplicate
+         if (index > counts.size())
+         {
+            // Lost frames: hold the last value so time stays aligned
+            const int32_t hold = counts.empty() ? 0 : counts.back();
+            gapSamples += (uint32_t)(index - counts.size());
+            counts.resize(index, hold);
+         }
+         for (size_t i = 0; i < n; i++)
+            counts.push_back(frameGetS24(p + 4 + 3 * i));
+         break;
+      }
+
+      case FRAME_CAPTURE_END:
+         if (decoder.length() < 8)
+            return;
+         dropped  = frameGetU32(p + 4);
+         complete = true;
+         if (frameGetU32(p) > counts.size())
+         {
+            gapSamples += (uint32_t)(frameGetU32(p) - counts.size());
+            counts.resize(frameGetU32(p), counts.empty() ? 0 : counts.back());
+         }
+         break;
+
+      default:
+         break; // other frame types share the port
+   }
+}
+
+void CaptureFrameReader::finish(ThrustLog& log)
+{
+   double offset = cal.offsetCounts;
+   if (cal.autoTare && !counts.empty() && rateHz > 0)
+   {
+      const size_t tare = tareLength(counts.size(), rateHz, cal.tareMs);
+      double       sum  = 0;
+      for (size_t i = 0; i < tare; i++)
+         sum += counts[i];
+      offset = sum / tare;
+   }
+
+   log.rateHz      = rateHz;
+   log.dropped     = dropped;
+   log.gapSamples  = gapSamples;
+   log.frameErrors = decoder.errorCount();
+   log.complete    = complete;
+   log.newtons.resize(counts.size());
+
+   const float    scale = (float)cal.newtonsPerCount;
+   const float    bias  = (float)offset;
+   const int32_t* in    = counts.data();
+   float*         out   = log.newtons.data();
+   for (size_t i = 0; i < counts.size(); i++)
+      out[i] = ((float)in[i] - bias) * scale;
+}
+
+// CSV
+void CsvThrustReader::parseLine(const char* begin, const char* end)
+{
+   while (begin < end && (*begin == ' ' || *begin == '\t'))
+      begin++;
+   if (begin == end || *begin == '#')
+      return;
+
+   // strtod needs a terminator; a stack copy keeps the hot path allocation-free
+   char         line[96];
+   const size_t len = (size_t)(end - begin);
+   if (len >= sizeof(line))
+   {
+      badLines++;
+      return;
+   }
+   memcpy(line, begin, len);
+   line[len] = '\0';
+
+   char*        next = nullptr;
+   const double a    = strtod(line, &next);
+   if (next == line)
+   {
+      badLines++; // header or junk
+      return;
+   }
+   while (*next == ' ' || *next == '\t')
+      next++;
+   if (*next == ',' || *next == ';')
+   {
+      char*        rest = nullptr;
+      const double b    = strtod(next + 1, &rest);
+      if (rest == next + 1)
+      {
+         badLines++;
+         return;
+      }
+      if (timed++ == 0)
+         firstTime = a;
+      lastTime = a;
+      values.push_back((float)((b - cal.offsetCounts) * cal.newtonsPerCount));
+      return;
+   }
+   values.push_back((float)((a - cal.offsetCounts) * cal.newtonsPerCount));
+}
+
+void CsvThrustReader::feed(const char* data, size_t len)
+{
+   const char* end   = data + len;
+   const char* start = data;
+   for (const char* p = data; p < end; p++)
+   {
+      if (*p != '\n')
+         continue;
+      const char* lineEnd = (p > start && p[-1] == '\r') ? p - 1 : p;
+      if (!partial.empty())
+      {
+         partial.append(start, lineEnd);
+         parseLine(partial.data(), partial.data() + partial.size());
+         partial.clear();
+      }
+      else
+      {
+         parseLine(start, lineEnd);
+      }
+      start = p + 1;
+   }
+   partial.append(start, end);
+}
+
+bool CsvThrustReader::finish(ThrustLog& log, std::string& error)
+{
+   if (!partial.empty())
+   {
+      parseLine(partial.data(), partial.data() + partial.size());
+      partial.clear();
+   }
+   if (values.empty())
+   {
+      error = "no thrust samples in CSV";
+      return false;
+   }
+   if (timed && timed != values.size())
+   {
+      error = "CSV mixes timed and untimed rows";
+      return false;
+   }
+   if (timed > 1 && lastTime > firstTime)
+      rateHz = (timed - 1) / (lastTime - firstTime);
+   if (rateHz <= 0)
+   {
+      error = "CSV has no time column; give the sample rate";
+      return false;
+   }
+
+   if (cal.autoTare)
+   {
+      const size_t tare = tareLength(values.size(), rateHz, cal.tareMs);
+      double       sum  = 0;
+      for (size_t i = 0; i < tare; i++)
+         sum += values[i];
+      const float bias = (float)(sum / tare);
+      for (float& v : values)
+         v -= bias;
+   }
+
+   log.rateHz   = rateHz;
+   log.complete = true;
+   log.newtons  = std::move(values);
+   return true;
+}
+
+bool readThrustLog(FILE* in, const ThrustCalibration& cal, double csvRateHz, ThrustLog& log,
+                   std::string& error)
+{
+   static constexpr size_t CHUNK = 1 << 16;
+   std::vector<uint8_t>    buf(CHUNK);
+
+   size_t n = fread(buf.data(), 1, CHUNK, in);
+   if (n == 0)
+   {
+      error = "empty input";
+      return false;
+   }
+
+   // Captures start with a frame; plain-text reports before it would not, so also
+   // look for a sync pair anywhere in the first chunk
+   bool binary = false;
+   for (size_t i = 0; i + 1 < n && !binary; i++)
+      binary = buf[i] == FRAME_SYNC0 && buf[i + 1] == FRAME_SYNC1;
+
+   if (binary)
+   {
+      CaptureFrameReader reader(cal);
+      do
+         reader.feed(buf.data(), n);
+      while ((n = fread(buf.data(), 1, CHUNK, in)) > 0);
+      reader.finish(log);
+      if (log.newtons.empty())
+      {
+         error = "no capture data frames found";
+         return false;
+      }
+      if (log.rateHz <= 0)
+      {
+         error = "capture has no start frame (sample rate unknown)";
+         return false;
+      }
+      return true;
+   }
+
+   CsvThrustReader reader(cal, csvRateHz);
+   do
+      reader.feed((const char*)buf.data(), n);
+   while ((n = fread(buf.data(), 1, CHUNK, in)) > 0);
+   return reader.finish(log, error);
+}
+
+// Kernels
+double trapezoidIntegral(const float* x, size_t n, double dt)
+{
+   if (n < 2)
+      return 0;
+
+   // Independent partial sums so the loop vectorises without reassociation flags
+   double acc[8] = {0};
+   size_t i      = 0;
+   for (; i + 8 <= n; i += 8)
+   {
+      for (size_t j = 0; j < 8; j++)
+         acc[j] += x[i + j];
+   }
+   double sum = 0;
+   for (; i < n; i++)
+      sum += x[i];
+   for (double a : acc)
+      sum += a;
+
+   return (sum - 0.5 * ((double)x[0] + (double)x[n - 1])) * dt;
+}
+
+float peakValue(const float* x, size_t n, size_t* index)
+{
+   if (n == 0)
+   {
+      if (index)
+         *index = 0;
+      return 0;
+   }
+
+   // Vectorised max first, then one scan for its position
+   float best[8];
+   std::fill(best, best + 8, x[0]);
+   size_t i = 0;
+   for (; i + 8 <= n; i += 8)
+   {
+      for (size_t j = 0; j < 8; j++)
+         best[j] = std::max(best[j], x[i + j]);
+   }
+   float peak = *std::max_element(best, best + 8);
+   for (; i < n; i++)
+      peak = std::max(peak, x[i]);
+
+   if (index)
+      *index = (size_t)(std::find(x, x + n, peak) - x);
+   return peak;
+}
+
+void smoothThrust(const float* in, float* out, size_t n, unsigned halfWidth)
+{
+   if (halfWidth == 0 || n <= 2 * (size_t)halfWidth)
+   {
+      std::copy(in, in + n, out);
+      return;
+   }
+
+   // Triangular kernel, weight h+1-|k|
+   const int   h    = (int)halfWidth;
+   const float norm = 1.0f / (float)((h + 1) * (h + 1));
+
+   // Interior: tap-major, so every pass is a contiguous multiply-add over the whole signal
+   std::fill(out, out + n, 0.0f);
+   const size_t lo = (size_t)h;
+   const size_t hi = n - (size_t)h;
+   for (int k = -h; k <= h; k++)
+   {
+      const float  w   = (float)(h + 1 - std::abs(k)) * norm;
+      const float* src = in + k;
+      for (size_t i = lo; i < hi; i++)
+         out[i] += w * src[i];
+   }
+
+   // Edges: renormalise over the taps that exist
+   auto edge = [&](size_t i) {
+      float sum = 0;
+      float wt  = 0;
+      for (int k = -h; k <= h; k++)
+      {
+         const long j = (long)i + k;
+         if (j < 0 || j >= (long)n)
+            continue;
+         const float w = (float)(h + 1 - std::abs(k));
+         sum += w * in[j];
+         wt += w;
+      }
+      out[i] = sum / wt;
+   };
+   for (size_t i = 0; i < lo; i++)
+      edge(i);
+   for (size_t i = hi; i < n; i++)
+      edge(i);
+}
+
+const char* motorClassFor(double impulseNs)
+{
+   static const char* const CLASSES[] = {"1/4A", "1/2A", "A", "B", "C", "D", "E", "F", "G",
+                                         "H",    "I",    "J", "K", "L", "M", "N", "O"};
+   double upper = 0.625; // 1/4A tops out at 0.625 N*s; each class doubles
+   if (impulseNs <= 0.3125)
+      return "";
+   for (const char* c : CLASSES)
+   {
+      if (impulseNs <= upper)
+         return c;
+      upper *= 2;
+   }
+   return "P+";
+}
+
+ThrustStats analyseThrust(const float* newtons, size_t n, double rateHz, double thresholdFraction)
+{
+   ThrustStats stats;
+   if (n == 0 || rateHz <= 0)
+      return stats;
+
+   const double dt   = 1.0 / rateHz;
+   size_t       peak = 0;
+   stats.peakThrust  = peakValue(newtons, n, &peak);
+   stats.peakTime    = peak * dt;
+   if (stats.peakThrust <= 0)
+      return stats;
+
+   // Burn window: first to last sample at or above the threshold
+   const float threshold = (float)(stats.peakThrust * thresholdFraction);
+   size_t      first     = 0;
+   while (newtons[first] < threshold)
+      first++;
+   size_t last = n - 1;
+   while (newtons[last] < threshold)
+      last--;
+
+   stats.burnStart    = first * dt;
+   stats.burnTime     = (last - first) * dt;
+   stats.totalImpulse = trapezoidIntegral(newtons + first, last - first + 1, dt);
+   if (stats.burnTime > 0)
+      stats.averageThrust = stats.totalImpulse / stats.burnTime;
+
+   stats.motorClass  = motorClassFor(stats.totalImpulse);
+   stats.designation = stats.motorClass + std::to_string((long)std::lround(stats.averageThrust));
+   return stats;
+}
@@ -0,0 +1,107 @@
+#ifndef THRUST_ANALYSIS_H
+#define THRUST_ANALYSIS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "SerialFrame.h"
+
+// Thrust log loaded from a static-fire capture or a CSV file
+struct ThrustLog
+{
+   double               rateHz      = 0;
+   std::vector<float>   newtons;
+   uint32_t             dropped     = 0; // reported by the capture's end frame
+   uint32_t             gapSamples  = 0; // lost frames, filled with the last value
+   uint32_t             frameErrors = 0;
+   bool                 complete    = false; // end frame seen (binary) / always true (CSV)
+};
+
+// Conversion from raw load-cell counts to newtons
+struct ThrustCalibration
+{
+   double   newtonsPerCount = 1.0;
+   double   offsetCounts    = 0.0;
+   bool     autoTare        = false; // subtract the mean of the first tareMs of data
+   double   tareMs          = 50.0;
+};
+
+// Summary of one burn
+struct ThrustStats
+{
+   double      totalImpulse  = 0; // N*s over the burn window
+   double      peakThrust    = 0; // N
+   double      peakTime      = 0; // s from the start of the log
+   double      burnStart     = 0; // s, first sample at or above the threshold
+   double      burnTime      = 0; // s, until the last sample at or above it
+   double      averageThrust = 0; // N, impulse / burn time
+   std::string motorClass;        // "1/2A", "A" ... "O"
+   std::string designation;       // class + average thrust, e.g. "C6"
+};
+
+// Streaming parser for the firmware's binary capture frames (S/D/E)
+class CaptureFrameReader
+{
+ public:
+   explicit CaptureFrameReader(const ThrustCalibration& cal) : cal(cal)
+   {
+   }
+
+   void feed(const uint8_t* data, size_t len);
+
+   // Apply the calibration and hand over the result
+   void finish(ThrustLog& log);
+
+ private:
+   ThrustCalibration    cal;
+   FrameDecoder         decoder;
+   std::vector<int32_t> counts;
+   double               rateHz     = 0;
+   uint32_t             dropped    = 0;
+   uint32_t             gapSamples = 0;
+   bool                 complete   = false;
+
+   void                 onFrame();
+};
+
+// Streaming parser for CSV logs: "time_s,thrust" or a single thrust column (needs a rate)
+class CsvThrustReader
+{
+ public:
+   CsvThrustReader(const ThrustCalibration& cal, double rateHz) : cal(cal), rateHz(rateHz)
+   {
+   }
+
+   void feed(const char* data, size_t len);
+   bool finish(ThrustLog& log, std::string& error);
+
+ private:
+   ThrustCalibration  cal;
+   double             rateHz;
+   std::string        partial;
+   std::vector<float> values;
+   double             firstTime = 0;
+   double             lastTime  = 0;
+   size_t             timed     = 0;
+   size_t             badLines  = 0;
+
+   void               parseLine(const char* begin, const char* end);
+};
+
+// Read a whole log from a stream in fixed-size chunks; binary if it starts with a frame sync
+bool        readThrustLog(FILE* in, const ThrustCalibration& cal, double csvRateHz, ThrustLog& log,
+                          std::string& error);
+
+// Analysis kernels (plain loops written to auto-vectorise)
+double      trapezoidIntegral(const float* x, size_t n, double dt);
+float       peakValue(const float* x, size_t n, size_t* index);
+void        smoothThrust(const float* in, float* out, size_t n, unsigned halfWidth);
+ThrustStats analyseThrust(const float* newtons, size_t n, double rateHz,
+                          double thresholdFraction = 0.05);
+
+// NAR/CAR total-impulse class ("" below 1/4A)
+const char* motorClassFor(double impulseNs);
+
+#endif // THRUST_ANALYSIS_H
@@ -0,0 +1,399 @@
+#include "TraceStore.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "ArduinoInterface.h"
+#include "SerialFrame.h"
+#include "Telemetry.h"
+
+namespace
+{
+   const char MAGIC[4] = {'R', 'T', 'S', '1'};
+
+   uint64_t align64(uint64_t offset)
+   {
+      return (offset + 63) & ~(uint64_t)63;
+   }
+
+   uint32_t blocksFor(uint64_t rows)
+   {
+      return (uint32_t)((rows + TRACE_BLOCK_ROWS - 1) / TRACE_BLOCK_ROWS);
+   }
+
+   // Rows [begin, end) of block b
+   void blockRows(const TraceStoreReader& store, uint32_t b, uint64_t& begin, uint64_t& end)
+   {
+      begin = (uint64_t)b * TRACE_BLOCK_ROWS;
+      end   = std::min<uint64_t>(begin + TRACE_BLOCK_ROWS, store.rows());
+   }
+
+   // Next row in [i, end) in the given state; end if none (memchr is the fast scan here)
+   uint64_t findState(const uint8_t* state, uint64_t i, uint64_t end, uint8_t s)
+   {
+      const void* hit = i < end ? memchr(state + i, s, end - i) : nullptr;
+      return hit ? (uint64_t)((const uint8_t*)hit - state) : end;
+   }
+
+   // First row in [i, end) not in the given state; eight rows per compare
+   uint64_t findOtherState(const uint8_t* state, uint64_t i, uint64_t end, uint8_t s)
+   {
+      const uint64_t pattern = 0x0101010101010101ull * s;
+      for (; i + 8 <= end; i += 8)
+      {
+         uint64_t word;
+         memcpy(&word, state + i, sizeof(word));
+         if (word != pattern)
+            return i + __builtin_ctzll(word ^ pattern) / 8; // little-endian host
+      }
+      while (i < end && state[i] == s)
+         i++;
+      return i;
+   }
+
+   // Row i starts a stay in its state (first of its session, or the state changed)
+   bool entersState(const uint8_t* state, const uint32_t* session, uint64_t i)
+   {
+      return i == 0 || state[i - 1] != state[i] || session[i - 1] != session[i];
+   }
+} // namespace
+
+TraceStoreReader::~TraceStoreReader()
+{
+   if (base)
+      munmap((void*)base, size);
+}
+
+bool TraceStoreReader::open(const std::string& path, std::string& error)
+{
+   const int fd = ::open(path.c_str(), O_RDONLY);
+   struct stat st;
+   if (fd < 0 || fstat(fd, &st) != 0)
+   {
+      if (fd >= 0)
+         close(fd);
+      error = "cannot open " + path;
+      return false;
+   }
+   size             = (size_t)st.st_size;
+   void* const view = size >= sizeof(TraceStoreHeader)
+                          ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)
+                          : MAP_FAILED;
+   close(fd);
+   if (view == MAP_FAILED)
+   {
+      size  = 0;
+      error = path + " is not a trace store";
+      return false;
+   }
+   base   = (const uint8_t*)view;
+   header = (const TraceStoreHeader*)base;
+
+   // Everything the accessors hand out has to lie inside the mapping
+   const TraceStoreHeader& h  = *header;
+   bool                    ok = memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+             h.blockRows == TRACE_BLOCK_ROWS && h.blocks == blocksFor(h.rows) &&
+             h.indexOffset + (uint64_t)h.blocks * sizeof(TraceBlockIndex) <= size &&
+             h.sessionOffset + (uint64_t)h.sessions * sizeof(TraceSession) <= size &&
+             h.namesOffset + h.namesBytes <= size;
+   static const uint8_t WIDTH[TRACE_COLUMNS] = {4, 4, 1, 1, 1};
+   for (uint8_t c = 0; ok && c < TRACE_COLUMNS; c++)
+      ok = h.columnOffset[c] % WIDTH[c] == 0 && h.columnOffset[c] + h.rows * WIDTH[c] <= size;
+   for (uint32_t s = 0; ok && s < h.sessions; s++)
+      ok = session(s).firstRow + session(s).rows <= h.rows &&
+           session(s).nameOffset < h.namesBytes;
+   if (ok && h.sessions)
+      ok = base[h.namesOffset + h.namesBytes - 1] == '\0';
+   if (!ok)
+   {
+      error = path + " is not a trace store or is damaged";
+      return false;
+   }
+   return true;
+}
+
+void TraceStoreWriter::beginSession(const std::string& name)
+{
+   sessions.push_back({ms.size(), 0, (uint32_t)names.size()});
+   names += name;
+   names += '\0';
+}
+
+void TraceStoreWriter::appendStore(const TraceStoreReader& store)
+{
+   const uint32_t firstSession = (uint32_t)sessions.size();
+   const uint64_t firstRow     = ms.size();
+   const uint64_t n            = store.rows();
+   for (uint64_t i = 0; i < n; i++)
+      session.push_back(store.sessionColumn()[i] + firstSession);
+   ms.insert(ms.end(), store.msColumn(), store.msColumn() + n);
+   state.insert(state.end(), store.stateColumn(), store.stateColumn() + n);
+   inputs.insert(inputs.end(), store.inputColumn(), store.inputColumn() + n);
+   outputs.insert(outputs.end(), store.outputColumn(), store.outputColumn() + n);
+   for (uint32_t s = 0; s < store.sessions(); s++)
+   {
+      TraceSession copy = store.session(s);
+      copy.firstRow += firstRow;
+      copy.nameOffset = (uint32_t)names.size();
+      sessions.push_back(copy);
+      names += store.sessionName(s);
+      names += '\0';
+   }
+}
+
+uint32_t TraceStoreWriter::addCapture(const uint8_t* data, size_t len, const std::string& name)
+{
+   FrameDecoder decoder;
+   uint32_t     added  = 0;
+   uint32_t     lastMs = 0;
+   for (size_t i = 0; i < len; i++)
+   {
+      TelemetrySample sample;
+      if (!decoder.feed(data[i]) || decoder.type() != FRAME_TELEMETRY ||
+          !decodeTelemetry(decoder.payload(), decoder.length(), sample))
+         continue;
+
+      // Time going backwards is a device reset: the rest is another session
+      if (!added || sample.ms < lastMs)
+      {
+         beginSession(added ? name + "#" + std::to_string(added + 1) : name);
+         added++;
+      }
+      lastMs = sample.ms;
+      session.push_back((uint32_t)sessions.size() - 1);
+      ms.push_back(sample.ms);
+      state.push_back(sample.state);
+      inputs.push_back(sample.inputs);
+      outputs.push_back(sample.outputs);
+      sessions.back().rows++;
+   }
+   return added;
+}
+
+bool TraceStoreWriter::write(const std::string& path, std::string& error) const
+{
+   // Block index
+   const uint64_t               rows = ms.size();
+   std::vector<TraceBlockIndex> index(blocksFor(rows));
+   for (uint32_t b = 0; b < index.size(); b++)
+   {
+      const uint64_t   begin = (uint64_t)b * TRACE_BLOCK_ROWS;
+      const uint64_t   end   = std::min<uint64_t>(begin + TRACE_BLOCK_ROWS, rows);
+      TraceBlockIndex& x     = index[b];
+      x.firstSession         = session[begin];
+      x.lastSession          = session[end - 1];
+      x.minMs                = ms[begin];
+      x.maxMs                = ms[begin];
+      x.inputsAll            = 0xFF;
+      x.outputsAll           = 0xFF;
+      for (uint64_t i = begin; i < end; i++)
+      {
+         x.minMs = std::min(x.minMs, ms[i]);
+         x.maxMs = std::max(x.maxMs, ms[i]);
+         x.states |= (uint16_t)(1u << (state[i] & 15));
+         x.inputsAny |= inputs[i];
+         x.inputsAll &= inputs[i];
+         x.outputsAny |= outputs[i];
+         x.outputsAll &= outputs[i];
+      }
+   }
+
+   // Layout: header, index, sessions, names, then each column on its own cache line
+   TraceStoreHeader header = {};
+   memcpy(header.magic, MAGIC, sizeof(MAGIC));
+   header.blockRows     = TRACE_BLOCK_ROWS;
+   header.rows          = rows;
+   header.blocks        = (uint32_t)index.size();
+   header.sessions      = (uint32_t)sessions.size();
+   header.indexOffset   = align64(sizeof(header));
+   header.sessionOffset = align64(header.indexOffset + index.size() * sizeof(TraceBlockIndex));
+   header.namesOffset   = align64(header.sessionOffset + sessions.size() * sizeof(TraceSession));
+   header.namesBytes    = names.size();
+
+   const void*  columns[] = {session.data(), ms.data(), state.data(), inputs.data(),
+                             outputs.data()};
+   const size_t widths[]  = {4, 4, 1, 1, 1};
+   uint64_t     offset    = header.namesOffset + names.size();
+   for (uint8_t c = 0; c < TRACE_COLUMNS; c++)
+   {
+      header.columnOffset[c] = align64(offset);
+      offset                 = header.columnOffset[c] + rows * widths[c];
+   }
+
+   const std::string tmp = path + ".tmp";
+   FILE*             f   = fopen(tmp.c_str(), "wb");
+   if (!f)
+   {
+      error = "cannot write " + tmp;
+      return false;
+   }
+   uint64_t pos = 0;
+   bool     ok  = true;
+   auto     put = [&](uint64_t at, const void* data, size_t len)
+   {
+      static const uint8_t ZEROS[64] = {0};
+      ok                             = ok && fwrite(ZEROS, 1, at - pos, f) == at - pos &&
+           (len == 0 || fwrite(data, 1, len, f) == len);
+      pos = at + len;
+   };
+   put(0, &header, sizeof(header));
+   put(header.indexOffset, index.data(), index.size() * sizeof(TraceBlockIndex));
+   put(header.sessionOffset, sessions.data(), sessions.size() * sizeof(TraceSession));
+   put(header.namesOffset, names.data(), names.size());
+   for (uint8_t c = 0; c < TRACE_COLUMNS; c++)
+      put(header.columnOffset[c], columns[c], rows * widths[c]);
+   ok = fclose(f) == 0 && ok;
+   if (!ok || rename(tmp.c_str(), path.c_str()) != 0)
+   {
+      remove(tmp.c_str());
+      error = "cannot write " + path;
+      return false;
+   }
+   return true;
+}
+
+std::vector<StateVisit> queryTimeInState(const TraceStoreReader& store, State state,
+                                         TraceScan& scan)
+{
+   const uint8_t   s       = (uint8_t)state;
+   const uint8_t*  states  = store.stateColumn();
+   const uint32_t* session = store.sessionColumn();
+   const uint32_t* ms      = store.msColumn();
+
+   std::vector<StateVisit> visits;
+   for (uint32_t b = 0; b < store.blocks(); b++)
+   {
+      if (!(store.block(b).states & (1u << s)))
+      {
+         scan.blocksSkipped++;
+         continue;
+      }
+      scan.blocksScanned++;
+      uint64_t begin, end;
+      blockRows(store, b, begin, end);
+      scan.bytesScanned += end - begin;
+
+      for (uint64_t i = findState(states, begin, end, s); i < end;
+           i          = findState(states, i + 1, end, s))
+      {
+         // Rows carrying on a stay from the previous block are skipped in one go
+         if (!entersState(states, session, i))
+         {
+            i = findOtherState(states, i, end, s) - 1;
+            continue;
+         }
+
+         // Follow the stay to its end, into later blocks but never past its session
+         const TraceSession& owner      = store.session(session[i]);
+         const uint64_t      sessionEnd = owner.firstRow + owner.rows;
+         const uint64_t      j          = findOtherState(states, i + 1, sessionEnd, s);
+         const bool          complete   = j < sessionEnd;
+         visits.push_back({session[i], ms[i], (complete ? ms[j] : ms[j - 1]) - ms[i], complete});
+         scan.bytesScanned += j - i + 8;
+         i = std::min(j, end) - 1;
+      }
+   }
+   return visits;
+}
+
+std::vector<ReleaseNearEnd> queryReleaseNearCountdownEnd(const TraceStoreReader& store,
+                                                         uint32_t withinMs, TraceScan& scan)
+{
+   const uint8_t   countdown = (uint8_t)State::LAUNCH_COUNTDOWN;
+   const uint8_t*  states    = store.stateColumn();
+   const uint8_t*  inputs    = store.inputColumn();
+   const uint32_t* session   = store.sessionColumn();
+   const uint32_t* ms        = store.msColumn();
+
+   std::vector<ReleaseNearEnd> found;
+   for (uint32_t b = 0; b < store.blocks(); b++)
+   {
+      // A countdown needs LAUNCH held, so both the state and the input have to appear
+      const TraceBlockIndex& x = store.block(b);
+      if (!(x.states & (1u << countdown)) || !(x.inputsAny & INPUT_BIT_LAUNCH))
+      {
+         scan.blocksSkipped++;
+         continue;
+      }
+      scan.blocksScanned++;
+      uint64_t begin, end;
+      blockRows(store, b, begin, end);
+      scan.bytesScanned += end - begin;
+
+      for (uint64_t i = findState(states, begin, end, countdown); i < end;
+           i          = findState(states, i + 1, end, countdown))
+      {
+         // Rows carrying on a stay from the previous block are skipped in one go
+         if (!entersState(states, session, i))
+         {
+            i = findOtherState(states, i, end, countdown) - 1;
+            continue;
+         }
+
+         // The countdown ends HOLD_TO_LAUNCH_MS after it starts, unless a release cut it
+         // short; time only grows within a session, so jump straight to the window
+         const TraceSession& owner      = store.session(session[i]);
+         const uint64_t      sessionEnd = owner.firstRow + owner.rows;
+         const int64_t       endMs      = (int64_t)ms[i] + RocketController::HOLD_TO_LAUNCH_MS;
+         const int64_t       fromMs     = std::max<int64_t>(endMs - withinMs, ms[i] + 1);
+         uint64_t            j = std::lower_bound(ms + i + 1, ms + sessionEnd, fromMs) - ms;
+         const uint64_t      from       = j;
+         bool                hit        = false;
+         int32_t             best       = 0;
+         for (; j < sessionEnd && ms[j] <= endMs + withinMs; j++)
+         {
+            const bool    released = (inputs[j - 1] & INPUT_BIT_LAUNCH) &&
+                                  !(inputs[j] & INPUT_BIT_LAUNCH);
+            const int32_t offset   = (int32_t)(ms[j] - endMs);
+            if (released && (!hit || std::abs(offset) < std::abs(best)))
+            {
+               hit  = true;
+               best = offset;
+            }
+         }
+         scan.bytesScanned += (j - from) * 5 + 64;
+         const uint64_t next = findOtherState(states, i + 1, sessionEnd, countdown);
+         if (hit)
+            found.push_back({session[i], ms[i], best, next < sessionEnd ? states[next] : countdown});
+         scan.bytesScanned += next - i;
+         i = std::min(next, end) - 1;
+      }
+   }
+   return found;
+}
+
+std::vector<uint32_t> querySessionsWithState(const TraceStoreReader& store, State state,
+                                             TraceScan& scan)
+{
+   const uint8_t         s      = (uint8_t)state;
+   const uint8_t*        states = store.stateColumn();
+   std::vector<uint32_t> found;
+   for (uint32_t b = 0; b < store.blocks(); b++)
+   {
+      if (!(store.block(b).states & (1u << s)))
+      {
+         scan.blocksSkipped++;
+         continue;
+      }
+      scan.blocksScanned++;
+      uint64_t begin, end;
+      blockRows(store, b, begin, end);
+
+      // One hit per session is enough: jump to the end of it
+      for (uint64_t i = findState(states, begin, end, s); i < end;)
+      {
+         const uint32_t      id      = store.sessionColumn()[i];
+         const TraceSession& session = store.session(id);
+         if (found.empty() || found.back() != id)
+            found.push_back(id);
+         scan.bytesScanned += i - begin + 4;
+         begin = std::min<uint64_t>(session.firstRow + session.rows, end);
+         i     = findState(states, begin, end, s);
+      }
+      scan.bytesScanned += end - begin;
+   }
+   return found;
+}
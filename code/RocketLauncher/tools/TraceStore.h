@@ -0,0 +1,199 @@
+#ifndef TRACE_STORE_H
+#define TRACE_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "RocketController.h"
+
+// Columnar store of recorded controller sessions
+//
+// Every telemetry sample becomes a row of five columns (session, ms, state,
+// inputs, outputs), each column one contiguous array so a query touches only
+// the bytes it tests. Rows are grouped in blocks of TRACE_BLOCK_ROWS with a
+// small index per block (session range, time range, the states present, and
+// the input and output bits ever set or always set), which lets a query skip
+// every block that cannot match without reading it. Sessions are appended in
+// order and never interleave. The file is read through mmap and written in
+// host byte order (the tool is host-only).
+static constexpr uint32_t TRACE_BLOCK_ROWS = 1024;
+static constexpr uint8_t  TRACE_COLUMNS    = 5;
+
+struct TraceStoreHeader
+{
+   char     magic[4]; // "RTS1"
+   uint32_t blockRows;
+   uint64_t rows;
+   uint32_t blocks;
+   uint32_t sessions;
+   uint64_t indexOffset;   // TraceBlockIndex[blocks]
+   uint64_t sessionOffset; // TraceSession[sessions]
+   uint64_t namesOffset;   // NUL-terminated session names
+   uint64_t namesBytes;
+   uint64_t columnOffset[TRACE_COLUMNS]; // session u32, ms u32, state, inputs, outputs u8
+};
+
+struct TraceBlockIndex
+{
+   uint32_t firstSession;
+   uint32_t lastSession;
+   uint32_t minMs;
+   uint32_t maxMs;
+   uint16_t states;     // bit per State present
+   uint8_t  inputsAny;  // OR of the input masks
+   uint8_t  inputsAll;  // AND of the input masks
+   uint8_t  outputsAny;
+   uint8_t  outputsAll;
+   uint16_t reserved;
+};
+
+struct TraceSession
+{
+   uint64_t firstRow;
+   uint32_t rows;
+   uint32_t nameOffset;
+};
+
+// Read-only view of a store file
+class TraceStoreReader
+{
+ public:
+   TraceStoreReader() = default;
+   ~TraceStoreReader();
+   TraceStoreReader(const TraceStoreReader&)            = delete;
+   TraceStoreReader& operator=(const TraceStoreReader&) = delete;
+
+   bool open(const std::string& path, std::string& error);
+
+   uint64_t rows() const
+   {
+      return header->rows;
+   }
+
+   uint32_t blocks() const
+   {
+      return header->blocks;
+   }
+
+   uint32_t sessions() const
+   {
+      return header->sessions;
+   }
+
+   size_t fileSize() const
+   {
+      return size;
+   }
+
+   const uint32_t* sessionColumn() const
+   {
+      return (const uint32_t*)(base + header->columnOffset[0]);
+   }
+
+   const uint32_t* msColumn() const
+   {
+      return (const uint32_t*)(base + header->columnOffset[1]);
+   }
+
+   const uint8_t* stateColumn() const
+   {
+      return base + header->columnOffset[2];
+   }
+
+   const uint8_t* inputColumn() const
+   {
+      return base + header->columnOffset[3];
+   }
+
+   const uint8_t* outputColumn() const
+   {
+      return base + header->columnOffset[4];
+   }
+
+   const TraceBlockIndex& block(uint32_t b) const
+   {
+      return ((const TraceBlockIndex*)(base + header->indexOffset))[b];
+   }
+
+   const TraceSession& session(uint32_t s) const
+   {
+      return ((const TraceSession*)(base + header->sessionOffset))[s];
+   }
+
+   const char* sessionName(uint32_t s) const
+   {
+      return (const char*)base + header->namesOffset + session(s).nameOffset;
+   }
+
+ private:
+   const uint8_t*          base   = nullptr;
+   const TraceStoreHeader* header = nullptr;
+   size_t                  size   = 0;
+};
+
+// Builds a store in memory and writes it out in one go
+class TraceStoreWriter
+{
+ public:
+   // Keep the sessions of an existing store ahead of anything added
+   void     appendStore(const TraceStoreReader& store);
+
+   // Telemetry frames from one capture; a device reset starts a new session.
+   // Returns the number of sessions added.
+   uint32_t addCapture(const uint8_t* data, size_t len, const std::string& name);
+
+   // Written beside the target and renamed over it, so readers never see half a store
+   bool     write(const std::string& path, std::string& error) const;
+
+   uint64_t rows() const
+   {
+      return ms.size();
+   }
+
+ private:
+   std::vector<uint32_t>     session;
+   std::vector<uint32_t>     ms;
+   std::vector<uint8_t>      state;
+   std::vector<uint8_t>      inputs;
+   std::vector<uint8_t>      outputs;
+   std::vector<TraceSession> sessions;
+   std::string               names;
+
+   void                      beginSession(const std::string& name);
+};
+
+// Blocks and bytes a query had to read
+struct TraceScan
+{
+   uint32_t blocksScanned = 0;
+   uint32_t blocksSkipped = 0;
+   uint64_t bytesScanned  = 0;
+};
+
+// One stay in a state
+struct StateVisit
+{
+   uint32_t session;
+   uint32_t enteredMs;
+   uint32_t durationMs;
+   bool     complete; // false if the trace ended first
+};
+
+// A LAUNCH release near the instant a countdown ends (or would have)
+struct ReleaseNearEnd
+{
+   uint32_t session;
+   uint32_t countdownMs; // countdown entered
+   int32_t  offsetMs;    // release minus countdown end; negative aborted it
+   uint8_t  nextState;   // where the countdown went
+};
+
+std::vector<StateVisit>     queryTimeInState(const TraceStoreReader& store, State state,
+                                             TraceScan& scan);
+std::vector<ReleaseNearEnd> queryReleaseNearCountdownEnd(const TraceStoreReader& store,
+                                                         uint32_t withinMs, TraceScan& scan);
+std::vector<uint32_t>       querySessionsWithState(const TraceStoreReader& store, State state,
+                                                   TraceScan& scan);
+
+#endif // TRACE_STORE_H
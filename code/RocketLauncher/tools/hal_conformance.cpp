@@ -0,0 +1,160 @@
+// hal_conformance - check and time the host ArduinoInterface backends
+//
+//   hal_conformance [--iterations N] [backend ...]
+//
+// Runs the HAL conformance suite (src/HalConformance.h) on each backend named,
+// or on all of them, and prints one table per backend. The rows are the same
+// for every backend, so two tables compare line by line:
+//
+//   sim      SimArduinoInterface, the simulator's hardware model
+//   queued   QueuedUiInterface over the simulator, as the RTOS build uses it
+//            (LCD times are those of drawing into its screen buffer, buzzer
+//            times those of handing the call to a queue; past the queue's
+//            depth a buzzer call is dropped, as the safety task's would be)
+//
+// The unit tests run the same suite on the test mock, and a board runs it at
+// boot when built with -DROCKET_HAL_CONFORMANCE=1, so new backends are held
+// to the same checks and their costs land in the same table.
+//
+//   --iterations N   calls per timed batch (default 50000)
+//
+// Exit code: 0 when no check failed, 1 when any did, 2 on usage errors.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "HalConformance.h"
+#include "QueuedUiInterface.h"
+#include "SimArduinoInterface.h"
+
+namespace
+{
+   // The simulator shows everything and takes its inputs as clean levels
+   class SimProbe : public HalProbe
+   {
+    public:
+      explicit SimProbe(SimArduinoInterface& sim) : sim(sim)
+      {
+      }
+
+      bool toneFrequency(uint16_t& freq) override
+      {
+         freq = sim.getToneFreq();
+         return true;
+      }
+
+      bool lcdRow(uint8_t row, char* text, uint8_t size) override
+      {
+         snprintf(text, size, "%s", sim.getLcdLine(row));
+         return true;
+      }
+
+      bool driveInputs(uint8_t mask) override
+      {
+         sim.setInputs(mask);
+         return true;
+      }
+
+    private:
+      SimArduinoInterface& sim;
+   };
+
+   // The queued display and buzzer only reach the simulator once drained
+   class QueuedProbe : public SimProbe
+   {
+    public:
+      QueuedProbe(SimArduinoInterface& sim, QueuedUiInterface& ui) : SimProbe(sim), ui(ui)
+      {
+      }
+
+      void settle() override
+      {
+         while (ui.drainLcd(LCD_CALLS) || ui.drainAudio(QueuedUiInterface::AUDIO_QUEUE))
+         {
+         }
+      }
+
+    private:
+      static constexpr uint16_t LCD_CALLS = 8; // as the RTOS display task drains
+      QueuedUiInterface&        ui;
+   };
+
+   uint32_t hostNanos()
+   {
+      using namespace std::chrono;
+      return (uint32_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+   }
+
+   void printLine(const char* line)
+   {
+      printf("%s\n", line);
+   }
+
+   // Whole suite on one backend; true when nothing failed
+   bool runBackend(const char* name, uint16_t iterations)
+   {
+      HalConformance::Config config;
+      config.relayPin   = SimArduinoInterface::PIN_RELAY;
+      config.iterations = iterations;
+
+      SimArduinoInterface sim;
+      if (strcmp(name, "sim") == 0)
+      {
+         SimProbe       probe(sim);
+         HalConformance suite(&sim, &probe, hostNanos);
+         suite.run(config);
+         suite.report(name, printLine);
+         return suite.count(HalConformance::FAIL) == 0;
+      }
+      QueuedUiInterface ui(&sim);
+      QueuedProbe       probe(sim, ui);
+      HalConformance    suite(&ui, &probe, hostNanos);
+      suite.run(config);
+      suite.report(name, printLine);
+      if (ui.getDropped())
+         printf("  (%u calls dropped on full queues while timing)\n", ui.getDropped());
+      return suite.count(HalConformance::FAIL) == 0;
+   }
+
+   void usage()
+   {
+      fprintf(stderr, "usage: hal_conformance [--iterations N] [sim|queued ...]\n");
+   }
+} // namespace
+
+int main(int argc, char** argv)
+{
+   static const char* const ALL[] = {"sim", "queued"};
+   long                     iterations = 50000;
+   std::vector<const char*> backends;
+   for (int i = 1; i < argc; i++)
+   {
+      if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+         iterations = atol(argv[++i]);
+      else if (strcmp(argv[i], "sim") == 0 || strcmp(argv[i], "queued") == 0)
+         backends.push_back(argv[i]);
+      else
+      {
+         usage();
+         return 2;
+      }
+   }
+   if (iterations < 1 || iterations > 0xFFFF)
+   {
+      fprintf(stderr, "hal_conformance: --iterations must be 1 to 65535\n");
+      return 2;
+   }
+   if (backends.empty())
+      backends.assign(ALL, ALL + 2);
+
+   bool conforms = true;
+   for (size_t i = 0; i < backends.size(); i++)
+   {
+      if (i)
+         printf("\n");
+      conforms = runBackend(backends[i], (uint16_t)iterations) && conforms;
+   }
+   return conforms ? 0 : 1;
+}
@@ -0,0 +1,407 @@
+// igniter_sweep - size the relay pulse for an igniter and battery
+//
+//   igniter_sweep [options] <igniter> <battery>
+//   igniter_sweep [options] --grid
+//
+//   --leads OHMS   round-trip lead resistance to the pad (default 0.5)
+//   --trials N     launches per igniter/battery pair (default 2000)
+//   --seed S       part-to-part variation seed (default 1)
+//   --margin X     pulse = slowest fire times X, rounded up to 50 ms (default 1.5)
+//   --hold PCT     relay coil hold duty after pull-in, as ROCKET_RELAY_HOLD_PCT (default 100)
+//   --pull-in MS   full coil drive before the hold, as ROCKET_RELAY_PULLIN_MS (default 30)
+//   -j N           threads (default all cores)
+//
+// Igniters: estes, ematch, nichrome. Batteries: 9v, 4aa, sla12, lipo3s.
+//
+// Every trial is one launch: RocketController is taken from READY through the
+// countdown into LAUNCHING, and the relay pin drives PowerModel in 1 ms steps
+// until the controller opens the relay. Each trial
+// draws its own parts (igniter resistance, thermal mass and firing point,
+// battery charge and internal resistance), so the slowest fire stands for a
+// worn battery and an unlucky igniter. The sweep runs once with the default
+// 5 s pulse to find the firing times, then again with the recommended pulse
+// to confirm every trial still fires and to compare the charge drawn and the
+// current the relay contacts have to break. The energy the relay coil takes
+// from the controller's supply is reported alongside; with --hold, a hold too
+// weak to keep the contacts closed shows up as drop-outs and misfires.
+//
+// Exit code: 0 when every pair has a pulse that fired every trial, 1 when
+// some trial did not fire even in 5 s, 2 on usage errors.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "PowerModel.h"
+#include "RocketController.h"
+#include "SimArduinoInterface.h"
+
+namespace
+{
+   static constexpr uint32_t PULSE_STEP_MS = 50;
+   static constexpr uint32_t RELAY_PIN     = 8;
+   static constexpr uint32_t COARSE_MS     = 10;    // tick until the relay closes
+   static constexpr uint32_t GIVE_UP_MS    = 20000; // controller never reached LAUNCHING
+
+   // One launch as the firing circuit saw it
+   struct Trial
+   {
+      bool   fired     = false;
+      double fireMs    = 0;
+      double openMs    = -1; // igniter burnt open, relay still closed
+      double chargeMah = 0;
+      double energyJ   = 0;
+      double breakAmps = 0;
+      double peakAmps  = 0;
+      double minVolts  = 0;
+      double coilJ     = 0;
+      bool   dropped   = false; // relay contacts let go during the hold
+   };
+
+   // Relay coil drive, as the firmware build has it
+   struct CoilDrive
+   {
+      uint16_t pullInMs = 30;
+      uint8_t  holdPct  = 100;
+   };
+
+   struct Pair
+   {
+      Circuit            circuit;
+      std::vector<Trial> atDefault;
+      std::vector<Trial> atPulse;
+      uint16_t           pulseMs = 0;
+   };
+
+   uint64_t splitmix64(uint64_t& x)
+   {
+      uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+      z          = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+      z          = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+      return z ^ (z >> 31);
+   }
+
+   double uniform(uint64_t& state, double lo, double hi)
+   {
+      return lo + (hi - lo) * (double)(splitmix64(state) >> 11) / (double)(1ull << 53);
+   }
+
+   // Same draw for a trial whichever pulse it runs with
+   Circuit vary(const Circuit& base, uint64_t seed, size_t trial)
+   {
+      uint64_t state = seed * 0x100000001B3ull + trial;
+      Circuit  c     = base;
+      c.igniter.ohms *= uniform(state, 0.9, 1.1);
+      c.igniter.heatCapacity *= uniform(state, 0.85, 1.15);
+      c.igniter.fireRiseK *= uniform(state, 0.9, 1.1);
+      if (c.igniter.burnoutMs >= 0)
+         c.igniter.burnoutMs *= uniform(state, 0.5, 1.5);
+      c.battery.emfV *= uniform(state, 0.85, 1.0);         // fresh to well used
+      c.battery.internalOhms *= uniform(state, 1.0, 1.5); // and colder or older
+      return c;
+   }
+
+   Trial runLaunch(const Circuit& circuit, uint16_t pulseMs, const CoilDrive& drive)
+   {
+      SimArduinoInterface hal;
+      RocketController    rocket(&hal);
+      hal.setRelayHold(drive.pullInMs, drive.holdPct);
+      rocket.setRelayPulseMs(pulseMs);
+      rocket.enter(State::READY);
+      hal.setInputs(INPUT_BIT_ARM);
+
+      PowerModel model(circuit, 1.0);
+      Trial      trial;
+      bool       closed = false;
+      for (uint32_t t = 0; t < GIVE_UP_MS;)
+      {
+         if (rocket.getState() == State::ARMED)
+            hal.setInputs(INPUT_BIT_ARM | INPUT_BIT_LAUNCH);
+         t += closed ? 1 : COARSE_MS;
+         hal.setTime(t);
+         hal.updateDebouncers();
+         hal.serviceTimers();
+         rocket.update(t);
+
+         const bool relay = hal.digitalRead(RELAY_PIN) == HIGH;
+         if (!relay && !closed)
+            continue;
+         closed = true;
+         model.step(relay, hal.getCoilDuty());
+
+         // Once the igniter is open only the coil still draws, until the relay opens
+         if (!relay)
+            break;
+      }
+      trial.fired     = model.hasFired();
+      trial.fireMs    = model.getFireMs();
+      trial.openMs    = model.isOpen() ? model.getClosedMs() : -1;
+      trial.chargeMah = model.getChargeMah();
+      trial.energyJ   = model.getEnergyJ();
+      trial.breakAmps = model.getBreakCurrent();
+      trial.peakAmps  = model.getPeakCurrent();
+      trial.minVolts  = model.getMinTerminalVolts();
+      trial.coilJ     = model.getCoilEnergyJ();
+      trial.dropped   = model.hasDroppedOut();
+      return trial;
+   }
+
+   // Index space split over the threads; jobs are claimed one at a time
+   void parallelFor(size_t count, unsigned jobs, const std::function<void(size_t)>& body)
+   {
+      std::atomic<size_t> next(0);
+      auto                worker = [&]()
+      {
+         for (size_t i = next++; i < count; i = next++)
+            body(i);
+      };
+      std::vector<std::thread> pool;
+      for (unsigned j = 1; j < std::min<size_t>(jobs, count); j++)
+         pool.emplace_back(worker);
+      worker();
+      for (auto& t : pool)
+         t.join();
+   }
+
+   uint32_t countFired(const std::vector<Trial>& trials)
+   {
+      uint32_t n = 0;
+      for (const Trial& t : trials)
+         n += t.fired;
+      return n;
+   }
+
+   double mean(const std::vector<Trial>& trials, double Trial::*field)
+   {
+      double sum = 0;
+      for (const Trial& t : trials)
+         sum += t.*field;
+      return trials.empty() ? 0 : sum / trials.size();
+   }
+
+   // Firing times, sorted; only trials that fired
+   std::vector<double> fireTimes(const std::vector<Trial>& trials)
+   {
+      std::vector<double> times;
+      for (const Trial& t : trials)
+      {
+         if (t.fired)
+            times.push_back(t.fireMs);
+      }
+      std::sort(times.begin(), times.end());
+      return times;
+   }
+
+   // Longest the relay was closed before the igniter burnt open; negative if one never did
+   double slowestOpen(const std::vector<Trial>& trials)
+   {
+      double opened = 0;
+      for (const Trial& t : trials)
+         opened = t.openMs < 0 || opened < 0 ? -1 : std::max(opened, t.openMs);
+      return opened;
+   }
+
+   // Slowest fire plus margin; stretched to the slowest burn-open when every igniter opens
+   // in time, which costs no charge and spares the contacts from breaking current
+   uint16_t recommend(const std::vector<Trial>& trials, double margin)
+   {
+      const std::vector<double> times  = fireTimes(trials);
+      double                    wanted = times.empty() ? 0 : times.back() * margin;
+      const double              opened = slowestOpen(trials);
+      if (opened > wanted)
+         wanted = opened + 1;
+      const uint32_t pulse = (uint32_t)std::ceil(wanted / PULSE_STEP_MS) * PULSE_STEP_MS;
+      return (uint16_t)std::min<uint32_t>(
+          std::max<uint32_t>(pulse, RocketController::MIN_RELAY_PULSE_MS),
+          RocketController::RELAY_ON_MS);
+   }
+
+   void usage()
+   {
+      fprintf(stderr, "usage: igniter_sweep [--leads OHMS] [--trials N] [--seed S] [--margin X]\n"
+                      "                     [--hold PCT] [--pull-in MS] [-j N]\n"
+                      "                     <igniter> <battery> | --grid\n");
+   }
+
+   void printPulse(uint16_t pulseMs, const std::vector<Trial>& trials)
+   {
+      uint32_t live    = 0;
+      uint32_t dropped = 0;
+      for (const Trial& t : trials)
+      {
+         live += t.breakAmps > 0;
+         dropped += t.dropped;
+      }
+      printf("  pulse %4u ms   %u/%zu fired, %.1f mAh, %.2f J per launch, relay breaks current"
+             " in %u (mean %.2f A)\n",
+             (unsigned)pulseMs, countFired(trials), trials.size(),
+             mean(trials, &Trial::chargeMah), mean(trials, &Trial::energyJ), live,
+             mean(trials, &Trial::breakAmps));
+      printf("                  relay coil %.3f J per launch", mean(trials, &Trial::coilJ));
+      if (dropped)
+         printf(", contacts dropped out in %u", dropped);
+      printf("\n");
+   }
+
+   void printPair(const Pair& p, double margin)
+   {
+      const std::vector<double> times = fireTimes(p.atDefault);
+      printf("%s + %s, leads %.2f ohm\n", p.circuit.igniter.name, p.circuit.battery.name,
+             p.circuit.leadOhms);
+      if (!times.empty())
+         printf("  time to fire    p50 %.0f ms, p99 %.0f ms, slowest %.0f ms\n",
+                times[times.size() / 2], times[times.size() * 99 / 100], times.back());
+      printf("  peak current    %.2f A, battery sags to %.2f V\n",
+             mean(p.atDefault, &Trial::peakAmps), mean(p.atDefault, &Trial::minVolts));
+      printPulse(RocketController::RELAY_ON_MS, p.atDefault);
+      if (times.size() != p.atDefault.size())
+      {
+         printf("  no reliable pulse: %zu of %zu trials never fired\n",
+                p.atDefault.size() - times.size(), p.atDefault.size());
+         return;
+      }
+      printPulse(p.pulseMs, p.atPulse);
+      const double opened = slowestOpen(p.atDefault);
+      if (opened > times.back() * margin)
+         printf("  recommended     ROCKET_RELAY_MS=%u (slowest burn-open %.0f ms, rounded up to"
+                " %u ms)\n",
+                (unsigned)p.pulseMs, opened, (unsigned)PULSE_STEP_MS);
+      else
+         printf("  recommended     ROCKET_RELAY_MS=%u (slowest fire x%.2g, rounded up to %u ms)\n",
+                (unsigned)p.pulseMs, margin, (unsigned)PULSE_STEP_MS);
+   }
+
+   void printGridRow(const Pair& p)
+   {
+      const std::vector<double> times = fireTimes(p.atDefault);
+      printf("%-9s %-7s %5u/%-5zu", p.circuit.igniter.name, p.circuit.battery.name,
+             countFired(p.atDefault), p.atDefault.size());
+      if (times.size() != p.atDefault.size())
+      {
+         printf(" %7s %8s %7s %9s %9s %7s\n", "-", "-", "-", "-", "-", "-");
+         return;
+      }
+      printf(" %7.0f %8.0f %7u %9.1f %9.1f %7.2f\n", times[times.size() / 2], times.back(),
+             (unsigned)p.pulseMs, mean(p.atDefault, &Trial::chargeMah),
+             mean(p.atPulse, &Trial::chargeMah), mean(p.atPulse, &Trial::breakAmps));
+   }
+} // namespace
+
+int main(int argc, char** argv)
+{
+   unsigned    jobs     = std::max(1u, std::thread::hardware_concurrency());
+   double      leads    = 0.5;
+   size_t      trials   = 2000;
+   uint64_t    seed     = 1;
+   double      margin   = 1.5;
+   CoilDrive   drive;
+   bool        grid     = false;
+   const char* names[2] = {nullptr, nullptr};
+   int         named    = 0;
+
+   for (int i = 1; i < argc; i++)
+   {
+      const bool more = i + 1 < argc;
+      if (strcmp(argv[i], "--leads") == 0 && more)
+         leads = atof(argv[++i]);
+      else if (strcmp(argv[i], "--trials") == 0 && more)
+         trials = (size_t)std::max(1, atoi(argv[++i]));
+      else if (strcmp(argv[i], "--seed") == 0 && more)
+         seed = strtoull(argv[++i], nullptr, 10);
+      else if (strcmp(argv[i], "--margin") == 0 && more)
+         margin = atof(argv[++i]);
+      else if (strcmp(argv[i], "--hold") == 0 && more)
+         drive.holdPct = (uint8_t)std::min(100, std::max(0, atoi(argv[++i])));
+      else if (strcmp(argv[i], "--pull-in") == 0 && more)
+         drive.pullInMs = (uint16_t)std::min(1000, std::max(0, atoi(argv[++i])));
+      else if (strcmp(argv[i], "-j") == 0 && more)
+         jobs = std::max(1, atoi(argv[++i]));
+      else if (strcmp(argv[i], "--grid") == 0)
+         grid = true;
+      else if (argv[i][0] == '-' || named == 2)
+      {
+         usage();
+         return 2;
+      }
+      else
+         names[named++] = argv[i];
+   }
+   if (grid == (named == 2) || leads < 0 || margin < 1)
+   {
+      usage();
+      return 2;
+   }
+
+   // Igniter/battery pairs to sweep
+   std::vector<Pair> pairs;
+   if (grid)
+   {
+      uint8_t            igniterCount = 0;
+      uint8_t            batteryCount = 0;
+      const IgniterSpec* igniters     = igniterPresets(igniterCount);
+      const BatterySpec* batteries    = batteryPresets(batteryCount);
+      for (uint8_t i = 0; i < igniterCount; i++)
+      {
+         for (uint8_t b = 0; b < batteryCount; b++)
+            pairs.push_back({{igniters[i], batteries[b], leads}, {}, {}, 0});
+      }
+   }
+   else
+   {
+      const IgniterSpec* igniter = findIgniter(names[0]);
+      const BatterySpec* battery = findBattery(names[1]);
+      if (!igniter || !battery)
+      {
+         fprintf(stderr, "igniter_sweep: unknown %s '%s'\n", igniter ? "battery" : "igniter",
+                 igniter ? names[1] : names[0]);
+         return 2;
+      }
+      pairs.push_back({{*igniter, *battery, leads}, {}, {}, 0});
+   }
+   for (Pair& p : pairs)
+   {
+      p.atDefault.resize(trials);
+      p.atPulse.resize(trials);
+   }
+
+   // Firing times with the default pulse, then the recommended pulse re-run on the same parts
+   const auto t0 = std::chrono::steady_clock::now();
+   parallelFor(pairs.size() * trials, jobs, [&](size_t i) {
+      Pair& p                 = pairs[i / trials];
+      p.atDefault[i % trials] = runLaunch(vary(p.circuit, seed, i % trials),
+                                          RocketController::RELAY_ON_MS, drive);
+   });
+   for (Pair& p : pairs)
+      p.pulseMs = recommend(p.atDefault, margin);
+   parallelFor(pairs.size() * trials, jobs, [&](size_t i) {
+      Pair& p               = pairs[i / trials];
+      p.atPulse[i % trials] = runLaunch(vary(p.circuit, seed, i % trials), p.pulseMs, drive);
+   });
+   const double elapsedMs =
+       std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+   bool ok = true;
+   if (grid)
+      printf("igniter   battery  fired        p50 ms  slowest pulse ms mAh@5000 mAh@pulse"
+             " break A\n");
+   for (const Pair& p : pairs)
+   {
+      const bool reliable = countFired(p.atDefault) == trials && countFired(p.atPulse) == trials;
+      ok                  = ok && reliable;
+      if (grid)
+         printGridRow(p);
+      else
+         printPair(p, margin);
+   }
+
+   const size_t launches = pairs.size() * trials * 2;
+   printf("%zu launches in %.0f ms (%.0f configs/s on %u threads)\n", launches, elapsedMs,
+          launches / (elapsedMs / 1000.0), (unsigned)std::min<size_t>(jobs, launches));
+   return ok ? 0 : 1;
+}
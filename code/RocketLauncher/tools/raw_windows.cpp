@@ -0,0 +1,250 @@
+// raw_windows - undebounced input windows from a serial capture, for spurious-trigger forensics
+//
+//   raw_windows [--width N] [--csv FILE] <capture.bin | ->
+//
+// Reads the 'R' frames a controller with raw capture on sends (other frames and
+// serial text are skipped) and prints each window: what froze it, and for each
+// input a timeline with its raw transitions and shortest pulse, so a debounced
+// edge or a fault that came from contact bounce or a noise spike stands out.
+//
+//   --width N   timeline columns (default 64)
+//   --csv FILE  every sample as window,time_us,arm,reset,launch (time from the trigger)
+//
+// Exit code: 0 if at least one whole window was decoded, 1 if none, 2 on usage errors.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "ArduinoInterface.h"
+#include "RawCapture.h"
+#include "SerialFrame.h"
+#include "StateNames.h"
+
+namespace
+{
+   struct Window
+   {
+      uint32_t             ms      = 0;
+      uint8_t              reason  = 0;
+      uint8_t              state   = 0;
+      uint16_t             rateHz  = 0;
+      uint16_t             pre     = 0;
+      uint16_t             total   = 0;
+      uint16_t             missed  = 0;
+      std::vector<uint8_t> levels; // one INPUT_BIT_* mask per sample
+   };
+
+   // Reassembles windows from 'R' frames; a window with a missing chunk is dropped
+   class WindowReader
+   {
+    public:
+      // True when frame completed a window (then in out)
+      bool add(const uint8_t* p, uint8_t len, Window& out)
+      {
+         if (len < RAW_WINDOW_HEADER)
+         {
+            broken++;
+            return false;
+         }
+         const uint16_t first = frameGetU16(p + 14);
+         if (first == 0)
+         {
+            if (open)
+               broken++;
+            open           = true;
+            current        = Window();
+            current.ms     = frameGetU32(p);
+            current.reason = p[4];
+            current.state  = p[5];
+            current.rateHz = frameGetU16(p + 6);
+            current.pre    = frameGetU16(p + 8);
+            current.total  = frameGetU16(p + 10);
+            current.missed = frameGetU16(p + 12);
+         }
+         else if (!open || first != current.levels.size() || frameGetU32(p) != current.ms)
+         {
+            if (open)
+               broken++;
+            open = false;
+            return false;
+         }
+
+         for (uint8_t i = RAW_WINDOW_HEADER; i < len; i++)
+         {
+            for (uint8_t half = 0; half < 2 && current.levels.size() < current.total; half++)
+               current.levels.push_back((uint8_t)((p[i] >> (4 * half)) & 0x0F));
+         }
+         if (current.levels.size() < current.total)
+            return false;
+         open = false;
+         out  = current;
+         return true;
+      }
+
+      uint32_t brokenWindows() const
+      {
+         return broken + (open ? 1 : 0);
+      }
+
+    private:
+      Window   current;
+      bool     open   = false;
+      uint32_t broken = 0;
+   };
+
+   const char* reasonName(uint8_t reason)
+   {
+      switch (reason)
+      {
+         case RawCapture::EDGE:
+            return "EDGE";
+         case RawCapture::ABORT:
+            return "ABORT";
+         case RawCapture::FAULT:
+            return "FAULT";
+         default:
+            return "?";
+      }
+   }
+
+   void printWindow(const Window& w, unsigned number, unsigned width)
+   {
+      static const char* const NAMES[] = {"ARM", "RESET", "LAUNCH"};
+      const double             usPer   = w.rateHz ? 1e6 / w.rateHz : 0;
+      const size_t             n       = w.levels.size();
+
+      printf("window %u  t=%u ms  %s  state %s  %zu samples @ %u Hz, %u before", number, w.ms,
+             reasonName(w.reason), stateName((State)w.state), n, w.rateHz, w.pre);
+      if (w.missed)
+         printf("  (%u triggers missed)", w.missed);
+      printf("\n");
+
+      for (uint8_t bit = 0; bit < 3; bit++)
+      {
+         // A column is '#' if pressed throughout, '_' if released, '|' if it changed within
+         std::string line;
+         for (unsigned c = 0; c < width; c++)
+         {
+            const size_t from = n * c / width;
+            const size_t to   = n * (c + 1) / width;
+            bool         on   = false;
+            bool         off  = false;
+            for (size_t i = from; i < to; i++)
+               ((w.levels[i] >> bit) & 1 ? on : off) = true;
+            line += on && off ? '|' : (on ? '#' : '_');
+         }
+
+         // Transitions and the shortest complete pulse between two of them
+         unsigned edges    = 0;
+         size_t   shortest = 0;
+         size_t   lastEdge = 0;
+         for (size_t i = 1; i < n; i++)
+         {
+            if (((w.levels[i] ^ w.levels[i - 1]) >> bit) & 1)
+            {
+               if (edges && (shortest == 0 || i - lastEdge < shortest))
+                  shortest = i - lastEdge;
+               edges++;
+               lastEdge = i;
+            }
+         }
+         printf("  %-7s %s  %u edges", NAMES[bit], line.c_str(), edges);
+         if (shortest)
+            printf(", shortest pulse %.0f us", shortest * usPer);
+         printf("\n");
+      }
+
+      const unsigned at = n ? (unsigned)((size_t)w.pre * width / n) : 0;
+      printf("  %-7s %*s^ trigger (%.1f ms before, %.1f ms after)\n\n", "", at, "",
+             w.pre * usPer / 1000, (n - w.pre) * usPer / 1000);
+   }
+
+   void usage()
+   {
+      fprintf(stderr, "usage: raw_windows [--width N] [--csv out.csv] <capture | ->\n");
+   }
+} // namespace
+
+int main(int argc, char** argv)
+{
+   unsigned    width     = 64;
+   const char* csvPath   = nullptr;
+   const char* inputPath = nullptr;
+   for (int i = 1; i < argc; i++)
+   {
+      const bool more = i + 1 < argc;
+      if (strcmp(argv[i], "--width") == 0 && more)
+         width = (unsigned)atoi(argv[++i]);
+      else if (strcmp(argv[i], "--csv") == 0 && more)
+         csvPath = argv[++i];
+      else if (argv[i][0] == '-' && argv[i][1] != '\0')
+      {
+         usage();
+         return 2;
+      }
+      else if (!inputPath)
+         inputPath = argv[i];
+      else
+      {
+         usage();
+         return 2;
+      }
+   }
+   if (!inputPath || width == 0)
+   {
+      usage();
+      return 2;
+   }
+
+   FILE* in = strcmp(inputPath, "-") == 0 ? stdin : fopen(inputPath, "rb");
+   if (!in)
+   {
+      fprintf(stderr, "raw_windows: cannot open %s\n", inputPath);
+      return 2;
+   }
+   FILE* csv = nullptr;
+   if (csvPath)
+   {
+      csv = fopen(csvPath, "w");
+      if (!csv)
+      {
+         fprintf(stderr, "raw_windows: cannot write %s\n", csvPath);
+         if (in != stdin)
+            fclose(in);
+         return 2;
+      }
+      fprintf(csv, "window,time_us,arm,reset,launch\n");
+   }
+
+   FrameDecoder decoder;
+   WindowReader reader;
+   Window       w;
+   unsigned     windows = 0;
+   int          c;
+   while ((c = fgetc(in)) != EOF)
+   {
+      if (!decoder.feed((uint8_t)c) || decoder.type() != FRAME_RAW_WINDOW ||
+          !reader.add(decoder.payload(), decoder.length(), w))
+         continue;
+      printWindow(w, ++windows, width);
+      const double usPer = w.rateHz ? 1e6 / w.rateHz : 0;
+      for (size_t i = 0; csv && i < w.levels.size(); i++)
+      {
+         fprintf(csv, "%u,%.0f,%u,%u,%u\n", windows, ((double)i - w.pre) * usPer,
+                 w.levels[i] & INPUT_BIT_ARM ? 1 : 0, w.levels[i] & INPUT_BIT_RESET ? 1 : 0,
+                 w.levels[i] & INPUT_BIT_LAUNCH ? 1 : 0);
+      }
+   }
+   if (in != stdin)
+      fclose(in);
+   if (csv)
+      fclose(csv);
+
+   printf("%u windows", windows);
+   if (reader.brokenWindows() || decoder.errorCount())
+      printf(", %u incomplete, %u bad frames", reader.brokenWindows(), decoder.errorCount());
+   printf("\n");
+   return windows ? 0 : 1;
+}
@@ -0,0 +1,187 @@
+// rocket_dash - watch and drive a simulation started with rocket_sim --live
+//
+//   rocket_dash <name> [--hz N]           redraw the panel N times a second (default 10)
+//   rocket_dash <name> --once             print the newest frame and exit
+//   rocket_dash <name> --hold arm,launch  hold these inputs ("none" releases them all)
+//   rocket_dash <name> --stop             end the run
+//   rocket_dash <name> --remove           delete a segment left by rocket_sim --keep
+//
+// Dashboards only read the shared ring, so any number can watch at any rate
+// without slowing the simulation. The panel shows the frames it actually saw
+// against those published, so a dashboard that samples slower than the
+// simulation ticks can tell how much it skipped.
+//
+// Exit code: 0 on success, 2 on usage errors or when there is no such simulation.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include "ArduinoInterface.h"
+#include "LiveBridge.h"
+#include "StateNames.h"
+#include "Telemetry.h"
+
+namespace
+{
+   void usage()
+   {
+      fprintf(stderr, "usage: rocket_dash <name> [--hz N | --once | --hold INPUTS | --stop | "
+                      "--remove]\n");
+   }
+
+   bool parseInputs(const char* text, uint8_t& mask)
+   {
+      mask = 0;
+      if (strcmp(text, "none") == 0)
+         return true;
+      std::string list(text);
+      size_t      at = 0;
+      while (at <= list.size())
+      {
+         const size_t      comma = std::min(list.find(',', at), list.size());
+         const std::string name  = list.substr(at, comma - at);
+         if (name == "arm")
+            mask |= INPUT_BIT_ARM;
+         else if (name == "reset")
+            mask |= INPUT_BIT_RESET;
+         else if (name == "launch")
+            mask |= INPUT_BIT_LAUNCH;
+         else
+            return false;
+         at = comma + 1;
+      }
+      return true;
+   }
+
+   void printPanel(const LiveFrame& f, uint64_t published)
+   {
+      static const char* const OUTPUT_NAMES[] = {"READY", "ARMED", "LAMP", "RELAY",
+                                                 "AUX0",  "AUX1",  "AUX2", "AUX3"};
+      printf("t=%u ms  frame %llu of %llu  state %s%s%s\n", f.ms, (unsigned long long)f.frame,
+             (unsigned long long)published, stateName((State)f.state),
+             (f.flags & TELEMETRY_FLAG_RANGE) ? "  [range]" : "",
+             (f.flags & TELEMETRY_FLAG_STATIC) ? "  [static fire]" : "");
+      printf("+----------------+\n|%.16s|\n|%.16s|\n+----------------+\n", f.lcd[0], f.lcd[1]);
+      printf("in:%s%s%s  out:", (f.inputs & INPUT_BIT_ARM) ? " ARM" : "",
+             (f.inputs & INPUT_BIT_RESET) ? " RESET" : "",
+             (f.inputs & INPUT_BIT_LAUNCH) ? " LAUNCH" : "");
+      for (uint8_t i = 0; i < 8; i++)
+      {
+         if (f.outputs & (1u << i))
+            printf(" %s", OUTPUT_NAMES[i]);
+      }
+      if (f.toneFreq)
+         printf("  tone %u Hz", f.toneFreq);
+      if (f.violation)
+         printf("  monitor violation %u", f.violation);
+      printf("\n");
+   }
+
+   int watch(const LiveReader& live, double hz)
+   {
+      const bool tty  = isatty(STDOUT_FILENO);
+      const auto step = std::chrono::microseconds((int64_t)(1e6 / hz));
+      auto       due  = std::chrono::steady_clock::now();
+      uint64_t   seen = 0;
+      uint64_t   last = 0;
+      LiveFrame  f;
+      for (;;)
+      {
+         const bool done = live.finished();
+         if (live.latest(f) && f.frame != last)
+         {
+            seen++;
+            last = f.frame;
+            if (tty)
+               printf("\033[H\033[2J");
+            printPanel(f, live.published());
+            printf("sampled %llu frames at %.0f Hz\n\n", (unsigned long long)seen, hz);
+            fflush(stdout);
+         }
+         if (done)
+            return 0;
+         due += step;
+         std::this_thread::sleep_until(due);
+      }
+   }
+} // namespace
+
+int main(int argc, char** argv)
+{
+   if (argc < 2 || argv[1][0] == '-')
+   {
+      usage();
+      return 2;
+   }
+   const char* name   = argv[1];
+   double      hz     = 10;
+   bool        once   = false;
+   bool        stop   = false;
+   bool        hold   = false;
+   uint8_t     inputs = 0;
+   for (int i = 2; i < argc; i++)
+   {
+      if (strcmp(argv[i], "--hz") == 0 && i + 1 < argc)
+         hz = atof(argv[++i]);
+      else if (strcmp(argv[i], "--once") == 0)
+         once = true;
+      else if (strcmp(argv[i], "--stop") == 0)
+         stop = true;
+      else if (strcmp(argv[i], "--hold") == 0 && i + 1 < argc && parseInputs(argv[i + 1], inputs))
+      {
+         hold = true;
+         i++;
+      }
+      else if (strcmp(argv[i], "--remove") == 0 && argc == 3)
+      {
+         if (LiveReader::remove(name))
+            return 0;
+         fprintf(stderr, "rocket_dash: no simulation named %s\n", name);
+         return 2;
+      }
+      else
+      {
+         usage();
+         return 2;
+      }
+   }
+   if (hz <= 0)
+   {
+      usage();
+      return 2;
+   }
+
+   LiveReader  live;
+   std::string error;
+   if (!live.open(name, error))
+   {
+      fprintf(stderr, "rocket_dash: %s\n", error.c_str());
+      return 2;
+   }
+   if (hold)
+      live.sendInputs(inputs);
+   if (stop)
+      live.requestStop();
+   if (hold || stop)
+      return 0;
+
+   if (once)
+   {
+      LiveFrame f;
+      if (!live.latest(f))
+      {
+         fprintf(stderr, "rocket_dash: %s has not published a frame yet\n", name);
+         return 2;
+      }
+      printPanel(f, live.published());
+      if (live.finished())
+         printf("run finished (pid %d)\n", live.producerPid());
+      return 0;
+   }
+   return watch(live, hz);
+}
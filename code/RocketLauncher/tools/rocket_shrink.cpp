@@ -0,0 +1,567 @@
+// rocket_shrink - minimise an input trace that drives RocketController into a bad state
+//
+//   rocket_shrink [options] <trace.scn>
+//   rocket_shrink [options] --random N [--seed S]
+//
+// The trace is a scenario file. Its directives and input edges are kept;
+// expectations are dropped because shrinking moves the times they are pinned to.
+// Other timed commands (stuck, glitch, load) are pinned: replayed at their own
+// time in every candidate and never removed or moved.
+// The failure is any 'never' line in the trace or given with --state/--violation.
+//
+// Shrinking removes events (ddmin), merges chatter and simultaneous edges and
+// shortens gaps, re-running every round of candidates in virtual time on all
+// cores, until no single step still reproduces the failure. The result is a
+// scenario whose 'never' line fails until the bug is fixed, ready to go in
+// scenarios/ together with the fix.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Scenario.h"
+
+namespace
+{
+   constexpr uint32_t DEFAULT_TAIL_MS = 20000; // longer than any controller timeout
+
+   struct Event
+   {
+      uint32_t time;
+      uint8_t  bit;
+      bool     level;
+   };
+
+   using Events = std::vector<Event>;
+
+   // A timed command the shrinker leaves alone, e.g. a fault injection
+   struct Pinned
+   {
+      uint32_t    time;
+      std::string command;
+      uint32_t    lineNo; // in the source trace, for errors
+   };
+
+   using Pins = std::vector<Pinned>;
+
+   struct Trace
+   {
+      std::vector<std::string> header; // directives, including 'never' lines
+      Events                   events;
+      Pins                     pinned;
+      uint32_t                 endTime  = 0; // last timestamp of any line
+      uint32_t                 expected = 0; // expectation lines dropped
+   };
+
+   const char* inputName(uint8_t bit)
+   {
+      return bit == INPUT_BIT_ARM ? "arm" : bit == INPUT_BIT_RESET ? "reset" : "launch";
+   }
+
+   bool loadTrace(const std::string& path, Trace& trace)
+   {
+      std::ifstream in(path);
+      if (!in)
+      {
+         fprintf(stderr, "rocket_shrink: cannot open %s\n", path.c_str());
+         return false;
+      }
+
+      std::string line;
+      uint32_t    lineNo = 0;
+      uint32_t    last   = 0;
+      while (std::getline(in, line))
+      {
+         lineNo++;
+         const std::vector<std::string> tok = tokenizeScenarioLine(line);
+         if (tok.empty())
+            continue;
+         if (tok[0] == "start" || tok[0] == "tick" || tok[0] == "mode" || tok[0] == "never" ||
+             tok[0] == "aux" || tok[0] == "pulse" || tok[0] == "raw")
+         {
+            std::string directive;
+            for (const std::string& t : tok)
+               directive += (directive.empty() ? "" : " ") + t;
+            trace.header.push_back(directive);
+            continue;
+         }
+
+         uint32_t   t        = 0;
+         const bool relative = tok[0][0] == '+';
+         if (!parseScenarioUint(relative ? tok[0].substr(1) : tok[0], t) || tok.size() < 2)
+         {
+            fprintf(stderr, "%s:%u: expected '<time> <command>'\n", path.c_str(), lineNo);
+            return false;
+         }
+         last          = relative ? last + t : t;
+         trace.endTime = std::max(trace.endTime, last);
+
+         bool level = false;
+         if (const uint8_t bit = scenarioInputBit(tok[1]))
+         {
+            if (tok.size() != 3 || (tok[2] != "on" && tok[2] != "off"))
+            {
+               fprintf(stderr, "%s:%u: usage: %s on|off\n", path.c_str(), lineNo, tok[1].c_str());
+               return false;
+            }
+            level = tok[2] == "on";
+            trace.events.push_back({last, bit, level});
+         }
+         else if (tok[1] == "expect")
+         {
+            trace.expected++;
+         }
+         else if (tok[1] != "run")
+         {
+            std::string command;
+            for (size_t i = 1; i < tok.size(); i++)
+               command += (command.empty() ? "" : " ") + tok[i];
+            trace.pinned.push_back({last, command, lineNo});
+         }
+      }
+      return true;
+   }
+
+   // Random edges with short gaps, the kind of trace a fuzzer or a flaky harness produces
+   Trace randomTrace(uint32_t count, uint32_t seed)
+   {
+      static const uint8_t BITS[] = {INPUT_BIT_ARM, INPUT_BIT_RESET, INPUT_BIT_LAUNCH};
+      std::mt19937         rng(seed);
+      Trace                trace;
+      trace.header.push_back("start READY");
+
+      uint8_t  inputs = 0;
+      uint32_t t      = 0;
+      for (uint32_t i = 0; i < count; i++)
+      {
+         t += 1 + rng() % 400;
+         const uint8_t bit = BITS[rng() % 3];
+         inputs ^= bit;
+         trace.events.push_back({t, bit, (inputs & bit) != 0});
+      }
+      trace.endTime = t;
+      return trace;
+   }
+
+   // Sort by time and drop edges that do not change the input level
+   Events canonical(Events events)
+   {
+      std::stable_sort(events.begin(), events.end(),
+                       [](const Event& a, const Event& b) { return a.time < b.time; });
+      Events  out;
+      uint8_t inputs = 0;
+      for (const Event& e : events)
+      {
+         if (((inputs & e.bit) != 0) == e.level)
+            continue;
+         inputs ^= e.bit;
+         out.push_back(e);
+      }
+      return out;
+   }
+
+   // Runs candidate traces and reports which ones still fail
+   class Evaluator
+   {
+    public:
+      Evaluator(const std::vector<std::string>& header, const Pins& pinned, uint32_t tailMs,
+                unsigned jobs)
+          : header(header), pinned(pinned), tailMs(tailMs), jobs(jobs)
+      {
+      }
+
+      // Returns the time of the first failure, or UINT32_MAX if the candidate passes
+      uint32_t run(const Events& events)
+      {
+         runs++;
+         ScenarioRunner runner("candidate");
+         uint32_t       lineNo = 0;
+         for (const std::string& line : header)
+            runner.executeLine(line, ++lineNo);
+
+         // Pinned commands go first at a shared time, as they are written out
+         size_t pin = 0;
+         for (const Event& e : events)
+         {
+            for (; pin < pinned.size() && pinned[pin].time <= e.time && !runner.failed(); pin++)
+               runPinned(runner, pinned[pin]);
+            runner.advanceTo(e.time);
+            if (runner.failed())
+               break;
+            SimArduinoInterface& sim = runner.sim();
+            sim.setInputs(e.level ? (sim.getInputs() | e.bit) : (sim.getInputs() & ~e.bit));
+         }
+         for (; pin < pinned.size() && !runner.failed(); pin++)
+            runPinned(runner, pinned[pin]);
+         if (!runner.failed())
+            runner.advanceTo(std::max((events.empty() ? 0 : events.back().time) + tailMs,
+                                      runner.now()));
+
+         const ScenarioResult r = runner.finish();
+         return r.passed ? UINT32_MAX : r.failTime;
+      }
+
+      // Index of the first candidate that still fails, or -1
+      int firstFailing(const std::vector<Events>& candidates)
+      {
+         std::atomic<size_t> next{0};
+         std::atomic<size_t> best{SIZE_MAX};
+         auto                worker = [&]() {
+            for (size_t i = next++; i < candidates.size(); i = next++)
+            {
+               if (i > best.load())
+                  continue; // an earlier candidate already fails
+               if (run(candidates[i]) == UINT32_MAX)
+                  continue;
+               size_t seen = best.load();
+               while (i < seen && !best.compare_exchange_weak(seen, i))
+               {
+               }
+            }
+         };
+
+         std::vector<std::thread> pool;
+         const size_t             threads = std::min<size_t>(jobs, candidates.size());
+         for (size_t i = 1; i < threads; i++)
+            pool.emplace_back(worker);
+         worker();
+         for (auto& t : pool)
+            t.join();
+         return best == SIZE_MAX ? -1 : (int)best;
+      }
+
+      uint64_t runCount() const
+      {
+         return runs;
+      }
+
+      static bool runPinned(ScenarioRunner& runner, const Pinned& p)
+      {
+         return runner.executeLine(std::to_string(p.time) + " " + p.command, p.lineNo);
+      }
+
+    private:
+      const std::vector<std::string>& header;
+      const Pins&                     pinned;
+      const uint32_t                  tailMs;
+      const unsigned                  jobs;
+      std::atomic<uint64_t>           runs{0};
+   };
+
+   class Shrinker
+   {
+    public:
+      Shrinker(Evaluator& eval, Events events) : eval(eval), events(std::move(events))
+      {
+      }
+
+      // Returns false if the trace does not fail in the first place
+      bool minimise()
+      {
+         if (!accept(canonical(events)))
+            return false;
+
+         bool changed = true;
+         while (changed)
+         {
+            changed = removeChunks();
+            changed |= mergeEdges();
+            changed |= shortenGaps();
+         }
+         return true;
+      }
+
+      const Events& result() const
+      {
+         return events;
+      }
+
+      uint32_t failTime() const
+      {
+         return failAt;
+      }
+
+    private:
+      Evaluator& eval;
+      Events     events;
+      uint32_t   failAt = 0;
+
+      // Adopt a candidate if it fails, dropping edges the failure never saw
+      bool accept(Events candidate)
+      {
+         const uint32_t t = eval.run(candidate);
+         if (t == UINT32_MAX)
+            return false;
+         candidate.erase(std::remove_if(candidate.begin(), candidate.end(),
+                                        [t](const Event& e) { return e.time >= t; }),
+                         candidate.end());
+         events = canonical(candidate);
+         failAt = t;
+         return true;
+      }
+
+      bool tryCandidates(const std::vector<Events>& candidates)
+      {
+         const int i = eval.firstFailing(candidates);
+         return i >= 0 && accept(candidates[i]);
+      }
+
+      // ddmin over complements: drop ever smaller slices of the trace
+      bool removeChunks()
+      {
+         bool   changed = false;
+         size_t n       = 2;
+         while (!events.empty())
+         {
+            const size_t        chunk = (events.size() + n - 1) / n;
+            std::vector<Events> candidates;
+            for (size_t start = 0; start < events.size(); start += chunk)
+            {
+               Events c(events.begin(), events.begin() + start);
+               c.insert(c.end(), events.begin() + std::min(events.size(), start + chunk),
+                        events.end());
+               candidates.push_back(std::move(c));
+            }
+            if (tryCandidates(candidates))
+            {
+               changed = true;
+               n       = std::max<size_t>(n - 1, 2);
+               continue;
+            }
+            if (chunk == 1)
+               break;
+            n = std::min(events.size(), n * 2);
+         }
+         return changed;
+      }
+
+      // Collapse press/release pairs of one input and pull edges onto their predecessor
+      bool mergeEdges()
+      {
+         bool changed = false;
+         for (;;)
+         {
+            std::vector<Events> candidates;
+            for (size_t i = 0; i < events.size(); i++)
+            {
+               for (size_t j = i + 1; j < events.size(); j++)
+               {
+                  if (events[j].bit != events[i].bit)
+                     continue;
+                  Events c = events;
+                  c.erase(c.begin() + j);
+                  c.erase(c.begin() + i);
+                  candidates.push_back(std::move(c));
+                  break;
+               }
+            }
+            for (size_t i = 1; i < events.size(); i++)
+            {
+               if (events[i].time == events[i - 1].time)
+                  continue;
+               Events c  = events;
+               c[i].time = c[i - 1].time;
+               candidates.push_back(std::move(c));
+            }
+            if (!tryCandidates(candidates))
+               return changed;
+            changed = true;
+         }
+      }
+
+      // Pull events (and everything after them) earlier: whole gap first, then halves
+      bool shortenGaps()
+      {
+         bool changed = false;
+         for (;;)
+         {
+            std::vector<Events> whole;
+            std::vector<Events> halves;
+            for (size_t i = 0; i < events.size(); i++)
+            {
+               const uint32_t gap = events[i].time - (i ? events[i - 1].time : 0);
+               if (gap == 0)
+                  continue;
+               whole.push_back(shifted(i, gap));
+               if (gap > 1)
+                  halves.push_back(shifted(i, gap / 2));
+            }
+            whole.insert(whole.end(), halves.begin(), halves.end());
+            if (!tryCandidates(whole))
+               return changed;
+            changed = true;
+         }
+      }
+
+      Events shifted(size_t from, uint32_t by) const
+      {
+         Events c = events;
+         for (size_t i = from; i < c.size(); i++)
+            c[i].time -= by;
+         return c;
+      }
+   };
+
+   void writeScenario(FILE* out, const std::string& source, const Trace& trace, const Events& events,
+                      uint32_t failTime)
+   {
+      fprintf(out, "# Regression: minimised by rocket_shrink from %s (%zu -> %zu input events)\n",
+              source.c_str(), trace.events.size(), events.size());
+      fprintf(out, "# Fails while the bug is present; the 'never' line is the property it broke.\n");
+      for (const std::string& line : trace.header)
+         fprintf(out, "%s\n", line.c_str());
+      fprintf(out, "\n");
+      size_t pin = 0;
+      for (const Event& e : events)
+      {
+         for (; pin < trace.pinned.size() && trace.pinned[pin].time <= e.time; pin++)
+            fprintf(out, "%-6u %s\n", trace.pinned[pin].time, trace.pinned[pin].command.c_str());
+         fprintf(out, "%-6u %s %s\n", e.time, inputName(e.bit), e.level ? "on" : "off");
+      }
+      for (; pin < trace.pinned.size() && trace.pinned[pin].time <= failTime; pin++)
+         fprintf(out, "%-6u %s\n", trace.pinned[pin].time, trace.pinned[pin].command.c_str());
+      fprintf(out, "%-6u run\n", failTime);
+   }
+
+   void usage()
+   {
+      fprintf(stderr,
+              "usage: rocket_shrink [-j N] [-o out.scn] [--state STATE] [--violation] [--tail MS]\n"
+              "                     <trace.scn | --random N [--seed S]>\n");
+   }
+} // namespace
+
+int main(int argc, char** argv)
+{
+   unsigned    jobs       = std::max(1u, std::thread::hardware_concurrency());
+   std::string output;
+   std::string source;
+   uint32_t    tailMs     = 0;
+   uint32_t    randomN    = 0;
+   uint32_t    seed       = 1;
+   bool        tailGiven  = false;
+   std::vector<std::string> never;
+
+   for (int i = 1; i < argc; i++)
+   {
+      const bool hasArg = i + 1 < argc;
+      if (strcmp(argv[i], "-j") == 0 && hasArg)
+         jobs = std::max(1, atoi(argv[++i]));
+      else if (strcmp(argv[i], "-o") == 0 && hasArg)
+         output = argv[++i];
+      else if (strcmp(argv[i], "--state") == 0 && hasArg)
+         never.push_back(std::string("never state ") + argv[++i]);
+      else if (strcmp(argv[i], "--violation") == 0)
+         never.push_back("never violation");
+      else if (strcmp(argv[i], "--tail") == 0 && hasArg)
+         tailGiven = parseScenarioUint(argv[++i], tailMs);
+      else if (strcmp(argv[i], "--random") == 0 && hasArg)
+         parseScenarioUint(argv[++i], randomN);
+      else if (strcmp(argv[i], "--seed") == 0 && hasArg)
+         parseScenarioUint(argv[++i], seed);
+      else if (argv[i][0] == '-' || !source.empty())
+      {
+         usage();
+         return 2;
+      }
+      else
+         source = argv[i];
+   }
+   if (source.empty() == (randomN == 0))
+   {
+      usage();
+      return 2;
+   }
+
+   Trace trace;
+   if (randomN)
+   {
+      trace  = randomTrace(randomN, seed);
+      source = "--random " + std::to_string(randomN) + " --seed " + std::to_string(seed);
+   }
+   else if (!loadTrace(source, trace))
+   {
+      return 2;
+   }
+   trace.header.insert(trace.header.end(), never.begin(), never.end());
+
+   // Header problems would otherwise look like a reproducing failure
+   {
+      ScenarioRunner check("header");
+      bool           hasNever = false;
+      for (size_t i = 0; i < trace.header.size(); i++)
+      {
+         hasNever |= trace.header[i].compare(0, 6, "never ") == 0;
+         if (!check.executeLine(trace.header[i], (uint32_t)i + 1))
+         {
+            fprintf(stderr, "rocket_shrink: %s\n", check.finish().message.c_str());
+            return 2;
+         }
+      }
+      // Pinned commands too, on a run without the 'never' lines so only parse errors stop it
+      ScenarioRunner pins("pinned");
+      for (size_t i = 0; i < trace.header.size(); i++)
+      {
+         if (trace.header[i].compare(0, 6, "never ") != 0)
+            pins.executeLine(trace.header[i], (uint32_t)i + 1);
+      }
+      for (const Pinned& p : trace.pinned)
+      {
+         if (!Evaluator::runPinned(pins, p))
+         {
+            fprintf(stderr, "rocket_shrink: %s: %s\n", source.c_str(),
+                    pins.finish().message.c_str());
+            return 2;
+         }
+      }
+      if (!hasNever)
+      {
+         fprintf(stderr, "rocket_shrink: no failure to look for (use --state, --violation or a "
+                         "'never' line)\n");
+         return 2;
+      }
+   }
+   if (trace.expected)
+      fprintf(stderr, "rocket_shrink: ignoring %u expect lines\n", trace.expected);
+
+   if (!tailGiven)
+   {
+      const uint32_t last = trace.events.empty() ? 0 : trace.events.back().time;
+      tailMs              = std::max(DEFAULT_TAIL_MS, trace.endTime - std::min(trace.endTime, last));
+   }
+
+   const auto t0 = std::chrono::steady_clock::now();
+   Evaluator  eval(trace.header, trace.pinned, tailMs, jobs);
+   Shrinker   shrinker(eval, trace.events);
+   if (!shrinker.minimise())
+   {
+      fprintf(stderr, "rocket_shrink: %s does not fail, nothing to minimise\n", source.c_str());
+      return 1;
+   }
+   const double elapsedMs =
+       std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+   FILE* out = output.empty() ? stdout : fopen(output.c_str(), "w");
+   if (!out)
+   {
+      fprintf(stderr, "rocket_shrink: cannot write %s\n", output.c_str());
+      return 2;
+   }
+   writeScenario(out, source, trace, shrinker.result(), shrinker.failTime());
+   if (out != stdout)
+      fclose(out);
+
+   fprintf(stderr, "%zu -> %zu events, fails at t=%u (%llu runs in %.0f ms on %u threads)\n",
+           trace.events.size(), shrinker.result().size(), shrinker.failTime(),
+           (unsigned long long)eval.runCount(), elapsedMs, jobs);
+   return 0;
+}
@@ -0,0 +1,318 @@
+// rocket_sim - run scenario files against RocketController in virtual time
+//
+//   rocket_sim [-j N] [-v] <scenario.scn | directory>...
+//   rocket_sim --serial out.bin <scenario.scn>
+//   rocket_sim --live NAME [--speed F] [--keep] [scenario.scn]
+//   rocket_sim --traffic <scenario.scn>
+//
+// Directories are searched recursively for *.scn files. Scenarios are spread
+// across all cores; the exit code is non-zero if any scenario fails. --serial
+// runs one scenario with telemetry on and saves what the simulated controller
+// sent on its serial port, a stand-in device capture for rocket_twin and
+// thrust_analyze.
+//
+// --live publishes every tick (state, outputs, LCD, tone) to shared memory for
+// dashboards such as rocket_dash, which can also hold the inputs; see
+// LiveBridge.h. With a scenario it runs flat out unless --speed is given (1 is
+// real time); without one it is an interactive session at real time driven
+// only by dashboard inputs, until a dashboard or Ctrl-C stops it. --keep
+// leaves the last frames readable after the run (rocket_dash --remove).
+//
+// --traffic runs one scenario with the controller's hardware calls going
+// through TrafficCounter and prints, per state, how often each call was made
+// per tick and how many changed nothing (see TrafficCounter.h).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "LiveBridge.h"
+#include "Scenario.h"
+#include "StateNames.h"
+#include "TrafficCounter.h"
+
+namespace fs = std::filesystem;
+
+static void usage()
+{
+   fprintf(stderr, "usage: rocket_sim [-j N] [-v] <scenario.scn | directory>...\n"
+                   "       rocket_sim --serial out.bin <scenario.scn>\n"
+                   "       rocket_sim --live NAME [--speed F] [--keep] [scenario.scn]\n"
+                   "       rocket_sim --traffic <scenario.scn>\n");
+}
+
+static volatile sig_atomic_t interrupted = 0;
+
+static void onSignal(int)
+{
+   interrupted = 1;
+}
+
+// One run published tick by tick; inputs sent by a dashboard replace the simulated ones
+static int runLive(const char* name, const std::string& file, double speed, bool keep)
+{
+   LivePublisher live;
+   std::string   error;
+   if (!live.open(name, error))
+   {
+      fprintf(stderr, "rocket_sim: %s\n", error.c_str());
+      return 2;
+   }
+   signal(SIGINT, onSignal);
+   signal(SIGTERM, onSignal);
+
+   std::ifstream in;
+   if (!file.empty())
+   {
+      in.open(file);
+      if (!in)
+      {
+         fprintf(stderr, "rocket_sim: cannot open %s\n", file.c_str());
+         return 2;
+      }
+   }
+
+   ScenarioRunner       runner(file.empty() ? std::string("live") : file);
+   SimArduinoInterface& hal = runner.sim();
+   const auto           t0  = std::chrono::steady_clock::now();
+   uint64_t             published = 0;
+   runner.setTickHook(
+       [&]()
+       {
+          // Once stopped, the rest of a scenario runs out unpublished and unpaced
+          if (interrupted || live.stopRequested())
+             return;
+          RocketController&     rc  = runner.controller();
+          const uint32_t        now = runner.now();
+          const TelemetrySample s   = rc.telemetrySnapshot(now);
+          LiveFrame             f   = {};
+          f.ms                      = now;
+          f.toneFreq                = hal.getToneFreq();
+          f.state                   = s.state;
+          f.inputs                  = s.inputs;
+          f.outputs                 = s.outputs;
+          f.flags                   = s.flags;
+          f.violation               = (uint8_t)rc.getLastViolation();
+          for (uint8_t row = 0; row < 2; row++)
+          {
+             const char* text = hal.getLcdLine(row);
+             memset(f.lcd[row], ' ', LIVE_LCD_COLS);
+             memcpy(f.lcd[row], text, strnlen(text, LIVE_LCD_COLS));
+          }
+          live.publish(f);
+          published++;
+
+          uint8_t mask;
+          if (live.takeInputs(mask))
+             hal.setInputs(mask);
+          if (speed > 0 && now % 10 == 0)
+             std::this_thread::sleep_until(
+                 t0 + std::chrono::microseconds((int64_t)(now * 1000.0 / speed)));
+       });
+
+   bool passed = true;
+   if (file.empty())
+   {
+      runner.controller();
+      while (!interrupted && !live.stopRequested())
+         runner.advanceTo(runner.now() + 1);
+   }
+   else
+   {
+      std::string line;
+      uint32_t    lineNo = 0;
+      while (std::getline(in, line) && runner.executeLine(line, ++lineNo))
+      {
+      }
+      const ScenarioResult r = runner.finish();
+      passed                 = r.passed;
+      if (!r.passed)
+         printf("FAIL %s: %s\n", r.name.c_str(), r.message.c_str());
+   }
+   live.finish(keep);
+
+   const double elapsedMs =
+       std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+   printf("%llu frames published to %s (%.1f s simulated in %.0f ms)\n",
+          (unsigned long long)published, name, runner.now() / 1000.0, elapsedMs);
+   return passed ? 0 : 1;
+}
+
+static void printLine(const char* line)
+{
+   printf("%s\n", line);
+}
+
+// One run with every controller call counted; calls before the first tick count as STARTUP
+static int runTraffic(const std::string& file)
+{
+   std::ifstream in(file);
+   if (!in)
+   {
+      fprintf(stderr, "rocket_sim: cannot open %s\n", file.c_str());
+      return 2;
+   }
+   ScenarioRunner runner(file);
+   TrafficCounter traffic(&runner.sim());
+   runner.setInterface(&traffic);
+   runner.setTickHook([&]() { traffic.beginTick(runner.controller().getState()); });
+
+   std::string line;
+   uint32_t    lineNo = 0;
+   while (std::getline(in, line) && runner.executeLine(line, ++lineNo))
+   {
+   }
+   const ScenarioResult r = runner.finish();
+   traffic.report(printLine, STATE_NAMES);
+   if (!r.passed)
+      printf("FAIL %s: %s\n", r.name.c_str(), r.message.c_str());
+   return r.passed ? 0 : 1;
+}
+
+static bool collect(const std::string& arg, std::vector<std::string>& files)
+{
+   std::error_code ec;
+   if (fs::is_directory(arg, ec))
+   {
+      std::vector<std::string> found;
+      for (const auto& entry : fs::recursive_directory_iterator(arg, ec))
+      {
+         if (entry.is_regular_file() && entry.path().extension() == ".scn")
+            found.push_back(entry.path().string());
+      }
+      std::sort(found.begin(), found.end());
+      files.insert(files.end(), found.begin(), found.end());
+      return true;
+   }
+   if (fs::is_regular_file(arg, ec))
+   {
+      files.push_back(arg);
+      return true;
+   }
+   fprintf(stderr, "rocket_sim: no such file or directory: %s\n", arg.c_str());
+   return false;
+}
+
+int main(int argc, char** argv)
+{
+   unsigned                 jobs    = std::max(1u, std::thread::hardware_concurrency());
+   bool                     verbose = false;
+   const char*              serial  = nullptr;
+   const char*              live    = nullptr;
+   bool                     traffic = false;
+   double                   speed   = -1; // unset
+   bool                     keep    = false;
+   std::vector<std::string> files;
+
+   for (int i = 1; i < argc; i++)
+   {
+      if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+         jobs = std::max(1, atoi(argv[++i]));
+      else if (strcmp(argv[i], "-v") == 0)
+         verbose = true;
+      else if (strcmp(argv[i], "--serial") == 0 && i + 1 < argc)
+         serial = argv[++i];
+      else if (strcmp(argv[i], "--live") == 0 && i + 1 < argc)
+         live = argv[++i];
+      else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc)
+         speed = atof(argv[++i]);
+      else if (strcmp(argv[i], "--keep") == 0)
+         keep = true;
+      else if (strcmp(argv[i], "--traffic") == 0)
+         traffic = true;
+      else if (argv[i][0] == '-')
+      {
+         usage();
+         return 2;
+      }
+      else if (!collect(argv[i], files))
+         return 2;
+   }
+   if (live)
+   {
+      if (files.size() > 1 || serial || traffic)
+      {
+         usage();
+         return 2;
+      }
+      if (speed < 0)
+         speed = files.empty() ? 1.0 : 0.0;
+      return runLive(live, files.empty() ? std::string() : files[0], speed, keep);
+   }
+   if (files.empty() || ((serial || traffic) && files.size() != 1) || (serial && traffic))
+   {
+      usage();
+      return 2;
+   }
+   if (traffic)
+      return runTraffic(files[0]);
+
+   if (serial)
+   {
+      std::vector<uint8_t> bytes;
+      const ScenarioResult r   = ScenarioRunner::runFile(files[0], &bytes);
+      FILE*                out = fopen(serial, "wb");
+      if (!out || fwrite(bytes.data(), 1, bytes.size(), out) != bytes.size())
+      {
+         fprintf(stderr, "rocket_sim: cannot write %s\n", serial);
+         return 2;
+      }
+      fclose(out);
+      if (!r.passed)
+         printf("FAIL %s: %s\n", r.name.c_str(), r.message.c_str());
+      printf("%zu serial bytes from %s (%u ms)\n", bytes.size(), r.name.c_str(), r.endTime);
+      return r.passed ? 0 : 1;
+   }
+
+   const auto                  t0 = std::chrono::steady_clock::now();
+   std::vector<ScenarioResult> results(files.size());
+   std::atomic<size_t>         next(0);
+
+   auto                        worker = [&]()
+   {
+      for (size_t i = next++; i < files.size(); i = next++)
+         results[i] = ScenarioRunner::runFile(files[i]);
+   };
+
+   std::vector<std::thread> pool;
+   for (unsigned j = 1; j < std::min<size_t>(jobs, files.size()); j++)
+      pool.emplace_back(worker);
+   worker();
+   for (auto& t : pool)
+      t.join();
+
+   const double elapsedMs =
+       std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+   size_t   failed = 0;
+   uint64_t simMs  = 0;
+   for (const ScenarioResult& r : results)
+   {
+      simMs += r.endTime;
+      if (!r.passed)
+      {
+         failed++;
+         printf("FAIL %s: %s\n", r.name.c_str(), r.message.c_str());
+      }
+      else if (verbose)
+      {
+         printf("ok   %s (%u checks, %u ms", r.name.c_str(), r.checks, r.endTime);
+         if (r.launches)
+            printf(", %u launches, %u ms/cycle", (unsigned)r.launches, r.cycleMs / r.launches);
+         printf(")\n");
+      }
+   }
+
+   printf("%zu scenarios, %zu passed, %zu failed (%.1f s simulated in %.0f ms on %u threads)\n",
+          results.size(), results.size() - failed, failed, simMs / 1000.0, elapsedMs,
+          (unsigned)std::min<size_t>(jobs, files.size()));
+   return failed == 0 ? 0 : 1;
+}
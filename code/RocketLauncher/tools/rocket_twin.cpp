@@ -0,0 +1,309 @@
+// rocket_twin - check a launcher against RocketController run in lockstep on the host
+//
+//   rocket_twin [options] <capture | /dev/ttyACM0 | ->
+//   rocket_twin [options] --pty
+//
+//   --tolerance MS       how long device and twin may disagree (default 10)
+//   --aux PIN:OFF:PULSE  aux channel as configured on the device (repeatable;
+//                        default 10:-500:200 and 11:0:100 like the firmware)
+//   --no-aux             do not compare the aux outputs
+//   --pulse MS           relay pulse as configured on the device (ROCKET_RELAY_MS)
+//   --max-drift PPM      flag a device clock this far off the host's (live input only)
+//   --expect KIND        exit 0 only if the first divergence is KIND (for tests)
+//
+// The input is the device's serial stream with telemetry on (ROCKET_TELEMETRY=1):
+// a capture file, a serial port (set raw at 115200 baud) or, with --pty, a new
+// pseudo-terminal whose name is printed for a replayer or simulator to write to.
+// A reader thread timestamps the bytes and hands them to the verifier through a
+// lock-free ring, so a slow terminal never stalls the serial port.
+//
+// Exit code: 0 when the device matched its twin, 1 on a divergence, 2 on usage
+// or I/O errors.
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <string>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include "SerialFrame.h"
+#include "SpscRing.h"
+#include "TwinVerifier.h"
+
+namespace
+{
+   // Bytes as they came off the port, stamped on arrival
+   struct Chunk
+   {
+      double   hostMs;
+      uint16_t len;
+      uint8_t  data[1024];
+   };
+
+   using Clock = std::chrono::steady_clock;
+
+   std::atomic<bool> stopRequested(false);
+   const Clock::time_point epoch = Clock::now();
+
+   double hostNowMs()
+   {
+      return std::chrono::duration<double, std::milli>(Clock::now() - epoch).count();
+   }
+
+   void onSignal(int)
+   {
+      stopRequested = true;
+   }
+
+   void usage()
+   {
+      fprintf(stderr, "usage: rocket_twin [--tolerance MS] [--aux PIN:OFF:PULSE]... [--no-aux]\n"
+                      "                   [--pulse MS] [--max-drift PPM] [--expect KIND]\n"
+                      "                   <capture | tty | - | --pty>\n");
+   }
+
+   bool parseAux(const char* text, AuxScheduler::Channel& out)
+   {
+      int pin = 0, offset = 0, pulse = 0;
+      if (sscanf(text, "%d:%d:%d", &pin, &offset, &pulse) != 3 || pin < 0 ||
+          pin >= SimArduinoInterface::PIN_COUNT || offset < INT16_MIN || offset > INT16_MAX ||
+          pulse <= 0 || pulse > UINT16_MAX)
+         return false;
+      out = {(uint8_t)pin, (int16_t)offset, (uint16_t)pulse};
+      return true;
+   }
+
+   // Raw 8N1 at the firmware's baud rate
+   bool makeRaw(int fd, bool setBaud)
+   {
+      termios tio;
+      if (tcgetattr(fd, &tio) != 0)
+         return false;
+      cfmakeraw(&tio);
+      if (setBaud)
+      {
+         cfsetispeed(&tio, B115200);
+         cfsetospeed(&tio, B115200);
+      }
+      return tcsetattr(fd, TCSANOW, &tio) == 0;
+   }
+
+   int openPty(int& slaveKeep)
+   {
+      const int master = posix_openpt(O_RDWR | O_NOCTTY);
+      if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+         return -1;
+      const char* name = ptsname(master);
+      // Holding the slave open keeps reads alive while writers come and go
+      slaveKeep = name ? open(name, O_RDWR | O_NOCTTY) : -1;
+      if (slaveKeep < 0 || !makeRaw(slaveKeep, false))
+         return -1;
+      fprintf(stderr, "rocket_twin: write telemetry to %s\n", name);
+      return master;
+   }
+} // namespace
+
+int main(int argc, char** argv)
+{
+   TwinVerifier::Options options;
+   bool                  defaultAux = true;
+   bool                  pty        = false;
+   bool                  expectSet  = false;
+   Divergence::Kind      expected   = Divergence::STUCK_RELAY;
+   const char*           inputPath  = nullptr;
+
+   for (int i = 1; i < argc; i++)
+   {
+      const bool more = i + 1 < argc;
+      if (strcmp(argv[i], "--tolerance") == 0 && more)
+         options.toleranceMs = (uint32_t)atoi(argv[++i]);
+      else if (strcmp(argv[i], "--aux") == 0 && more)
+      {
+         AuxScheduler::Channel c;
+         if (!parseAux(argv[++i], c) || options.auxChannels.size() >= AuxScheduler::MAX_CHANNELS)
+         {
+            usage();
+            return 2;
+         }
+         options.auxChannels.push_back(c);
+         defaultAux = false;
+      }
+      else if (strcmp(argv[i], "--no-aux") == 0)
+         options.checkAux = false;
+      else if (strcmp(argv[i], "--pulse") == 0 && more)
+      {
+         const int ms = atoi(argv[++i]);
+         if (ms < (int)RocketController::MIN_RELAY_PULSE_MS ||
+             ms > (int)RocketController::RELAY_ON_MS)
+         {
+            usage();
+            return 2;
+         }
+         options.relayPulseMs = (uint16_t)ms;
+      }
+      else if (strcmp(argv[i], "--max-drift") == 0 && more)
+         options.maxDriftPpm = atof(argv[++i]);
+      else if (strcmp(argv[i], "--expect") == 0 && more)
+      {
+         if (!parseDivergenceName(argv[++i], expected))
+         {
+            fprintf(stderr, "rocket_twin: unknown divergence '%s'\n", argv[i]);
+            return 2;
+         }
+         expectSet = true;
+      }
+      else if (strcmp(argv[i], "--pty") == 0)
+         pty = true;
+      else if (argv[i][0] == '-' && argv[i][1] != '\0')
+      {
+         usage();
+         return 2;
+      }
+      else if (!inputPath)
+         inputPath = argv[i];
+      else
+      {
+         usage();
+         return 2;
+      }
+   }
+   if (pty == (inputPath != nullptr))
+   {
+      usage();
+      return 2;
+   }
+   if (defaultAux)
+      options.auxChannels = {{10, -500, 200}, {11, 0, 100}}; // as in main.cpp
+
+   // Open the source; only live ones have arrival times worth comparing clocks with
+   int fd        = -1;
+   int slaveKeep = -1;
+   if (pty)
+      fd = openPty(slaveKeep);
+   else if (strcmp(inputPath, "-") == 0)
+      fd = STDIN_FILENO;
+   else
+      fd = open(inputPath, O_RDONLY | O_NOCTTY);
+   if (fd < 0)
+   {
+      fprintf(stderr, "rocket_twin: cannot open %s\n", pty ? "a pseudo-terminal" : inputPath);
+      return 2;
+   }
+   const bool live = pty || isatty(fd);
+   if (live && !pty && !makeRaw(fd, true))
+   {
+      fprintf(stderr, "rocket_twin: cannot configure %s\n", inputPath);
+      return 2;
+   }
+   signal(SIGINT, onSignal);
+   signal(SIGTERM, onSignal);
+
+   // Reader: never blocks on the verifier when live (a full ring drops and says so);
+   // a file waits instead, since nothing is lost by pausing it
+   static SpscRing<Chunk, 256> ring;
+   std::atomic<bool>           readerDone(false);
+   std::atomic<uint64_t>       overruns(0);
+   std::thread                 reader([&]() {
+      Chunk   chunk;
+      pollfd  pfd = {fd, POLLIN, 0};
+      while (!stopRequested)
+      {
+         if (live && poll(&pfd, 1, 100) <= 0)
+            continue;
+         const ssize_t n = read(fd, chunk.data, sizeof(chunk.data));
+         if (n <= 0)
+            break;
+         chunk.hostMs = hostNowMs();
+         chunk.len    = (uint16_t)n;
+         while (!ring.push(chunk))
+         {
+            if (live)
+            {
+               overruns++;
+               break;
+            }
+            std::this_thread::yield();
+         }
+      }
+      readerDone = true;
+   });
+
+   // Verifier
+   TwinVerifier verifier(options);
+   FrameDecoder decoder;
+   Chunk        chunk;
+   size_t       reported   = 0;
+   double       maxLatency = 0;
+   double       sumLatency = 0;
+   uint64_t     chunks     = 0;
+   const double started    = hostNowMs();
+   for (;;)
+   {
+      if (!ring.pop(chunk))
+      {
+         if (readerDone)
+         {
+            if (!ring.pop(chunk))
+               break;
+         }
+         else
+         {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            continue;
+         }
+      }
+
+      for (uint16_t i = 0; i < chunk.len; i++)
+      {
+         TelemetrySample sample;
+         if (!decoder.feed(chunk.data[i]) || decoder.type() != FRAME_TELEMETRY ||
+             !decodeTelemetry(decoder.payload(), decoder.length(), sample))
+            continue;
+         verifier.onSample(sample, live ? chunk.hostMs : -1);
+      }
+
+      const std::vector<Divergence>& found = verifier.getDivergences();
+      for (; reported < found.size(); reported++)
+      {
+         const Divergence& d = found[reported];
+         printf("t=%u %s: %s (disagreeing since t=%u)\n", d.deviceMs, divergenceName(d.kind),
+                d.detail.c_str(), d.sinceMs);
+         fflush(stdout);
+      }
+
+      // Arrival to verdict, the delay a live operator sees
+      const double latency = hostNowMs() - chunk.hostMs;
+      maxLatency           = std::max(maxLatency, latency);
+      sumLatency += latency;
+      chunks++;
+   }
+   stopRequested = true;
+   reader.join();
+   if (fd != STDIN_FILENO)
+      close(fd);
+   if (slaveKeep >= 0)
+      close(slaveKeep);
+
+   const double elapsed = hostNowMs() - started;
+   printf("%llu samples, %.1f s of device time replayed in %.0f ms, %zu divergences\n",
+          (unsigned long long)verifier.getSamples(), verifier.getTwinTicks() / 1000.0, elapsed,
+          verifier.getDivergences().size());
+   printf("resyncs %u, lost samples %u, max lag %u ms", verifier.getResyncs(),
+          verifier.getLostSamples(), verifier.getMaxLagMs());
+   if (live)
+      printf(", clock drift %+.0f ppm", verifier.getDriftPpm());
+   if (overruns)
+      printf(", %llu chunks dropped", (unsigned long long)overruns.load());
+   printf("\nlatency mean %.3f ms, max %.3f ms\n", chunks ? sumLatency / chunks : 0.0, maxLatency);
+
+   const std::vector<Divergence>& found = verifier.getDivergences();
+   if (expectSet)
+      return !found.empty() && found[0].kind == expected ? 0 : 1;
+   return found.empty() ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+// thrust_analyze - total impulse, peak and burn time from a static-fire capture
+//
+//   thrust_analyze [options] <capture.bin | log.csv | ->
+//
+//   --scale N     newtons per load-cell count (default 1)
+//   --offset N    zero reading in counts (default: tare on the first 50 ms)
+//   --no-tare     take the log's zero as is
+//   --rate HZ     sample rate for single-column CSV files
+//   --smooth N    triangular smoothing half-width in samples (default 0)
+//   --curve FILE  write the (smoothed) curve as time_s,newtons CSV
+//
+// Input is either the raw serial dump of a static-fire run (S/D/E frames, other
+// serial text is skipped) or CSV with "time_s,thrust" or one thrust value per line.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "ThrustAnalysis.h"
+
+static void usage()
+{
+   fprintf(stderr, "usage: thrust_analyze [--scale N] [--offset N] [--no-tare] [--rate HZ]\n"
+                   "                      [--smooth N] [--curve out.csv] <capture | log.csv | ->\n");
+}
+
+int main(int argc, char** argv)
+{
+   ThrustCalibration cal;
+   bool              tare      = true;
+   bool              offsetSet = false;
+   double            csvRate   = 0;
+   unsigned          smooth    = 0;
+   const char*       curvePath = nullptr;
+   const char*       inputPath = nullptr;
+
+   for (int i = 1; i < argc; i++)
+   {
+      const bool more = i + 1 < argc;
+      if (strcmp(argv[i], "--scale") == 0 && more)
+         cal.newtonsPerCount = atof(argv[++i]);
+      else if (strcmp(argv[i], "--offset") == 0 && more)
+      {
+         cal.offsetCounts = atof(argv[++i]);
+         offsetSet        = true;
+      }
+      else if (strcmp(argv[i], "--no-tare") == 0)
+         tare = false;
+      else if (strcmp(argv[i], "--rate") == 0 && more)
+         csvRate = atof(argv[++i]);
+      else if (strcmp(argv[i], "--smooth") == 0 && more)
+         smooth = (unsigned)atoi(argv[++i]);
+      else if (strcmp(argv[i], "--curve") == 0 && more)
+         curvePath = argv[++i];
+      else if (argv[i][0] == '-' && argv[i][1] != '\0')
+      {
+         usage();
+         return 2;
+      }
+      else if (!inputPath)
+         inputPath = argv[i];
+      else
+      {
+         usage();
+         return 2;
+      }
+   }
+   if (!inputPath)
+   {
+      usage();
+      return 2;
+   }
+   // An explicit offset replaces the tare
+   cal.autoTare = tare && !offsetSet;
+
+   FILE* in = strcmp(inputPath, "-") == 0 ? stdin : fopen(inputPath, "rb");
+   if (!in)
+   {
+      fprintf(stderr, "thrust_analyze: cannot open %s\n", inputPath);
+      return 2;
+   }
+
+   const auto  t0 = std::chrono::steady_clock::now();
+   ThrustLog   log;
+   std::string error;
+   const bool  ok = readThrustLog(in, cal, csvRate, log, error);
+   if (in != stdin)
+      fclose(in);
+   if (!ok)
+   {
+      fprintf(stderr, "thrust_analyze: %s: %s\n", inputPath, error.c_str());
+      return 1;
+   }
+
+   std::vector<float> curve(log.newtons.size());
+   smoothThrust(log.newtons.data(), curve.data(), curve.size(), smooth);
+   const ThrustStats stats = analyseThrust(curve.data(), curve.size(), log.rateHz);
+   const auto        took  = std::chrono::steady_clock::now() - t0;
+   const double      ms    = std::chrono::duration<double, std::milli>(took).count();
+
+   printf("samples        %zu @ %.0f Hz (%.3f s)\n", curve.size(), log.rateHz,
+          curve.size() / log.rateHz);
+   if (log.dropped || log.gapSamples || log.frameErrors || !log.complete)
+   {
+      printf("capture        %u dropped, %u missing, %u bad frames%s\n", log.dropped,
+             log.gapSamples, log.frameErrors, log.complete ? "" : ", no end frame");
+   }
+   printf("total impulse  %.3f N*s\n", stats.totalImpulse);
+   printf("peak thrust    %.2f N at %.3f s\n", stats.peakThrust, stats.peakTime);
+   printf("burn           %.3f s from %.3f s\n", stats.burnTime, stats.burnStart);
+   printf("average thrust %.2f N\n", stats.averageThrust);
+   printf("motor          %s\n", stats.designation.empty() ? "-" : stats.designation.c_str());
+   printf("analysed in    %.1f ms\n", ms);
+
+   if (curvePath)
+   {
+      FILE* out = fopen(curvePath, "w");
+      if (!out)
+      {
+         fprintf(stderr, "thrust_analyze: cannot write %s\n", curvePath);
+         return 2;
+      }
+      fprintf(out, "time_s,newtons\n");
+      for (size_t i = 0; i < curve.size(); i++)
+         fprintf(out, "%.6f,%.4f\n", i / log.rateHz, curve[i]);
+      fclose(out);
+   }
+   return 0;
+}
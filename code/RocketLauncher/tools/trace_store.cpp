@@ -0,0 +1,283 @@
+// trace_store - keep a season of recorded sessions in one columnar file and query it
+//
+//   trace_store ingest <store.rts> <capture>...     add telemetry captures (creates the store)
+//   trace_store info <store.rts>
+//   trace_store sessions <store.rts> <STATE>        sessions that ever reached STATE
+//   trace_store time-in <store.rts> <STATE>         how long each stay in STATE lasted
+//   trace_store release <store.rts> [--within MS]   LAUNCH released within MS (default 300)
+//                                                   of a countdown's end
+//
+// Captures are serial dumps with telemetry on (ROCKET_TELEMETRY=1, or
+// rocket_sim --serial); each becomes a session, or several if the device
+// reset part-way through. Queries read the store through mmap and use the
+// per-block index to skip blocks that cannot match; each prints how much it
+// had to read and how fast. See TraceStore.h for the file layout.
+//
+// Exit code: 0 on success, 1 when a query found nothing, 2 on usage or I/O errors.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+#include "StateNames.h"
+#include "TraceStore.h"
+
+namespace
+{
+   using Clock = std::chrono::steady_clock;
+
+   void usage()
+   {
+      fprintf(stderr, "usage: trace_store ingest <store.rts> <capture>...\n"
+                      "       trace_store info <store.rts>\n"
+                      "       trace_store sessions <store.rts> <STATE>\n"
+                      "       trace_store time-in <store.rts> <STATE>\n"
+                      "       trace_store release <store.rts> [--within MS]\n");
+   }
+
+   bool readFile(const char* path, std::vector<uint8_t>& out)
+   {
+      FILE* f = fopen(path, "rb");
+      if (!f)
+         return false;
+      uint8_t buf[65536];
+      size_t  n;
+      while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+         out.insert(out.end(), buf, buf + n);
+      fclose(f);
+      return true;
+   }
+
+   // Scan cost against the size of the columns the query could have read
+   void printScan(const TraceStoreReader& store, const TraceScan& scan, Clock::time_point t0)
+   {
+      const double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+      const double covered = (double)store.rows() * 11;
+      printf("read %u of %u blocks (%.1f of %.1f MB) in %.3f ms, %.2f GB/s of store covered\n",
+             scan.blocksScanned, scan.blocksScanned + scan.blocksSkipped,
+             scan.bytesScanned / 1e6, covered / 1e6, ms, ms > 0 ? covered / ms / 1e6 : 0.0);
+   }
+
+   int ingest(const char* path, int count, char** captures)
+   {
+      TraceStoreWriter writer;
+      TraceStoreReader existing;
+      std::string      error;
+      struct stat      st;
+      if (stat(path, &st) == 0)
+      {
+         if (!existing.open(path, error))
+         {
+            fprintf(stderr, "trace_store: %s\n", error.c_str());
+            return 2;
+         }
+         writer.appendStore(existing);
+      }
+
+      const Clock::time_point t0       = Clock::now();
+      uint32_t                sessions = 0;
+      uint64_t                bytes    = 0;
+      const uint64_t          before   = writer.rows();
+      for (int i = 0; i < count; i++)
+      {
+         std::vector<uint8_t> data;
+         if (!readFile(captures[i], data))
+         {
+            fprintf(stderr, "trace_store: cannot read %s\n", captures[i]);
+            return 2;
+         }
+         const uint32_t added = writer.addCapture(data.data(), data.size(), captures[i]);
+         if (!added)
+            fprintf(stderr, "trace_store: no telemetry in %s\n", captures[i]);
+         sessions += added;
+         bytes += data.size();
+      }
+      if (!writer.write(path, error))
+      {
+         fprintf(stderr, "trace_store: %s\n", error.c_str());
+         return 2;
+      }
+      const double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+      printf("added %u sessions, %llu rows from %d captures (%.1f MB) in %.0f ms; store has %llu "
+             "rows\n",
+             sessions, (unsigned long long)(writer.rows() - before), count, bytes / 1e6, ms,
+             (unsigned long long)writer.rows());
+      return 0;
+   }
+
+   int info(const TraceStoreReader& store)
+   {
+      uint32_t longest = 0;
+      for (uint32_t s = 0; s < store.sessions(); s++)
+         longest = std::max(longest, store.session(s).rows);
+      uint16_t states = 0;
+      for (uint32_t b = 0; b < store.blocks(); b++)
+         states |= store.block(b).states;
+
+      printf("%u sessions, %llu rows in %u blocks of %u, %.1f MB\n", store.sessions(),
+             (unsigned long long)store.rows(), store.blocks(), TRACE_BLOCK_ROWS,
+             store.fileSize() / 1e6);
+      printf("longest session %u rows; states seen:", longest);
+      for (uint8_t i = 0; i < STATE_NAME_COUNT; i++)
+      {
+         if (states & (1u << i))
+            printf(" %s", STATE_NAMES[i]);
+      }
+      printf("\n");
+      return 0;
+   }
+
+   int sessionsWith(const TraceStoreReader& store, State state)
+   {
+      const Clock::time_point     t0    = Clock::now();
+      TraceScan                   scan;
+      const std::vector<uint32_t> found = querySessionsWithState(store, state, scan);
+      for (uint32_t id : found)
+         printf("%s\n", store.sessionName(id));
+      printf("%zu of %u sessions reached %s\n", found.size(), store.sessions(), stateName(state));
+      printScan(store, scan, t0);
+      return found.empty() ? 1 : 0;
+   }
+
+   int timeIn(const TraceStoreReader& store, State state)
+   {
+      const Clock::time_point t0 = Clock::now();
+      TraceScan               scan;
+      std::vector<StateVisit> visits = queryTimeInState(store, state, scan);
+
+      std::vector<uint32_t> durations;
+      uint32_t              open     = 0;
+      uint32_t              sessions = 0;
+      uint32_t              lastId   = UINT32_MAX;
+      for (const StateVisit& v : visits)
+      {
+         open += !v.complete;
+         sessions += v.session != lastId;
+         lastId = v.session;
+         if (v.complete)
+            durations.push_back(v.durationMs);
+      }
+      std::sort(durations.begin(), durations.end());
+
+      printf("%s: %zu stays in %u sessions", stateName(state), visits.size(), sessions);
+      if (open)
+         printf(" (%u still there when the trace ended, not counted)", open);
+      printf("\n");
+      if (!durations.empty())
+      {
+         uint64_t total = 0;
+         for (uint32_t d : durations)
+            total += d;
+         const size_t n = durations.size();
+         printf("  min %u ms, p50 %u ms, p90 %u ms, max %u ms, mean %.0f ms, total %.1f s\n",
+                durations[0], durations[n / 2], durations[n * 9 / 10], durations[n - 1],
+                (double)total / n, total / 1000.0);
+
+         // Doubling buckets from 100 ms up
+         uint32_t counts[12] = {0};
+         for (uint32_t d : durations)
+         {
+            uint8_t k = 0;
+            while (k < 11 && d >= (100u << k))
+               k++;
+            counts[k]++;
+         }
+         const uint32_t peak = *std::max_element(counts, counts + 12);
+         for (uint8_t k = 0; k < 12; k++)
+         {
+            if (!counts[k])
+               continue;
+            char label[24];
+            if (k < 11)
+               snprintf(label, sizeof(label), "< %.1f s", (100u << k) / 1000.0);
+            else
+               snprintf(label, sizeof(label), ">= %.1f s", (100u << 10) / 1000.0);
+            printf("  %10s %7u %s\n", label, counts[k],
+                   std::string((size_t)(counts[k] * 40 / peak) + 1, '#').c_str());
+         }
+      }
+      printScan(store, scan, t0);
+      return visits.empty() ? 1 : 0;
+   }
+
+   int release(const TraceStoreReader& store, uint32_t withinMs)
+   {
+      const Clock::time_point           t0 = Clock::now();
+      TraceScan                         scan;
+      const std::vector<ReleaseNearEnd> found = queryReleaseNearCountdownEnd(store, withinMs, scan);
+      for (const ReleaseNearEnd& r : found)
+         printf("%s: countdown at t=%u, LAUNCH released %+d ms from its end, then %s\n",
+                store.sessionName(r.session), r.countdownMs, r.offsetMs,
+                stateName((State)r.nextState));
+      printf("%zu countdowns with LAUNCH released within %u ms of the end\n", found.size(),
+             withinMs);
+      printScan(store, scan, t0);
+      return found.empty() ? 1 : 0;
+   }
+} // namespace
+
+int main(int argc, char** argv)
+{
+   if (argc < 3)
+   {
+      usage();
+      return 2;
+   }
+   const char* command = argv[1];
+   const char* path    = argv[2];
+   if (strcmp(command, "ingest") == 0)
+   {
+      if (argc < 4)
+      {
+         usage();
+         return 2;
+      }
+      return ingest(path, argc - 3, argv + 3);
+   }
+
+   // Queries
+   TraceStoreReader store;
+   std::string      error;
+   State            state    = State::FAULT;
+   uint32_t         withinMs = 300;
+   const bool       byState  = strcmp(command, "sessions") == 0 || strcmp(command, "time-in") == 0;
+   if (byState && (argc != 4 || !parseStateName(argv[3], state)))
+   {
+      if (argc == 4)
+         fprintf(stderr, "trace_store: unknown state '%s'\n", argv[3]);
+      usage();
+      return 2;
+   }
+   if (strcmp(command, "release") == 0)
+   {
+      if (argc == 5 && strcmp(argv[3], "--within") == 0)
+         withinMs = (uint32_t)atoi(argv[4]);
+      else if (argc != 3)
+      {
+         usage();
+         return 2;
+      }
+   }
+   else if (!byState && (strcmp(command, "info") != 0 || argc != 3))
+   {
+      usage();
+      return 2;
+   }
+   if (!store.open(path, error))
+   {
+      fprintf(stderr, "trace_store: %s\n", error.c_str());
+      return 2;
+   }
+
+   if (strcmp(command, "info") == 0)
+      return info(store);
+   if (strcmp(command, "sessions") == 0)
+      return sessionsWith(store, state);
+   if (strcmp(command, "time-in") == 0)
+      return timeIn(store, state);
+   return release(store, withinMs);
+}